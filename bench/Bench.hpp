@@ -0,0 +1,138 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_BENCH_HPP
+#define CHALLONGESOKU_BENCH_HPP
+
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <json.hpp>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ChallongeSoku::Bench
+{
+	struct Result {
+		std::string name;
+		size_t iterations;
+		double meanUs;
+		double medianUs;
+		double minUs;
+		double maxUs;
+	};
+
+	//! @brief A measure which isn't a timing.
+	struct Figure {
+		std::string name;
+		double value;
+		std::string unit;
+	};
+
+	//! @brief Every result so far, in the order they were run.
+	inline std::vector<Result> results;
+	//! @brief Every figure so far, in the order they were reported.
+	inline std::vector<Figure> figures;
+	//! @brief Only benchmarks with this in their name are run.
+	inline std::string filter;
+
+	//! @brief Run fct iterations times and print the timings.
+	template<typename F>
+	void run(const std::string &name, size_t iterations, F &&fct)
+	{
+		Result result{name, iterations, 0, 0, 1e300, 0};
+		std::vector<double> timings;
+
+		if (name.find(filter) == std::string::npos)
+			return;
+		timings.reserve(iterations);
+		// Warm up caches and lazy initializations
+		fct();
+		for (size_t i = 0; i < iterations; i++) {
+			auto start = std::chrono::steady_clock::now();
+
+			fct();
+
+			double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+			timings.push_back(us);
+			result.meanUs += us;
+			result.minUs = std::min(result.minUs, us);
+			result.maxUs = std::max(result.maxUs, us);
+		}
+		result.meanUs /= iterations;
+		std::nth_element(timings.begin(), timings.begin() + timings.size() / 2, timings.end());
+		result.medianUs = timings[timings.size() / 2];
+		std::cout << name << ": mean " << result.meanUs << "us, median " << result.medianUs << "us, min " << result.minUs << "us, max " << result.maxUs << "us (" << iterations << " iterations)" << std::endl;
+		results.push_back(result);
+	}
+
+	//! @brief Print and keep a figure.
+	inline void report(const std::string &name, double value, const std::string &unit)
+	{
+		if (name.find(filter) == std::string::npos)
+			return;
+		std::cout << name << ": " << value << " " << unit << std::endl;
+		figures.push_back({name, value, unit});
+	}
+
+	//! @brief Memory used by the process, in bytes, or 0 if it cannot be known.
+	inline size_t getResidentMemory()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+		return counters.WorkingSetSize;
+#else
+		std::ifstream stream{"/proc/self/statm"};
+		size_t size = 0;
+		size_t resident = 0;
+
+		if (!(stream >> size >> resident))
+			return 0;
+		return resident * sysconf(_SC_PAGESIZE);
+#endif
+	}
+
+	//! @brief Save the results so runs can be compared by scripts.
+	//! @throw std::runtime_error The file cannot be created.
+	inline void saveJson(const std::string &path)
+	{
+		std::ofstream stream{path};
+		nlohmann::json array = nlohmann::json::array();
+
+		if (stream.fail())
+			throw std::runtime_error("Cannot create " + path);
+		for (auto &result : results)
+			array.push_back({
+				{"name",       result.name},
+				{"iterations", result.iterations},
+				{"mean_us",    result.meanUs},
+				{"median_us",  result.medianUs},
+				{"min_us",     result.minUs},
+				{"max_us",     result.maxUs},
+			});
+		for (auto &figure : figures)
+			array.push_back({
+				{"name",  figure.name},
+				{"value", figure.value},
+				{"unit",  figure.unit},
+			});
+		stream << array.dump(4) << std::endl;
+	}
+}
+
+
+#endif //CHALLONGESOKU_BENCH_HPP
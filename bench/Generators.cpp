@@ -0,0 +1,388 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <map>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <Match.hpp>
+#include <Participant.hpp>
+#include "Generators.hpp"
+
+using namespace ChallongeAPI;
+
+namespace ChallongeSoku::Bench
+{
+	const char * const formatStrings[] = {
+		"single",
+		"double",
+		"round robin",
+		"pools",
+	};
+
+	// Group stage players have their own ids on Challonge
+	static constexpr size_t groupPlayerIdOffset = 100000;
+
+	struct Side {
+		std::optional<size_t> player;
+		std::optional<size_t> prerequisite;
+		bool loser = false;
+	};
+
+	struct GeneratedMatch {
+		size_t id;
+		int round;
+		std::optional<size_t> groupId;
+		Side sides[2];
+		std::string state;
+		std::optional<size_t> winner;
+		std::optional<size_t> loser;
+	};
+
+	class Builder {
+	public:
+		std::vector<GeneratedMatch> matches;
+
+		size_t add(int round, std::optional<size_t> groupId, const Side &player1, const Side &player2)
+		{
+			this->matches.push_back({this->matches.size() + 1, round, groupId, {player1, player2}, "pending", {}, {}});
+			return this->matches.back().id;
+		}
+
+		static Side player(size_t id)
+		{
+			return {id, {}, false};
+		}
+
+		static Side winnerOf(size_t match)
+		{
+			return {{}, match, false};
+		}
+
+		static Side loserOf(size_t match)
+		{
+			return {{}, match, true};
+		}
+
+		// Each round pairs the winners of the previous one, returns the final
+		size_t singleElimination(const std::vector<size_t> &players, int firstRound = 1)
+		{
+			std::vector<size_t> previous;
+			int round = firstRound;
+
+			for (size_t i = 0; i + 1 < players.size(); i += 2)
+				previous.push_back(this->add(round, {}, player(players[i]), player(players[i + 1])));
+			while (previous.size() > 1) {
+				std::vector<size_t> current;
+
+				round++;
+				for (size_t i = 0; i + 1 < previous.size(); i += 2)
+					current.push_back(this->add(round, {}, winnerOf(previous[i]), winnerOf(previous[i + 1])));
+				previous = std::move(current);
+			}
+			return previous.front();
+		}
+
+		// Circle method: everyone plays everyone once, n / 2 matches per round
+		void roundRobin(std::vector<size_t> players, std::optional<size_t> groupId)
+		{
+			for (size_t round = 1; round < players.size(); round++) {
+				for (size_t i = 0; i < players.size() / 2; i++)
+					this->add(round, groupId, player(players[i]), player(players[players.size() - i - 1]));
+				std::rotate(players.begin() + 1, players.end() - 1, players.end());
+			}
+		}
+
+		void doubleElimination(const std::vector<size_t> &players)
+		{
+			std::vector<std::vector<size_t>> winners;
+			std::vector<size_t> losers;
+			int loserRound = -1;
+
+			winners.emplace_back();
+			for (size_t i = 0; i + 1 < players.size(); i += 2)
+				winners.back().push_back(this->add(1, {}, player(players[i]), player(players[i + 1])));
+			while (winners.back().size() > 1) {
+				auto &previous = winners.back();
+				std::vector<size_t> current;
+
+				for (size_t i = 0; i + 1 < previous.size(); i += 2)
+					current.push_back(this->add(winners.size() + 1, {}, winnerOf(previous[i]), winnerOf(previous[i + 1])));
+				winners.push_back(std::move(current));
+			}
+			// Losers of the first round play each other, then each winners round drops its losers
+			// against the survivors, who play each other before the next drop
+			for (size_t i = 0; i + 1 < winners[0].size(); i += 2)
+				losers.push_back(this->add(loserRound, {}, loserOf(winners[0][i]), loserOf(winners[0][i + 1])));
+			for (size_t w = 1; w < winners.size(); w++) {
+				std::vector<size_t> dropped;
+
+				loserRound--;
+				for (size_t i = 0; i < losers.size(); i++)
+					dropped.push_back(this->add(loserRound, {}, winnerOf(losers[i]), loserOf(winners[w][i])));
+				losers = std::move(dropped);
+				if (losers.size() == 1)
+					break;
+
+				std::vector<size_t> paired;
+
+				loserRound--;
+				for (size_t i = 0; i + 1 < losers.size(); i += 2)
+					paired.push_back(this->add(loserRound, {}, winnerOf(losers[i]), winnerOf(losers[i + 1])));
+				losers = std::move(paired);
+			}
+			this->add(winners.size() + 1, {}, winnerOf(winners.back().front()), winnerOf(losers.front()));
+		}
+
+		// Complete the first matches in play order, the lowest id always wins
+		void play(float progress)
+		{
+			size_t completed = this->matches.size() * progress;
+
+			for (auto &match : this->matches) {
+				for (auto &side : match.sides) {
+					if (!side.prerequisite)
+						continue;
+
+					auto &prerequisite = this->matches[*side.prerequisite - 1];
+
+					side.player = side.loser ? prerequisite.loser : prerequisite.winner;
+				}
+				if (!match.sides[0].player || !match.sides[1].player)
+					continue;
+				if (match.id > completed) {
+					match.state = "open";
+					continue;
+				}
+				match.state = "complete";
+				match.winner = std::min(*match.sides[0].player, *match.sides[1].player);
+				match.loser = std::max(*match.sides[0].player, *match.sides[1].player);
+			}
+		}
+	};
+
+	template<typename T>
+	static nlohmann::json optionalToJson(const std::optional<T> &value)
+	{
+		return value ? nlohmann::json(*value) : nlohmann::json();
+	}
+
+	static size_t toParticipantId(size_t player)
+	{
+		return player >= groupPlayerIdOffset ? player - groupPlayerIdOffset : player;
+	}
+
+	TournamentSnapshot generateTournament(Format format, size_t entrants, float progress)
+	{
+		TournamentSnapshot tournament;
+		Builder builder;
+		std::vector<size_t> players;
+
+		if (entrants < 8 || (entrants & (entrants - 1)))
+			throw std::invalid_argument("Entrants must be a power of 2, at least 8");
+		if (format == FORMAT_POOLS && entrants < 16)
+			throw std::invalid_argument("Pools need at least 16 entrants");
+		tournament.id = 1000 + format * 10000 + entrants;
+		tournament.url = "bench_" + std::string(formatStrings[format]) + "_" + std::to_string(entrants);
+		tournament.name = "Bench " + std::string(formatStrings[format]) + " " + std::to_string(entrants);
+		tournament.gameName = "Touhou Hisoutensoku";
+		tournament.participantsCount = entrants;
+		for (size_t i = 1; i <= entrants; i++)
+			players.push_back(i);
+		switch (format) {
+		case FORMAT_SINGLE_ELIMINATION:
+			tournament.type = "single elimination";
+			builder.singleElimination(players);
+			break;
+		case FORMAT_DOUBLE_ELIMINATION:
+			tournament.type = "double elimination";
+			builder.doubleElimination(players);
+			break;
+		case FORMAT_ROUND_ROBIN:
+			tournament.type = "round robin";
+			builder.roundRobin(players, {});
+			break;
+		case FORMAT_POOLS: {
+			std::vector<size_t> qualified;
+
+			tournament.type = "single elimination";
+			for (size_t pool = 0; pool < entrants / 8; pool++) {
+				std::vector<size_t> poolPlayers;
+
+				for (size_t i = pool * 8 + 1; i <= pool * 8 + 8; i++)
+					poolPlayers.push_back(groupPlayerIdOffset + i);
+				builder.roundRobin(poolPlayers, pool + 1);
+				qualified.push_back(pool * 8 + 1);
+				qualified.push_back(pool * 8 + 2);
+			}
+			builder.singleElimination(qualified);
+			break;
+		}
+		}
+		builder.play(progress);
+
+		for (auto &match : builder.matches) {
+			std::string prerequisites;
+
+			for (auto &side : match.sides)
+				if (side.prerequisite)
+					prerequisites += (prerequisites.empty() ? "" : ",") + std::to_string(*side.prerequisite);
+			tournament.matches.push_back(std::make_shared<Match>(nlohmann::json{
+				{"id",                            match.id},
+				{"state",                         match.state},
+				{"round",                         match.round},
+				{"suggested_play_order",          match.id},
+				{"group_id",                      optionalToJson(match.groupId)},
+				{"player1_id",                    optionalToJson(match.sides[0].player)},
+				{"player2_id",                    optionalToJson(match.sides[1].player)},
+				{"winner_id",                     optionalToJson(match.winner)},
+				{"loser_id",                      optionalToJson(match.loser)},
+				{"player1_prereq_match_id",       optionalToJson(match.sides[0].prerequisite)},
+				{"player2_prereq_match_id",       optionalToJson(match.sides[1].prerequisite)},
+				{"prerequisite_match_ids_csv",    prerequisites},
+				{"player1_is_prereq_match_loser", match.sides[0].loser},
+				{"player2_is_prereq_match_loser", match.sides[1].loser},
+				{"scores_csv",                    match.winner ? (match.winner == match.sides[0].player ? "2-1" : "1-2") : ""},
+			}));
+		}
+		for (size_t i = 1; i <= entrants; i++)
+			tournament.participants.push_back(std::make_shared<Participant>(nlohmann::json{
+				{"id",                                   i},
+				{"display_name",                         "Player " + std::to_string(i)},
+				{"username",                             "player_" + std::to_string(i)},
+				{"challonge_username",                   "player_" + std::to_string(i)},
+				{"attached_participatable_portrait_url", nullptr},
+				{"group_player_ids",                     format == FORMAT_POOLS ? std::vector<size_t>{groupPlayerIdOffset + i} : std::vector<size_t>{}},
+			}));
+		return tournament;
+	}
+
+	std::string generateTournamentStorePush(const TournamentSnapshot &tournament)
+	{
+		nlohmann::json store{{"matches_by_round", nlohmann::json::object()}, {"groups", nlohmann::json::array()}};
+		std::map<size_t, nlohmann::json> groups;
+
+		for (auto &match : tournament.matches) {
+			auto &scores = match->getScores();
+			auto &byRound = match->getGroupId() ? groups[*match->getGroupId()]["matches_by_round"] : store["matches_by_round"];
+
+			byRound[std::to_string(match->getRound())].push_back({
+				{"id",        match->getId()},
+				{"state",     match->getState()},
+				{"forfeited", false},
+				{"winner_id", optionalToJson(match->getWinnerId())},
+				{"loser_id",  optionalToJson(match->getLoserId())},
+				{"scores",    scores ? nlohmann::json{scores->first, scores->second} : nlohmann::json::array()},
+				{"player1",   {{"id", optionalToJson(match->getPlayer1Id())}}},
+				{"player2",   {{"id", optionalToJson(match->getPlayer2Id())}}},
+			});
+		}
+		for (auto &group : groups)
+			store["groups"].push_back(group.second);
+		return nlohmann::json::array({{
+			{"channel", "/tournaments/" + std::to_string(tournament.id)},
+			{"data",    {{"TournamentStore", store}}},
+			{"id",      "42"},
+		}}).dump();
+	}
+
+	std::string generateApiResponse(const TournamentSnapshot &tournament)
+	{
+		nlohmann::json matches = nlohmann::json::array();
+		nlohmann::json participants = nlohmann::json::array();
+
+		for (auto &match : tournament.matches) {
+			auto &scores = match->getScores();
+			auto &prerequisites = match->getPrerequisiteMatchIds();
+			std::string csv;
+
+			for (auto id : prerequisites)
+				csv += (csv.empty() ? "" : ",") + std::to_string(id);
+			matches.push_back({{"match", {
+				{"id",                            match->getId()},
+				{"tournament_id",                 tournament.id},
+				{"state",                         match->getState()},
+				{"round",                         match->getRound()},
+				{"suggested_play_order",          match->getSuggestedPlayOrder()},
+				{"group_id",                      optionalToJson(match->getGroupId())},
+				{"player1_id",                    optionalToJson(match->getPlayer1Id())},
+				{"player2_id",                    optionalToJson(match->getPlayer2Id())},
+				{"winner_id",                     optionalToJson(match->getWinnerId())},
+				{"loser_id",                      optionalToJson(match->getLoserId())},
+				{"player1_prereq_match_id",       prerequisites.size() >= 1 ? nlohmann::json(prerequisites[0]) : nlohmann::json()},
+				{"player2_prereq_match_id",       prerequisites.size() >= 2 ? nlohmann::json(prerequisites[1]) : nlohmann::json()},
+				{"prerequisite_match_ids_csv",    csv},
+				{"player1_is_prereq_match_loser", match->isPlayer1IsPrereqMatchLoser()},
+				{"player2_is_prereq_match_loser", match->isPlayer2IsPrereqMatchLoser()},
+				{"scores_csv",                    scores ? std::to_string(scores->first) + "-" + std::to_string(scores->second) : ""},
+				{"created_at",                    "2026-10-19T12:00:00.000+02:00"},
+				{"updated_at",                    "2026-10-19T12:00:00.000+02:00"},
+				{"identifier",                    "A"},
+				{"attachment_count",              nullptr},
+				{"location",                      nullptr},
+			}}});
+		}
+		for (auto &participant : tournament.participants)
+			participants.push_back({{"participant", {
+				{"id",                                   participant->getId()},
+				{"tournament_id",                        tournament.id},
+				{"display_name",                         participant->getDisplayName()},
+				{"name",                                 participant->getDisplayName()},
+				{"username",                             participant->getUsername()},
+				{"challonge_username",                   optionalToJson(participant->getChallongeUsername())},
+				{"attached_participatable_portrait_url", optionalToJson(participant->getAttachedParticipatablePortraitUrl())},
+				{"group_player_ids",                     participant->getGroupPlayerIds()},
+				{"seed",                                 participant->getId()},
+				{"active",                               true},
+				{"created_at",                           "2026-10-19T12:00:00.000+02:00"},
+				{"updated_at",                           "2026-10-19T12:00:00.000+02:00"},
+			}}});
+		return nlohmann::json{{"tournament", {
+			{"id",                 tournament.id},
+			{"url",                tournament.url},
+			{"name",               tournament.name},
+			{"tournament_type",    tournament.type},
+			{"game_name",          tournament.gameName},
+			{"participants_count", tournament.participantsCount},
+			{"state",              "underway"},
+			{"participants",       participants},
+			{"matches",            matches},
+		}}}.dump();
+	}
+
+	std::vector<KonniMatch> generateHosts(const TournamentSnapshot &tournament, size_t count)
+	{
+		std::vector<KonniMatch> hosts;
+
+		for (auto &match : tournament.matches) {
+			if (hosts.size() >= count)
+				break;
+			if (match->getState() != "open")
+				continue;
+
+			auto host = toParticipantId(*match->getPlayer1Id());
+			auto client = toParticipantId(*match->getPlayer2Id());
+
+			hosts.emplace_back(nlohmann::json{
+				{"autopunch",        false},
+				{"host_challonge",   "player_" + std::to_string(host)},
+				{"host_name",        "Player " + std::to_string(host)},
+				{"host_character",   "reimu"},
+				{"host_country",     "FR"},
+				{"client_challonge", "player_" + std::to_string(client)},
+				{"client_name",      "Player " + std::to_string(client)},
+				{"client_character", "marisa"},
+				{"client_country",   "JP"},
+				{"ip",               "10.0." + std::to_string(hosts.size() / 256) + "." + std::to_string(hosts.size() % 256) + ":10800"},
+				{"message",          ""},
+				{"ranked",           false},
+				{"spectatable",      true},
+				{"spectators",       0},
+				{"start",            1700000000 + hosts.size()},
+				{"started",          true},
+			});
+		}
+		return hosts;
+	}
+}
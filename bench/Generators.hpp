@@ -0,0 +1,40 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_GENERATORS_HPP
+#define CHALLONGESOKU_GENERATORS_HPP
+
+
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include <TournamentSnapshot.hpp>
+#include <KonniClient.hpp>
+
+namespace ChallongeSoku::Bench
+{
+	enum Format {
+		FORMAT_SINGLE_ELIMINATION,
+		FORMAT_DOUBLE_ELIMINATION,
+		FORMAT_ROUND_ROBIN,
+		//! @brief Round robin pools of 8, then a single elimination bracket with the top 2 of each pool.
+		FORMAT_POOLS,
+	};
+
+	extern const char * const formatStrings[];
+
+	//! @brief A tournament shaped like the ones Challonge returns, with ids following the same scheme.
+	//! @param entrants A power of 2, at least 8. Pools need at least 16.
+	//! @param progress Part of the matches (in play order) that are already complete.
+	TournamentSnapshot generateTournament(Format format, size_t entrants, float progress = 0.5);
+	//! @brief The Faye frame Challonge pushes when a match of the tournament is updated.
+	std::string generateTournamentStorePush(const TournamentSnapshot &tournament);
+	//! @brief The body Challonge answers when the tournament is asked for with its participants and matches.
+	std::string generateApiResponse(const TournamentSnapshot &tournament);
+	//! @brief Konni games hosted for the open matches of the tournament, as many as possible up to count.
+	std::vector<KonniMatch> generateHosts(const TournamentSnapshot &tournament, size_t count);
+}
+
+
+#endif //CHALLONGESOKU_GENERATORS_HPP
@@ -0,0 +1,240 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <optional>
+#include <functional>
+#include <condition_variable>
+#include <json.hpp>
+#include <Client.hpp>
+#include <Match.hpp>
+#include <Participant.hpp>
+#include <Exceptions.hpp>
+#include "Bench.hpp"
+#include "Generators.hpp"
+#include <Bracket.hpp>
+#include <BracketView.hpp>
+#include <BracketLayout.hpp>
+#include <KonniClient.hpp>
+#include <RefreshScheduler.hpp>
+#include <SecuredWebSocket.hpp>
+#include <SokuStreamingClient.hpp>
+#include <TournamentSnapshot.hpp>
+#include <TrafficLog.hpp>
+// The engine's hot paths are private, they are called directly so nothing else gets measured
+#define private public
+#include <SyncEngine.hpp>
+#undef private
+
+using namespace ChallongeSoku;
+using namespace ChallongeAPI;
+
+static const size_t entrantsCounts[] = {8, 64, 256, 1024, 2048};
+// Size of the bracket panel in a maximized window
+static const tgui::Layout2d viewportSize{1280, 720};
+// A round robin of n entrants has n * (n - 1) / 2 matches, bigger ones are not realistic
+static constexpr size_t maxRoundRobinEntrants = 256;
+
+// The engine logs every match it handles, which is not what we want to measure
+template<typename F>
+static auto quiet(F &&fct)
+{
+	return [fct]{
+		auto out = std::cout.rdbuf(nullptr);
+		auto err = std::cerr.rdbuf(nullptr);
+
+		fct();
+		std::cout.rdbuf(out);
+		std::cerr.rdbuf(err);
+	};
+}
+
+static size_t iterationsFor(size_t entrants)
+{
+	return std::max<size_t>(10, 20000 / entrants);
+}
+
+// Same data work as describeMatch, without the State lookups
+static void describe(const BracketView::Cell &cell, CellVisual &visual)
+{
+	auto &scores = cell.match->getScores();
+
+	visual.id = std::to_string(cell.match->getSuggestedPlayOrder());
+	visual.background = cell.match->getState() == "open" ? sf::Color::Blue : sf::Color::White;
+	for (unsigned i = 0; i < 2; i++) {
+		auto id = i ? cell.match->getPlayer2Id() : cell.match->getPlayer1Id();
+
+		visual.sides[i].name = id ? "Player " + std::to_string(*id) : "Winner of ?";
+		visual.sides[i].score = scores ? std::to_string(i ? scores->second : scores->first) : "-";
+	}
+}
+
+static BracketView::Layout toViewLayout(const BracketLayout::Result &result)
+{
+	BracketView::Layout layout;
+
+	for (auto &cell : result.cells)
+		layout.cells.push_back({{cell.rect.x, cell.rect.y}, cell.match, cell.bracket, cell.isGroup});
+	layout.size = {result.width, result.height};
+	return layout;
+}
+
+// What the GUI does once it has the tournament: build the brackets, lay them out, describe and draw the cells
+static void showFirstFrame(
+	SyncEngine &engine,
+	const std::string &type,
+	size_t participantsCount,
+	const std::vector<std::shared_ptr<Participant>> &participants,
+	const std::vector<std::shared_ptr<Match>> &matches
+)
+{
+	BracketLayout layout;
+	BracketView view{tgui::ScrollablePanel::create(viewportSize), describe};
+
+	engine._populate(type, participantsCount, participants, matches);
+	view.setLayout(toViewLayout(layout.compute(engine.getGroup(), engine.getBracket())));
+	view.refresh();
+	view.update();
+}
+
+static void benchFrameCodec()
+{
+	for (size_t size : {125, 4096, 65536, 1048576}) {
+		std::string payload(size, 'a');
+		const char key[4] = {0x12, 0x34, 0x56, 0x78};
+
+		Bench::run("Websocket frame encode (" + std::to_string(size) + " bytes)", 1048576 / size * 10, [&payload]{
+			SecuredWebSocket::encodeFrame(0x1, payload, 0x12345678);
+		});
+		Bench::run("Websocket frame unmask (" + std::to_string(size) + " bytes)", 1048576 / size * 10, [&payload, &key]{
+			SecuredWebSocket::applyMask(payload.data(), payload.size(), key);
+		});
+	}
+}
+
+static void benchTournament(Bench::Format format, size_t entrants)
+{
+	auto name = std::string(Bench::formatStrings[format]) + ", " + std::to_string(entrants) + " entrants";
+	auto iterations = iterationsFor(entrants);
+	auto tournament = Bench::generateTournament(format, entrants);
+	auto push = Bench::generateTournamentStorePush(tournament);
+	auto hosts = Bench::generateHosts(tournament, entrants / 2);
+	SyncEngine engine;
+	BracketLayout layout;
+
+	Bench::run("Build engine state (" + name + ")", iterations, quiet([&engine, &tournament]{
+		engine._populate(tournament.type, tournament.participantsCount, tournament.participants, tournament.matches);
+	}));
+	Bench::run("Parse TournamentStore push (" + name + ", " + std::to_string(push.size()) + " bytes)", iterations, [&push]{
+		nlohmann::json::parse(push);
+	});
+
+	auto parsed = nlohmann::json::parse(push);
+
+	Bench::run("Apply TournamentStore push (" + name + ")", iterations, quiet([&engine, &parsed]{
+		std::vector<size_t> changed;
+
+		engine._updateTournamentState(parsed[0]["data"]["TournamentStore"], changed);
+	}));
+	Bench::run("Match " + std::to_string(hosts.size()) + " Konni hosts (" + name + ")", iterations, quiet([&engine, &hosts]{
+		engine._matchKonniHosts(hosts);
+	}));
+	Bench::run("Bracket layout (" + name + ")", iterations, [&engine, &layout]{
+		layout.invalidate();
+		layout.compute(engine.getGroup(), engine.getBracket());
+	});
+
+	auto viewLayout = toViewLayout(layout.compute(engine.getGroup(), engine.getBracket()));
+	auto cells = viewLayout.cells.size();
+	auto memoryBefore = Bench::getResidentMemory();
+	BracketView view{tgui::ScrollablePanel::create(viewportSize), describe};
+	std::vector<size_t> one;
+	float step = 1;
+
+	one.push_back(viewLayout.cells.back().match->getId());
+	view.setLayout(std::move(viewLayout));
+	view.refresh();
+	view.update();
+	Bench::report("Materialized widgets (" + name + ", " + std::to_string(cells) + " cells)", view.getMaterializedCount(), "widgets");
+	Bench::report("Bracket view memory (" + name + ")", (Bench::getResidentMemory() - static_cast<double>(memoryBefore)) / 1024, "KiB");
+	Bench::report("Resident memory (" + name + ")", Bench::getResidentMemory() / 1024. / 1024., "MiB");
+	// The camera moves every frame, so each one is drawn again like when scrolling
+	Bench::run("Render frame (" + name + ")", iterations, [&view, &step]{
+		view.pan({step, 0});
+		step = -step;
+		view.update();
+	});
+	Bench::run("Full bracket update (" + name + ")", iterations, [&view]{
+		view.refresh();
+	});
+	Bench::run("Single match update (" + name + ")", iterations, [&view, &one]{
+		view.refresh(one);
+	});
+
+	auto snapshotData = tournament.serialize();
+	auto apiResponse = Bench::generateApiResponse(tournament);
+	// Every iteration creates a canvas, they are a lot slower than the others
+	auto firstFrameIterations = std::max<size_t>(10, iterations / 10);
+
+	// Time to first frame, from the bytes the tournament is read from to a drawn bracket
+	Bench::run("First frame from snapshot (" + name + ", " + std::to_string(snapshotData.size()) + " bytes)", firstFrameIterations, quiet([&engine, &snapshotData]{
+		TournamentSnapshot loaded;
+
+		loaded.deserialize(snapshotData);
+		showFirstFrame(engine, loaded.type, loaded.participantsCount, loaded.participants, loaded.matches);
+	}));
+	Bench::run("First frame from API answer (" + name + ", " + std::to_string(apiResponse.size()) + " bytes)", firstFrameIterations, quiet([&engine, &apiResponse]{
+		auto json = nlohmann::json::parse(apiResponse)["tournament"];
+		std::vector<std::shared_ptr<Participant>> participants;
+		std::vector<std::shared_ptr<Match>> matches;
+
+		participants.reserve(json["participants"].size());
+		for (auto &participant : json["participants"])
+			participants.push_back(std::make_shared<Participant>(participant["participant"]));
+		matches.reserve(json["matches"].size());
+		for (auto &match : json["matches"])
+			matches.push_back(std::make_shared<Match>(match["match"]));
+		showFirstFrame(engine, json["tournament_type"].get<std::string>(), json["participants_count"].get<size_t>(), participants, matches);
+	}));
+}
+
+int main(int argc, char **argv)
+{
+	std::optional<std::string> jsonPath;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			Bench::filter = argv[++i];
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--json <path>] [--filter <text in benchmark names>]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	benchFrameCodec();
+	for (auto format : {Bench::FORMAT_SINGLE_ELIMINATION, Bench::FORMAT_DOUBLE_ELIMINATION, Bench::FORMAT_ROUND_ROBIN, Bench::FORMAT_POOLS})
+		for (size_t entrants : entrantsCounts) {
+			if (format == Bench::FORMAT_ROUND_ROBIN && entrants > maxRoundRobinEntrants)
+				continue;
+			if (format == Bench::FORMAT_POOLS && entrants < 16)
+				continue;
+			benchTournament(format, entrants);
+		}
+
+	if (jsonPath)
+		Bench::saveJson(*jsonPath);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,10 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include "Headless.hpp"
+
+int main(int argc, char **argv)
+{
+	return ChallongeSoku::runHeadless({argv + 1, argv + argc});
+}
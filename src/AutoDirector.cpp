@@ -0,0 +1,325 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <Participant.hpp>
+#include <Match.hpp>
+#include "AutoDirector.hpp"
+
+namespace ChallongeSoku
+{
+	const char * const AutoDirector::ruleStrings[] = {
+		"featured",
+		"playing",
+		"round",
+		"start",
+	};
+
+	static std::string toLower(std::string str)
+	{
+		std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+		return str;
+	}
+
+	void AutoDirector::Config::load(const nlohmann::json &value)
+	{
+		if (value.contains("enabled"))
+			this->enabled = value["enabled"];
+		if (value.contains("debounce"))
+			this->debounce = value["debounce"];
+		if (value.contains("minDwell"))
+			this->minDwell = value["minDwell"];
+		if (value.contains("retryDelay"))
+			this->retryDelay = value["retryDelay"];
+		if (value.contains("featuredPlayers"))
+			this->featuredPlayers = value["featuredPlayers"].get<std::vector<std::string>>();
+		if (!value.contains("priorities"))
+			return;
+		this->priorities.clear();
+		for (std::string rule : value["priorities"]) {
+			auto it = std::find(std::begin(ruleStrings), std::end(ruleStrings), rule);
+
+			if (it == std::end(ruleStrings))
+				throw std::invalid_argument("Unknown auto director rule " + rule);
+			this->priorities.push_back(static_cast<Rule>(it - std::begin(ruleStrings)));
+		}
+	}
+
+	nlohmann::json AutoDirector::Config::toJson() const
+	{
+		nlohmann::json rules = nlohmann::json::array();
+
+		for (auto rule : this->priorities)
+			rules.push_back(ruleStrings[rule]);
+		return {
+			{"enabled",         this->enabled},
+			{"debounce",        this->debounce},
+			{"minDwell",        this->minDwell},
+			{"retryDelay",      this->retryDelay},
+			{"featuredPlayers", this->featuredPlayers},
+			{"priorities",      rules},
+		};
+	}
+
+	AutoDirector::AutoDirector(SyncEngine &engine) :
+		_engine(engine)
+	{
+	}
+
+	AutoDirector::~AutoDirector()
+	{
+		this->stop();
+	}
+
+	void AutoDirector::setConfig(const Config &config)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		if (config.enabled && !this->_config.enabled)
+			this->_changed = true;
+		this->_config = config;
+		lock.unlock();
+		this->_condition.notify_all();
+	}
+
+	AutoDirector::Config AutoDirector::getConfig() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_config;
+	}
+
+	void AutoDirector::start()
+	{
+		if (this->_running)
+			return;
+		this->_running = true;
+		this->_thread = std::thread(&AutoDirector::_loop, this);
+	}
+
+	void AutoDirector::stop()
+	{
+		this->_running = false;
+		this->_condition.notify_all();
+		if (this->_thread.joinable())
+			this->_thread.join();
+	}
+
+	void AutoDirector::notify()
+	{
+		{
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			this->_changed = true;
+		}
+		this->_condition.notify_all();
+	}
+
+	void AutoDirector::onEvent(const SyncEngine::Event &event)
+	{
+		switch (event.type) {
+		case SyncEngine::EVENT_LOADED:
+		case SyncEngine::EVENT_STRUCTURE_CHANGED:
+		case SyncEngine::EVENT_MATCHES_CHANGED:
+		case SyncEngine::EVENT_HOSTS_CHANGED:
+			return this->notify();
+		case SyncEngine::EVENT_LOADING: {
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			// Match ids of the previous tournament mean nothing anymore
+			this->_current.reset();
+			this->_pending.reset();
+			this->_failed.clear();
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	void AutoDirector::onManualJoin(size_t matchId)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_current = matchId;
+		this->_switchedAt = Clock::now();
+		this->_pending.reset();
+	}
+
+	std::optional<size_t> AutoDirector::getCurrentMatch() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_current;
+	}
+
+	std::optional<AutoDirector::Candidate> AutoDirector::pick(const std::vector<Candidate> &candidates, const std::vector<Rule> &priorities)
+	{
+		auto better = [&priorities](const Candidate &a, const Candidate &b){
+			for (auto rule : priorities) {
+				switch (rule) {
+				case RULE_FEATURED:
+					if (a.featured != b.featured)
+						return a.featured > b.featured;
+					break;
+				case RULE_PLAYING:
+					if (a.playing != b.playing)
+						return a.playing;
+					break;
+				case RULE_ROUND:
+					if (std::abs(a.round) != std::abs(b.round))
+						return std::abs(a.round) > std::abs(b.round);
+					break;
+				case RULE_START_TIME:
+					if (a.start != b.start)
+						return a.start < b.start;
+					break;
+				}
+			}
+			// Keep the choice stable when nothing tells them apart
+			return a.matchId < b.matchId;
+		};
+
+		if (candidates.empty())
+			return {};
+		return *std::min_element(candidates.begin(), candidates.end(), better);
+	}
+
+	void AutoDirector::_loop()
+	{
+		while (this->_running) {
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			// Timers (debounce, dwell, retries) are checked every second even if nothing changed
+			this->_condition.wait_for(lock, std::chrono::seconds(1), [this]{
+				return !this->_running || this->_changed;
+			});
+			this->_changed = false;
+
+			auto config = this->_config;
+
+			lock.unlock();
+			if (this->_running && config.enabled)
+				this->_step(config);
+		}
+	}
+
+	std::vector<AutoDirector::Candidate> AutoDirector::_collect(const Config &config)
+	{
+		std::vector<Candidate> candidates;
+		std::vector<std::string> featured;
+		auto lock = this->_engine.lock();
+		auto isFeatured = [this, &featured](const std::optional<size_t> &id){
+			auto participant = id ? this->_engine.getParticipant(*id) : nullptr;
+
+			if (!participant)
+				return false;
+			for (auto &name : featured)
+				if (
+					toLower(participant->getDisplayName()) == name ||
+					(participant->getChallongeUsername() && toLower(*participant->getChallongeUsername()) == name)
+				)
+					return true;
+			return false;
+		};
+
+		for (auto &name : config.featuredPlayers)
+			featured.push_back(toLower(name));
+		for (auto &host : this->_engine.getHosts()) {
+			auto match = this->_engine.getMatch(host.first);
+
+			if (host.second.expired || !match || match->getState() != "open")
+				continue;
+			candidates.push_back({
+				host.first,
+				match->getRound(),
+				static_cast<unsigned>(isFeatured(match->getPlayer1Id()) + isFeatured(match->getPlayer2Id())),
+				host.second.gameStarted,
+				host.second.start
+			});
+		}
+		return candidates;
+	}
+
+	void AutoDirector::_step(const Config &config)
+	{
+		auto now = Clock::now();
+		auto candidates = this->_collect(config);
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		for (auto it = this->_failed.begin(); it != this->_failed.end();)
+			it = it->second <= now ? this->_failed.erase(it) : std::next(it);
+		candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [this](const Candidate &candidate){
+			return this->_failed.count(candidate.matchId);
+		}), candidates.end());
+
+		auto best = pick(candidates, config.priorities);
+		bool currentAlive = this->_current && std::any_of(candidates.begin(), candidates.end(), [this](const Candidate &candidate){
+			return candidate.matchId == *this->_current;
+		});
+
+		if (!best) {
+			if (this->_current && !currentAlive) {
+				std::cout << "Auto director: match " << *this->_current << " is not hosted anymore and there is nothing else to show" << std::endl;
+				this->_current.reset();
+			}
+			this->_pending.reset();
+			return;
+		}
+		// The host we were watching is gone, no need to wait before showing something else
+		if (this->_current && !currentAlive) {
+			auto old = *this->_current;
+
+			lock.unlock();
+			return this->_switch(*best, "match " + std::to_string(old) + " is not hosted anymore", config);
+		}
+		if (this->_current == best->matchId) {
+			this->_pending.reset();
+			return;
+		}
+		if (this->_current && now - this->_switchedAt < std::chrono::duration<float>(config.minDwell))
+			return;
+		if (!this->_pending || this->_pending->first != best->matchId) {
+			this->_pending.emplace(best->matchId, now);
+			lock.unlock();
+			// A debounce of 0 switches right away
+			if (config.debounce <= 0)
+				this->_switch(*best, "best match", config);
+			return;
+		}
+		if (now - this->_pending->second < std::chrono::duration<float>(config.debounce))
+			return;
+		lock.unlock();
+		this->_switch(*best, "best match", config);
+	}
+
+	void AutoDirector::_switch(const Candidate &candidate, const std::string &reason, const Config &config)
+	{
+		std::cout << "Auto director: switching to match " << candidate.matchId << " (" << reason << ")" << std::endl;
+
+		bool joined = this->_engine.joinMatch(candidate.matchId);
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_pending.reset();
+		if (!joined) {
+			this->_failed[candidate.matchId] = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(config.retryDelay));
+			lock.unlock();
+			this->_report(SyncEngine::LEVEL_WARNING, "Auto director: cannot show match " + std::to_string(candidate.matchId) + ", trying another one");
+			// Don't wait for the next tick to fall back on another match
+			return this->notify();
+		}
+		this->_current = candidate.matchId;
+		this->_switchedAt = Clock::now();
+		lock.unlock();
+		this->_report(SyncEngine::LEVEL_OK, "Auto director: showing match " + std::to_string(candidate.matchId) + " (" + reason + ")");
+	}
+
+	void AutoDirector::_report(SyncEngine::Level level, const std::string &message)
+	{
+		this->_engine.post({SyncEngine::EVENT_DIRECTOR, SyncEngine::CHANNEL_SOKUSTREAMING, level, "", message, {}});
+	}
+}
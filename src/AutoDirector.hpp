@@ -0,0 +1,110 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_AUTODIRECTOR_HPP
+#define CHALLONGESOKU_AUTODIRECTOR_HPP
+
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include <optional>
+#include <condition_variable>
+#include <json.hpp>
+#include "SyncEngine.hpp"
+
+namespace ChallongeSoku
+{
+	//! @brief Has SokuStreaming spectate the most interesting hosted match on its own.
+	//! @details Hosted matches are ranked with the configured rules, the first one deciding and the next ones
+	//! breaking ties. A better match must stay the best for debounce seconds, and the current one must have been
+	//! shown for minDwell seconds, before switching. If the current host expires, the director falls back to the
+	//! best match right away. Hosts SokuStreaming couldn't join are left aside for retryDelay seconds.
+	//! Everything runs on the director's own thread, so joining never blocks the GUI.
+	class AutoDirector {
+	public:
+		enum Rule {
+			//! @brief Matches with more featured players first.
+			RULE_FEATURED,
+			//! @brief Matches whose game started before the ones still waiting for a client.
+			RULE_PLAYING,
+			//! @brief Matches further in the bracket first.
+			RULE_ROUND,
+			//! @brief Matches hosted earlier first.
+			RULE_START_TIME,
+		};
+
+		static const char * const ruleStrings[];
+
+		struct Config {
+			bool enabled = false;
+			float debounce = 5;
+			float minDwell = 30;
+			float retryDelay = 30;
+			//! @brief Display names or Challonge usernames, case insensitive.
+			std::vector<std::string> featuredPlayers;
+			std::vector<Rule> priorities = {RULE_FEATURED, RULE_PLAYING, RULE_ROUND, RULE_START_TIME};
+
+			void	load(const nlohmann::json &value);
+			nlohmann::json toJson() const;
+		};
+
+		struct Candidate {
+			size_t matchId;
+			int round;
+			unsigned featured;
+			bool playing;
+			time_t start;
+		};
+
+		AutoDirector(SyncEngine &engine);
+		~AutoDirector();
+
+		void	setConfig(const Config &config);
+		Config	getConfig() const;
+		void	start();
+		void	stop();
+		//! @brief Look at the hosts again.
+		void	notify();
+		//! @brief Look at the hosts again if the event changed them. To be called from an engine listener.
+		void	onEvent(const SyncEngine::Event &event);
+		//! @brief The user chose a match themselves, it counts as the current one.
+		void	onManualJoin(size_t matchId);
+		std::optional<size_t> getCurrentMatch() const;
+
+		//! @brief The best candidate according to the rules, if any.
+		static std::optional<Candidate> pick(const std::vector<Candidate> &candidates, const std::vector<Rule> &priorities);
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		SyncEngine &_engine;
+		mutable std::mutex _mutex;
+		std::condition_variable _condition;
+		Config _config;
+		// Not a TaskPool task: it wakes up every second for the timers (debounce, dwell, retries) as long as it
+		// runs, and the pool has no timers, so it would hold a worker for the whole session anyway.
+		std::thread _thread;
+		std::atomic<bool> _running{false};
+		bool _changed = false;
+		std::optional<size_t> _current;
+		Clock::time_point _switchedAt;
+		std::optional<std::pair<size_t, Clock::time_point>> _pending;
+		std::map<size_t, Clock::time_point> _failed;
+
+		void	_loop();
+		void	_step(const Config &config);
+		std::vector<Candidate> _collect(const Config &config);
+		void	_switch(const Candidate &candidate, const std::string &reason, const Config &config);
+		void	_report(SyncEngine::Level level, const std::string &message);
+	};
+}
+
+
+#endif //CHALLONGESOKU_AUTODIRECTOR_HPP
@@ -0,0 +1,33 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_BRACKET_HPP
+#define CHALLONGESOKU_BRACKET_HPP
+
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Match.hpp>
+
+namespace ChallongeSoku
+{
+	typedef std::vector<std::shared_ptr<ChallongeAPI::Match>> Round;
+	typedef std::vector<Round> RobinBracket;
+	typedef std::map<int, Round> ElimBracket;
+
+	struct Bracket {
+		std::string type;
+		ElimBracket elim;
+		RobinBracket robbin;
+		std::pair<int, int> roundBounds;
+		std::shared_ptr<ChallongeAPI::Match> last;
+	};
+
+	typedef std::map<size_t, Bracket> Pool;
+}
+
+
+#endif //CHALLONGESOKU_BRACKET_HPP
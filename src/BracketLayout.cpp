@@ -0,0 +1,273 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <algorithm>
+#include "BracketLayout.hpp"
+#include "Tracer.hpp"
+
+namespace ChallongeSoku
+{
+	static const uint64_t fnvOffset = 14695981039346656037ULL;
+	static const uint64_t fnvPrime = 1099511628211ULL;
+
+	static void hashValue(uint64_t &hash, uint64_t value)
+	{
+		for (int i = 0; i < 8; i++) {
+			hash ^= (value >> (i * 8)) & 0xFFU;
+			hash *= fnvPrime;
+		}
+	}
+
+	// The cells keep pointers to the matches, so a bracket rebuilt with new Match objects
+	// is a new structure even if the ids are the same.
+	static void hashMatch(uint64_t &hash, const std::shared_ptr<ChallongeAPI::Match> &match)
+	{
+		hashValue(hash, match->getId());
+		hashValue(hash, reinterpret_cast<uintptr_t>(match.get()));
+	}
+
+	static void hashBracket(uint64_t &hash, const Bracket &bracket)
+	{
+		for (char c : bracket.type) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= fnvPrime;
+		}
+		for (auto &round : bracket.elim) {
+			hashValue(hash, round.first);
+			for (auto &match : round.second)
+				hashMatch(hash, match);
+		}
+		for (auto &round : bracket.robbin) {
+			hashValue(hash, round.size());
+			for (auto &match : round)
+				hashMatch(hash, match);
+		}
+	}
+
+	// Number of shifts needed to bring a value to 0
+	static unsigned bitLength(size_t value)
+	{
+		unsigned len = 0;
+
+		for (; value; value >>= 1U)
+			len++;
+		return len;
+	}
+
+	uint64_t BracketLayout::_getSignature(const Bracket &bracket)
+	{
+		uint64_t hash = fnvOffset;
+
+		hashBracket(hash, bracket);
+		return hash;
+	}
+
+	const BracketLayout::Result &BracketLayout::compute(const Pool &group, const Bracket &bracket)
+	{
+		TRACE_SCOPE("BracketLayout::compute");
+		std::vector<uint64_t> signatures;
+		uint64_t signature = fnvOffset;
+
+		signatures.reserve(group.size() + 1);
+		for (auto &pool : group) {
+			signatures.push_back(_getSignature(pool.second));
+			hashValue(signature, pool.first);
+			hashValue(signature, signatures.back());
+		}
+		signatures.push_back(_getSignature(bracket));
+		hashValue(signature, signatures.back());
+		if (this->_valid && this->_signature == signature) {
+			this->_relayoutCount = 0;
+			return this->_result;
+		}
+
+		this->_result = Result();
+		this->_relayoutCount = 0;
+		for (auto &part : this->_parts)
+			part.second.used = false;
+
+		auto groups = this->_placeGroups(group, signatures, 0, 0);
+		auto main = this->_placeBracket(bracket, signatures.back(), groups.w, 0, false);
+
+		// Forget the brackets that are not there anymore
+		for (auto it = this->_parts.begin(); it != this->_parts.end(); )
+			if (it->second.used)
+				it++;
+			else
+				it = this->_parts.erase(it);
+		this->_result.width = groups.w + main.w;
+		this->_result.height = std::max(groups.h, main.h);
+		this->_signature = signature;
+		this->_valid = true;
+		return this->_result;
+	}
+
+	void BracketLayout::invalidate()
+	{
+		this->_valid = false;
+		this->_parts.clear();
+	}
+
+	size_t BracketLayout::getRelayoutCount() const
+	{
+		return this->_relayoutCount;
+	}
+
+	Rect BracketLayout::_layoutRoundRobin(Result &out, const Bracket &bracket, bool isGroup)
+	{
+		Rect size{0, 0, 0, 0};
+		const RobinBracket &rounds = bracket.robbin;
+		size_t section = out.sections.size();
+
+		out.sections.push_back({size, SECTION_ROUND_ROBIN});
+		for (size_t round = 0; round < rounds.size(); round++) {
+			float posX = margin + round * columnWidth;
+			float posY = margin;
+
+			out.labels.push_back({{posX, posY, cellWidth, labelHeight}, LABEL_ROUND, &bracket, static_cast<int>(round + 1)});
+			posY += labelHeight;
+			for (auto &match : rounds[round]) {
+				out.cells.push_back({{posX, posY, cellWidth, cellHeight}, match, &bracket, isGroup});
+				posY += rowHeight;
+			}
+			size.w = std::max(size.w, posX + columnWidth);
+			size.h = std::max(size.h, posY - margin);
+		}
+		out.sections[section].rect = size;
+		return size;
+	}
+
+	Rect BracketLayout::_layoutElimination(Result &out, const Bracket &bracket, const ElimBracket::const_iterator &begin, const ElimBracket::const_iterator &end, float x, float y, bool isGroup)
+	{
+		Rect size{x, y, 0, 0};
+		size_t biggest = 0;
+
+		for (auto it = begin; it != end; it++)
+			biggest = std::max(biggest, it->second.size());
+
+		unsigned biggestLength = bitLength(biggest);
+
+		size.h = biggest * rowHeight + labelHeight;
+		for (auto it = begin; it != end; it++) {
+			float posX = x + (std::abs(it->first) - 1) * elimColumnSpacing + margin;
+			float posY = y + margin;
+			float step = rowHeight;
+
+			out.labels.push_back({{posX, posY, cellWidth, labelHeight}, LABEL_ROUND, &bracket, it->first});
+			posY += labelHeight;
+			// Each round is spread over twice the height of the one before it, so a match
+			// sits between the two it comes from.
+			if (std::abs(it->first) != 1) {
+				unsigned length = bitLength(it->second.size());
+				unsigned spread = 1U << (std::max(length, biggestLength) - std::min(length, biggestLength));
+
+				posY += (rowHeight / 2) * (spread - 1);
+				step = rowHeight * spread;
+			}
+			size.w = std::max(size.w, posX + columnWidth - x);
+			for (auto &match : it->second) {
+				out.cells.push_back({{posX, posY, cellWidth, cellHeight}, match, &bracket, isGroup});
+				posY += step;
+			}
+		}
+		return size;
+	}
+
+	Rect BracketLayout::_layoutDoubleElimination(Result &out, const Bracket &bracket, bool isGroup)
+	{
+		// Loser rounds have negative numbers so they come first in the map
+		auto separator = bracket.elim.lower_bound(0);
+		size_t section = out.sections.size();
+
+		out.sections.push_back({{0, 0, 0, 0}, SECTION_WINNERS});
+		out.sections.push_back({{0, 0, 0, 0}, SECTION_LOSERS});
+
+		auto winners = _layoutElimination(out, bracket, separator, bracket.elim.end(), 0, 0, isGroup);
+		auto losers = _layoutElimination(out, bracket, bracket.elim.begin(), separator, 0, winners.h, isGroup);
+
+		out.sections[section].rect = winners;
+		out.sections[section + 1].rect = losers;
+		return {0, 0, std::max(winners.w, losers.w), winners.h + losers.h};
+	}
+
+	Rect BracketLayout::_layoutBracket(Result &out, const Bracket &bracket, bool isGroup)
+	{
+		if (bracket.type == "double elimination")
+			return _layoutDoubleElimination(out, bracket, isGroup);
+		if (bracket.type == "single elimination") {
+			size_t section = out.sections.size();
+
+			out.sections.push_back({{0, 0, 0, 0}, SECTION_SINGLE_ELIMINATION});
+
+			auto size = _layoutElimination(out, bracket, bracket.elim.begin(), bracket.elim.end(), 0, 0, isGroup);
+
+			out.sections[section].rect = size;
+			return size;
+		}
+		return _layoutRoundRobin(out, bracket, isGroup);
+	}
+
+	Rect BracketLayout::_placeBracket(const Bracket &bracket, uint64_t signature, float x, float y, bool isGroup)
+	{
+		auto inserted = this->_parts.emplace(&bracket, Part{});
+		auto &part = inserted.first->second;
+
+		if (inserted.second || part.signature != signature) {
+			part.result = Result();
+
+			auto size = _layoutBracket(part.result, bracket, isGroup);
+
+			part.result.width = size.w;
+			part.result.height = size.h;
+			part.signature = signature;
+			this->_relayoutCount++;
+		}
+		part.used = true;
+		for (auto section : part.result.sections) {
+			section.rect.x += x;
+			section.rect.y += y;
+			this->_result.sections.push_back(section);
+		}
+		for (auto label : part.result.labels) {
+			label.rect.x += x;
+			label.rect.y += y;
+			this->_result.labels.push_back(label);
+		}
+		for (auto cell : part.result.cells) {
+			cell.rect.x += x;
+			cell.rect.y += y;
+			this->_result.cells.push_back(std::move(cell));
+		}
+		return {x, y, part.result.width, part.result.height};
+	}
+
+	Rect BracketLayout::_placeGroups(const Pool &group, const std::vector<uint64_t> &signatures, float x, float y)
+	{
+		Rect size{x, y, 0, 0};
+		int index = 0;
+
+		if (group.empty())
+			return size;
+
+		size_t section = this->_result.sections.size();
+
+		this->_result.sections.push_back({size, SECTION_GROUPS});
+		for (auto &pool : group) {
+			size_t label = this->_result.labels.size();
+
+			size.h += margin;
+			this->_result.labels.push_back({{x, y + size.h, 0, labelHeight}, LABEL_POOL, &pool.second, index});
+			size.h += labelHeight;
+
+			auto poolSize = this->_placeBracket(pool.second, signatures[index], x, y + size.h, true);
+
+			this->_result.labels[label].rect.w = poolSize.w;
+			size.w = std::max(size.w, poolSize.w);
+			size.h += poolSize.h;
+			index++;
+		}
+		this->_result.sections[section].rect = size;
+		return size;
+	}
+}
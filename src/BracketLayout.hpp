@@ -0,0 +1,110 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_BRACKETLAYOUT_HPP
+#define CHALLONGESOKU_BRACKETLAYOUT_HPP
+
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include "Bracket.hpp"
+
+namespace ChallongeSoku
+{
+	struct Rect {
+		float x;
+		float y;
+		float w;
+		float h;
+	};
+
+	//! @brief Computes where every part of a tournament goes, in plain coordinates.
+	//! @details Group stage pools are stacked on the left, the final stage is on their right.
+	//! Everything is computed in one pass over the matches and kept until the structure
+	//! (bracket types, rounds and matches) changes. When it does, only the pools or brackets
+	//! that changed are laid out again, the others are moved where they now belong.
+	class BracketLayout {
+	public:
+		enum SectionKind {
+			SECTION_GROUPS,
+			SECTION_ROUND_ROBIN,
+			SECTION_SINGLE_ELIMINATION,
+			SECTION_WINNERS,
+			SECTION_LOSERS,
+		};
+
+		enum LabelKind {
+			LABEL_ROUND,
+			LABEL_POOL,
+		};
+
+		struct Section {
+			Rect rect;
+			SectionKind kind;
+		};
+
+		struct Label {
+			Rect rect;
+			LabelKind kind;
+			const Bracket *bracket;
+			//! @brief Round number for LABEL_ROUND, pool index for LABEL_POOL.
+			int index;
+		};
+
+		struct Cell {
+			Rect rect;
+			std::shared_ptr<ChallongeAPI::Match> match;
+			const Bracket *bracket;
+			bool isGroup;
+		};
+
+		struct Result {
+			std::vector<Section> sections;
+			std::vector<Label> labels;
+			std::vector<Cell> cells;
+			float width = 0;
+			float height = 0;
+		};
+
+		static constexpr float cellWidth = 200;
+		static constexpr float cellHeight = 41;
+		static constexpr float margin = 10;
+		static constexpr float labelHeight = 20;
+		static constexpr float rowHeight = 60;
+		static constexpr float columnWidth = 210;
+		static constexpr float elimColumnSpacing = 240;
+
+		//! @brief Get the layout of a tournament. Only computed again if the structure changed.
+		const Result &compute(const Pool &group, const Bracket &bracket);
+		void	invalidate();
+		//! @brief Number of pools or brackets that were actually laid out during the last compute.
+		size_t	getRelayoutCount() const;
+
+	private:
+		//! @brief Layout of a single pool or bracket, relative to its top left corner.
+		struct Part {
+			Result result;
+			uint64_t signature;
+			bool used;
+		};
+
+		Result _result;
+		uint64_t _signature = 0;
+		bool _valid = false;
+		size_t _relayoutCount = 0;
+		std::map<const Bracket *, Part> _parts;
+
+		static uint64_t _getSignature(const Bracket &bracket);
+		static Rect _layoutBracket(Result &out, const Bracket &bracket, bool isGroup);
+		static Rect _layoutRoundRobin(Result &out, const Bracket &bracket, bool isGroup);
+		static Rect _layoutElimination(Result &out, const Bracket &bracket, const ElimBracket::const_iterator &begin, const ElimBracket::const_iterator &end, float x, float y, bool isGroup);
+		static Rect _layoutDoubleElimination(Result &out, const Bracket &bracket, bool isGroup);
+		Rect	_placeBracket(const Bracket &bracket, uint64_t signature, float x, float y, bool isGroup);
+		Rect	_placeGroups(const Pool &group, const std::vector<uint64_t> &signatures, float x, float y);
+	};
+}
+
+
+#endif //CHALLONGESOKU_BRACKETLAYOUT_HPP
@@ -0,0 +1,169 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <cmath>
+#include "BracketRenderer.hpp"
+
+namespace ChallongeSoku
+{
+	const sf::Vector2f BracketRenderer::cellSize{200, 41};
+
+	BracketRenderer::BracketRenderer(const sf::Font &font) :
+		_font(font)
+	{
+	}
+
+	void BracketRenderer::clear()
+	{
+		this->_shapes.clear();
+		for (auto &batch : this->_text)
+			batch.second.clear();
+		this->_portraits.clear();
+	}
+
+	void BracketRenderer::_addQuad(sf::VertexArray &array, const sf::FloatRect &rect, const sf::FloatRect &texRect, sf::Color color)
+	{
+		sf::Vector2f topLeft{rect.left, rect.top};
+		sf::Vector2f topRight{rect.left + rect.width, rect.top};
+		sf::Vector2f botLeft{rect.left, rect.top + rect.height};
+		sf::Vector2f botRight{rect.left + rect.width, rect.top + rect.height};
+		sf::Vector2f texTopLeft{texRect.left, texRect.top};
+		sf::Vector2f texTopRight{texRect.left + texRect.width, texRect.top};
+		sf::Vector2f texBotLeft{texRect.left, texRect.top + texRect.height};
+		sf::Vector2f texBotRight{texRect.left + texRect.width, texRect.top + texRect.height};
+
+		array.append({topLeft,  color, texTopLeft});
+		array.append({topRight, color, texTopRight});
+		array.append({botLeft,  color, texBotLeft});
+		array.append({botLeft,  color, texBotLeft});
+		array.append({topRight, color, texTopRight});
+		array.append({botRight, color, texBotRight});
+	}
+
+	void BracketRenderer::addRect(const sf::FloatRect &rect, sf::Color color)
+	{
+		if (color.a)
+			_addQuad(this->_shapes, rect, {}, color);
+	}
+
+	void BracketRenderer::addOutline(const sf::FloatRect &rect, sf::Color color, bool top, bool left, bool right, bool bottom)
+	{
+		if (top)
+			this->addRect({rect.left, rect.top, rect.width, 1}, color);
+		if (bottom)
+			this->addRect({rect.left, rect.top + rect.height - 1, rect.width, 1}, color);
+		if (left)
+			this->addRect({rect.left, rect.top, 1, rect.height}, color);
+		if (right)
+			this->addRect({rect.left + rect.width - 1, rect.top, 1, rect.height}, color);
+	}
+
+	void BracketRenderer::addConnector(sf::Vector2f from, sf::Vector2f to, sf::Color color)
+	{
+		float middle = std::floor((from.x + to.x) / 2);
+
+		this->addRect({from.x, from.y, middle - from.x + 1, 1}, color);
+		this->addRect({middle, std::min(from.y, to.y), 1, std::abs(to.y - from.y) + 1}, color);
+		this->addRect({middle, to.y, to.x - middle, 1}, color);
+	}
+
+	void BracketRenderer::addText(const std::string &text, unsigned size, const sf::FloatRect &box, sf::Color color, bool centered)
+	{
+		auto str = sf::String::fromUtf8(text.begin(), text.end());
+		auto &batch = this->_text[size];
+		float width = 0;
+		float x;
+		float baseline = std::floor(box.top + (box.height + size) / 2 - size * 0.15f);
+		sf::Uint32 previous = 0;
+
+		batch.setPrimitiveType(sf::Triangles);
+		for (auto c : str) {
+			width += this->_font.getKerning(previous, c, size) + this->_font.getGlyph(c, size, false).advance;
+			previous = c;
+		}
+		x = centered ? std::floor(box.left + (box.width - width) / 2) : box.left;
+		previous = 0;
+		for (auto c : str) {
+			auto &glyph = this->_font.getGlyph(c, size, false);
+
+			x += this->_font.getKerning(previous, c, size);
+			previous = c;
+			// Names that don't fit are cut, like the labels used to do
+			if (x + glyph.advance > box.left + box.width)
+				break;
+			_addQuad(
+				batch,
+				{x + glyph.bounds.left, baseline + glyph.bounds.top, glyph.bounds.width, glyph.bounds.height},
+				{
+					static_cast<float>(glyph.textureRect.left),
+					static_cast<float>(glyph.textureRect.top),
+					static_cast<float>(glyph.textureRect.width),
+					static_cast<float>(glyph.textureRect.height)
+				},
+				color
+			);
+			x += glyph.advance;
+		}
+	}
+
+	void BracketRenderer::addCell(sf::Vector2f pos, const CellVisual &visual)
+	{
+		this->addRect({pos.x, pos.y, cellSize.x, cellSize.y}, visual.background);
+		this->addText(visual.id, 13, {pos.x, pos.y, 20, 39}, sf::Color{0x3C, 0x3C, 0x3C}, true);
+		for (unsigned i = 0; i < 2; i++) {
+			auto &side = visual.sides[i];
+			float top = pos.y + i * 20;
+			float height = i ? 21 : 20;
+
+			this->addRect({pos.x + 20, top, 180, height}, sf::Color::White);
+			this->addRect({pos.x + 175, top, 25, height}, side.scoreColor);
+			this->addOutline({pos.x + 20, top, 180, height}, sf::Color::Black, true, true, true, i == 1);
+			this->addRect({pos.x + 175, top, 1, height}, sf::Color::Black);
+			if (side.portrait) {
+				auto size = side.portrait->getSize();
+
+				_addQuad(
+					this->_portraits[side.portrait],
+					{pos.x + 21, top + 1, 17, 17},
+					{0, 0, static_cast<float>(size.x), static_cast<float>(size.y)},
+					sf::Color::White
+				);
+			}
+			this->addText(side.name, 13, {pos.x + 40, top, 135, 19}, side.nameColor, false);
+			this->addText(side.score, 13, {pos.x + 175, top, 25, 19}, sf::Color{0x3C, 0x3C, 0x3C}, true);
+		}
+		this->addOutline({pos.x, pos.y, cellSize.x, cellSize.y}, sf::Color::Black);
+	}
+
+	void BracketRenderer::addCellBlock(sf::Vector2f pos, const CellVisual &visual)
+	{
+		this->addRect({pos.x, pos.y, cellSize.x, cellSize.y}, visual.background);
+		for (unsigned i = 0; i < 2; i++)
+			this->addRect({pos.x + 175, pos.y + i * 20, 25, i ? 21.f : 20.f}, visual.sides[i].scoreColor);
+	}
+
+	size_t BracketRenderer::getDrawCallCount() const
+	{
+		size_t count = this->_shapes.getVertexCount() != 0;
+
+		for (auto &batch : this->_text)
+			count += batch.second.getVertexCount() != 0;
+		return count + this->_portraits.size();
+	}
+
+	void BracketRenderer::draw(sf::RenderTarget &target, sf::RenderStates states) const
+	{
+		target.draw(this->_shapes, states);
+		for (auto &batch : this->_portraits) {
+			states.texture = batch.first;
+			target.draw(batch.second, states);
+		}
+		for (auto &batch : this->_text) {
+			if (!batch.second.getVertexCount())
+				continue;
+			states.texture = &this->_font.getTexture(batch.first);
+			target.draw(batch.second, states);
+		}
+	}
+}
@@ -0,0 +1,66 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_BRACKETRENDERER_HPP
+#define CHALLONGESOKU_BRACKETRENDERER_HPP
+
+
+#include <map>
+#include <string>
+#include <functional>
+#include <SFML/Graphics.hpp>
+
+namespace ChallongeSoku
+{
+	struct CellSide {
+		std::string name;
+		sf::Color nameColor = sf::Color::Black;
+		std::string score = "-";
+		sf::Color scoreColor = sf::Color::White;
+		const sf::Texture *portrait = nullptr;
+	};
+
+	//! @brief Everything needed to draw a match cell, without any widget.
+	struct CellVisual {
+		std::string id;
+		sf::Color background = sf::Color::White;
+		CellSide sides[2];
+		bool joinable = false;
+		std::function<void ()> onJoin;
+	};
+
+	//! @brief Draws bracket cells, labels and connectors in a few batches.
+	//! @details Every untextured shape goes in a single triangle list. Text is built from the glyphs cached
+	//! by the font, with one batch per character size, and portraits get one batch per texture.
+	class BracketRenderer : public sf::Drawable {
+	public:
+		static const sf::Vector2f cellSize;
+
+		BracketRenderer(const sf::Font &font);
+
+		void	clear();
+		void	addRect(const sf::FloatRect &rect, sf::Color color);
+		void	addOutline(const sf::FloatRect &rect, sf::Color color, bool top = true, bool left = true, bool right = true, bool bottom = true);
+		void	addConnector(sf::Vector2f from, sf::Vector2f to, sf::Color color);
+		void	addText(const std::string &text, unsigned size, const sf::FloatRect &box, sf::Color color, bool centered);
+		void	addCell(sf::Vector2f pos, const CellVisual &visual);
+		//! @brief Cheap version of addCell for zoomed out views: the background and score colors, no text.
+		void	addCellBlock(sf::Vector2f pos, const CellVisual &visual);
+		size_t	getDrawCallCount() const;
+
+	protected:
+		void	draw(sf::RenderTarget &target, sf::RenderStates states) const override;
+
+	private:
+		const sf::Font &_font;
+		sf::VertexArray _shapes{sf::Triangles};
+		std::map<unsigned, sf::VertexArray> _text;
+		std::map<const sf::Texture *, sf::VertexArray> _portraits;
+
+		static void _addQuad(sf::VertexArray &array, const sf::FloatRect &rect, const sf::FloatRect &texRect, sf::Color color);
+	};
+}
+
+
+#endif //CHALLONGESOKU_BRACKETRENDERER_HPP
@@ -0,0 +1,418 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <map>
+#include <cmath>
+#include "BracketView.hpp"
+#include "MetricsRegistry.hpp"
+#include "Tracer.hpp"
+
+namespace ChallongeSoku
+{
+	const sf::Color BracketView::backgroundColor{0xCC, 0xCC, 0xCC};
+
+	static bool isVisible(const sf::FloatRect &viewport, tgui::Vector2f pos, tgui::Vector2f size)
+	{
+		return viewport.intersects({pos.x, pos.y, size.x, size.y});
+	}
+
+	BracketView::BracketView(const tgui::ScrollablePanel::Ptr &panel, const DescribeCallback &describe) :
+		_panel(panel),
+		_describe(describe)
+	{
+	}
+
+	void BracketView::setLayout(Layout &&layout)
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+		std::vector<CellVisual> visuals{layout.cells.size()};
+		std::unordered_map<size_t, size_t> cellOfMatch;
+
+		// The canvas and the buttons are kept, and so are the visuals of the matches still there
+		cellOfMatch.reserve(layout.cells.size());
+		for (size_t i = 0; i < layout.cells.size(); i++) {
+			auto id = layout.cells[i].match->getId();
+			auto it = this->_cellOfMatch.find(id);
+
+			cellOfMatch[id] = i;
+			if (it != this->_cellOfMatch.end() && this->_layout.cells[it->second].match == layout.cells[i].match)
+				visuals[i] = std::move(this->_visuals[it->second]);
+		}
+		this->_layout = std::move(layout);
+		this->_visuals = std::move(visuals);
+		this->_cellOfMatch = std::move(cellOfMatch);
+		this->_clampCamera();
+		this->_computeConnectors();
+		this->_generation++;
+		this->_dirty = true;
+	}
+
+	void BracketView::_computeConnectors()
+	{
+		this->_connectors.clear();
+		for (auto &cell : this->_layout.cells) {
+			auto &prerequisites = cell.match->getPrerequisiteMatchIds();
+
+			for (size_t i = 0; i < prerequisites.size() && i < 2; i++) {
+				// Losers go to another part of the bracket, linking them would cross everything
+				if (i == 0 ? cell.match->isPlayer1IsPrereqMatchLoser() : cell.match->isPlayer2IsPrereqMatchLoser())
+					continue;
+
+				auto it = this->_cellOfMatch.find(prerequisites[i]);
+
+				if (it == this->_cellOfMatch.end())
+					continue;
+
+				auto &other = this->_layout.cells[it->second];
+
+				if (other.bracket != cell.bracket)
+					continue;
+				this->_connectors.push_back({
+					{other.pos.x + BracketRenderer::cellSize.x, other.pos.y + BracketRenderer::cellSize.y / 2},
+					{cell.pos.x, cell.pos.y + BracketRenderer::cellSize.y / 2}
+				});
+			}
+		}
+	}
+
+	void BracketView::refresh()
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+		std::vector<size_t> indexes(this->_layout.cells.size());
+		auto generation = this->_generation;
+
+		for (size_t i = 0; i < indexes.size(); i++)
+			indexes[i] = i;
+		lock.unlock();
+		this->_describeCells(std::move(indexes), generation);
+	}
+
+	void BracketView::refresh(const std::vector<size_t> &matchIds)
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+		std::vector<size_t> indexes;
+		auto generation = this->_generation;
+
+		indexes.reserve(matchIds.size());
+		for (auto id : matchIds) {
+			auto it = this->_cellOfMatch.find(id);
+
+			if (it != this->_cellOfMatch.end())
+				indexes.push_back(it->second);
+		}
+		lock.unlock();
+		this->_describeCells(std::move(indexes), generation);
+	}
+
+	void BracketView::_describeCells(std::vector<size_t> &&indexes, unsigned generation)
+	{
+		static const auto describeTime = MetricsRegistry::histogram("bracket.describe_us");
+		static const auto described = MetricsRegistry::counter("bracket.described_cells");
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+		std::vector<Cell> cells;
+		std::vector<CellVisual> visuals{indexes.size()};
+
+		// The layout changed since the indexes were computed
+		if (generation != this->_generation)
+			return;
+		cells.reserve(indexes.size());
+		for (auto index : indexes)
+			cells.push_back(this->_layout.cells[index]);
+
+		// Describing the cells may take a while, the GUI thread shouldn't wait for it
+		lock.unlock();
+		{
+			MetricsRegistry::Timer timer{describeTime};
+			TRACE_SCOPE("describeCells");
+
+			for (size_t i = 0; i < cells.size(); i++)
+				this->_describe(cells[i], visuals[i]);
+		}
+		described.add(cells.size());
+		lock.lock();
+		if (generation != this->_generation)
+			return;
+		for (size_t i = 0; i < indexes.size(); i++)
+			this->_visuals[indexes[i]] = std::move(visuals[i]);
+		this->_dirty = true;
+	}
+
+	void BracketView::update()
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+
+		if (
+			!this->_dirty &&
+			this->_panel->getContentOffset() == this->_lastOffset &&
+			this->_panel->getSize() == this->_lastSize
+		)
+			return;
+		this->_render();
+	}
+
+	bool BracketView::_isInPanel(sf::Vector2f pos) const
+	{
+		auto panelPos = this->_panel->getAbsolutePosition();
+		auto size = this->_panel->getSize();
+
+		return sf::FloatRect{panelPos.x, panelPos.y, size.x, size.y}.contains(pos);
+	}
+
+	void BracketView::handleEvent(const sf::Event &event, bool handledByGui)
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+		auto panelPos = this->_panel->getAbsolutePosition();
+		auto size = this->_panel->getSize();
+
+		switch (event.type) {
+		case sf::Event::MouseWheelScrolled: {
+			sf::Vector2f pos(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+
+			if (this->_isInPanel(pos))
+				this->zoom(std::pow(1.1f, event.mouseWheelScroll.delta), pos - sf::Vector2f{panelPos.x, panelPos.y});
+			break;
+		}
+		case sf::Event::MouseButtonPressed: {
+			sf::Vector2f pos(event.mouseButton.x, event.mouseButton.y);
+
+			if (event.mouseButton.button != sf::Mouse::Left && event.mouseButton.button != sf::Mouse::Middle)
+				break;
+			if (!this->_isInPanel(pos))
+				break;
+			this->_dragging = true;
+			this->_dragLast = pos;
+			break;
+		}
+		case sf::Event::MouseMoved: {
+			sf::Vector2f pos(event.mouseMove.x, event.mouseMove.y);
+
+			if (!this->_dragging)
+				break;
+			this->pan(this->_dragLast - pos);
+			this->_dragLast = pos;
+			break;
+		}
+		case sf::Event::MouseButtonReleased:
+		case sf::Event::MouseLeft:
+			this->_dragging = false;
+			break;
+		case sf::Event::KeyPressed:
+			if (handledByGui)
+				break;
+			switch (event.key.code) {
+			case sf::Keyboard::Left:
+				this->pan({-keyboardPanStep, 0});
+				break;
+			case sf::Keyboard::Right:
+				this->pan({keyboardPanStep, 0});
+				break;
+			case sf::Keyboard::Up:
+				this->pan({0, -keyboardPanStep});
+				break;
+			case sf::Keyboard::Down:
+				this->pan({0, keyboardPanStep});
+				break;
+			case sf::Keyboard::Add:
+			case sf::Keyboard::Equal:
+				this->zoom(1.25, {size.x / 2, size.y / 2});
+				break;
+			case sf::Keyboard::Subtract:
+			case sf::Keyboard::Hyphen:
+				this->zoom(0.8, {size.x / 2, size.y / 2});
+				break;
+			case sf::Keyboard::Home:
+				this->resetCamera();
+				break;
+			default:
+				break;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	void BracketView::zoom(float factor, sf::Vector2f pos)
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+		float zoom = std::min(std::max(this->_zoom * factor, minZoom), maxZoom);
+
+		// The point under pos must stay under pos
+		this->_camera += pos / this->_zoom - pos / zoom;
+		this->_zoom = zoom;
+		this->_clampCamera();
+		this->_dirty = true;
+	}
+
+	void BracketView::pan(sf::Vector2f offset)
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+
+		this->_camera += offset / this->_zoom;
+		this->_clampCamera();
+		this->_dirty = true;
+	}
+
+	void BracketView::resetCamera()
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+
+		this->_camera = {0, 0};
+		this->_zoom = 1;
+		this->_dirty = true;
+	}
+
+	float BracketView::getZoom() const
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+
+		return this->_zoom;
+	}
+
+	void BracketView::_clampCamera()
+	{
+		auto size = this->_panel->getSize();
+		float maxX = std::max(0.f, this->_layout.size.x - size.x / this->_zoom);
+		float maxY = std::max(0.f, this->_layout.size.y - size.y / this->_zoom);
+
+		this->_camera.x = std::min(std::max(this->_camera.x, 0.f), maxX);
+		this->_camera.y = std::min(std::max(this->_camera.y, 0.f), maxY);
+	}
+
+	tgui::Button::Ptr BracketView::_getButton(size_t index)
+	{
+		if (index < this->_buttons.size())
+			return this->_buttons[index];
+
+		auto button = tgui::Button::create();
+		auto renderer = button->getRenderer();
+
+		renderer->setBorders(0);
+		renderer->setBackgroundColor("transparent");
+		renderer->setBackgroundColorHover("#AAAAAA88");
+		renderer->setBackgroundColorDown("#AAAAAAAA");
+		this->_panel->add(button);
+		this->_buttons.push_back(button);
+		return button;
+	}
+
+	void BracketView::_render()
+	{
+		static const auto renderTime = MetricsRegistry::histogram("bracket.render_us");
+		MetricsRegistry::Timer timer{renderTime};
+		TRACE_SCOPE("BracketView::render");
+		auto offset = this->_panel->getContentOffset();
+		auto size = this->_panel->getSize();
+		sf::FloatRect viewport{this->_camera.x, this->_camera.y, size.x / this->_zoom, size.y / this->_zoom};
+		sf::RenderStates states;
+		size_t buttons = 0;
+		bool detailed = this->_zoom >= detailZoom;
+
+		if (!this->_renderer) {
+			this->_font = tgui::getGlobalFont().getFont();
+			this->_renderer = std::make_unique<BracketRenderer>(*this->_font);
+		}
+		if (!this->_canvas) {
+			this->_canvas = tgui::Canvas::create(size);
+			this->_panel->add(this->_canvas);
+			this->_canvas->moveToBack();
+		} else if (this->_canvas->getSize() != size)
+			this->_canvas->setSize(size);
+		// The camera replaces the scrollbars, so there is never anything to scroll
+		if (size != this->_lastSize) {
+			this->_panel->setContentSize(size);
+			this->_clampCamera();
+			viewport.left = this->_camera.x;
+			viewport.top = this->_camera.y;
+		}
+		this->_canvas->setPosition(offset);
+
+		this->_renderer->clear();
+		for (auto &section : this->_layout.sections)
+			if (isVisible(viewport, section.pos, section.size))
+				this->_renderer->addRect({section.pos.x, section.pos.y, section.size.x, section.size.y}, section.color);
+		for (auto &connector : this->_connectors) {
+			sf::Vector2f topLeft{connector.from.x, std::min(connector.from.y, connector.to.y)};
+			sf::Vector2f bounds{connector.to.x - connector.from.x, std::abs(connector.to.y - connector.from.y) + 1};
+
+			if (isVisible(viewport, topLeft, bounds))
+				this->_renderer->addConnector(connector.from, connector.to, sf::Color::Black);
+		}
+		for (auto &label : this->_layout.labels) {
+			if (!isVisible(viewport, label.pos, label.size))
+				continue;
+
+			sf::FloatRect rect{label.pos.x, label.pos.y, label.size.x, label.size.y};
+
+			this->_renderer->addRect(rect, label.backgroundColor);
+			if (detailed)
+				this->_renderer->addText(label.text, label.textSize, rect, label.textColor, true);
+		}
+		for (size_t i = 0; i < this->_layout.cells.size(); i++) {
+			auto &cell = this->_layout.cells[i];
+			auto &visual = this->_visuals[i];
+
+			if (!isVisible(viewport, cell.pos, BracketRenderer::cellSize))
+				continue;
+			if (detailed)
+				this->_renderer->addCell({cell.pos.x, cell.pos.y}, visual);
+			else
+				this->_renderer->addCellBlock({cell.pos.x, cell.pos.y}, visual);
+			if (!visual.joinable)
+				continue;
+
+			auto button = this->_getButton(buttons++);
+
+			button->setPosition(offset + (cell.pos - tgui::Vector2f{this->_camera.x, this->_camera.y}) * this->_zoom);
+			button->setSize(BracketRenderer::cellSize.x * this->_zoom, BracketRenderer::cellSize.y * this->_zoom);
+			button->disconnectAll("Clicked");
+			button->connect("Clicked", visual.onJoin);
+			button->setVisible(true);
+		}
+		for (size_t i = buttons; i < this->_usedButtons; i++)
+			this->_buttons[i]->setVisible(false);
+		this->_usedButtons = buttons;
+
+		states.transform.scale(this->_zoom, this->_zoom);
+		states.transform.translate(-this->_camera.x, -this->_camera.y);
+		this->_canvas->clear(backgroundColor);
+		this->_canvas->draw(*this->_renderer, states);
+		this->_canvas->display();
+		this->_drawCalls = this->_renderer->getDrawCallCount();
+		this->_lastOffset = offset;
+		this->_lastSize = size;
+		this->_dirty = false;
+	}
+
+	std::optional<size_t> BracketView::getCellIndex(size_t matchId) const
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+		auto it = this->_cellOfMatch.find(matchId);
+
+		if (it == this->_cellOfMatch.end())
+			return {};
+		return it->second;
+	}
+
+	size_t BracketView::getCellCount() const
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+
+		return this->_layout.cells.size();
+	}
+
+	size_t BracketView::getDrawCallCount() const
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+
+		return this->_drawCalls;
+	}
+
+	size_t BracketView::getMaterializedCount() const
+	{
+		std::unique_lock<std::recursive_mutex> lock{this->_mutex};
+
+		return this->_buttons.size();
+	}
+}
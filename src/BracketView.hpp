@@ -0,0 +1,130 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_BRACKETVIEW_HPP
+#define CHALLONGESOKU_BRACKETVIEW_HPP
+
+
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <TGUI/TGUI.hpp>
+#include "Bracket.hpp"
+#include "BracketRenderer.hpp"
+
+namespace ChallongeSoku
+{
+	//! @brief Virtualized view of a bracket inside a ScrollablePanel.
+	//! @details The layout is computed once as plain rectangles. The visible part is drawn by a BracketRenderer
+	//! on a canvas covering the panel, through a camera that can be zoomed and panned. The only widgets are
+	//! the join buttons, taken from a recycled pool and only given to visible cells that can be joined.
+	//! Below detailZoom, cells are drawn as plain blocks of their background color and labels lose their text.
+	class BracketView {
+	public:
+		struct Cell {
+			tgui::Vector2f pos;
+			std::shared_ptr<ChallongeAPI::Match> match;
+			const Bracket *bracket;
+			bool isGroup;
+		};
+
+		struct Label {
+			std::string text;
+			tgui::Vector2f pos;
+			tgui::Vector2f size;
+			unsigned textSize;
+			tgui::Color textColor;
+			tgui::Color backgroundColor;
+		};
+
+		struct Section {
+			tgui::Vector2f pos;
+			tgui::Vector2f size;
+			tgui::Color color;
+		};
+
+		struct Layout {
+			std::vector<Section> sections;
+			std::vector<Label> labels;
+			std::vector<Cell> cells;
+			tgui::Vector2f size;
+		};
+
+		typedef std::function<void (const Cell &cell, CellVisual &visual)> DescribeCallback;
+
+		static const sf::Color backgroundColor;
+		static constexpr float minZoom = 0.1;
+		static constexpr float maxZoom = 3;
+		//! @brief Under this zoom level, text and portraits are not drawn anymore.
+		static constexpr float detailZoom = 0.5;
+		//! @brief How far the arrow keys move the camera, in pixels on screen.
+		static constexpr float keyboardPanStep = 60;
+
+		BracketView(const tgui::ScrollablePanel::Ptr &panel, const DescribeCallback &describe);
+
+		//! @brief Replace the layout. Cells of matches that were already shown keep their look, others are blank until the next refresh.
+		void	setLayout(Layout &&layout);
+		//! @brief Redraw the canvas if the viewport moved or the cells changed. Must be called from the GUI thread.
+		void	update();
+		//! @brief Zoom with the wheel or +/-, pan by dragging or with the arrows, Home to reset.
+		//! @details Keyboard events are ignored when a widget already used them. Must be called from the GUI thread.
+		void	handleEvent(const sf::Event &event, bool handledByGui);
+		//! @brief Multiply the zoom, keeping the point at pos (relative to the panel) still.
+		void	zoom(float factor, sf::Vector2f pos);
+		//! @brief Move the camera by an offset in pixels on screen.
+		void	pan(sf::Vector2f offset);
+		void	resetCamera();
+		float	getZoom() const;
+		//! @brief Describe every cell again.
+		void	refresh();
+		//! @brief Describe again the cells of some matches only.
+		void	refresh(const std::vector<size_t> &matchIds);
+		//! @brief Index of the cell showing a match, if it is in the layout.
+		std::optional<size_t> getCellIndex(size_t matchId) const;
+		size_t	getCellCount() const;
+		size_t	getDrawCallCount() const;
+		size_t	getMaterializedCount() const;
+
+	private:
+		struct Connector {
+			sf::Vector2f from;
+			sf::Vector2f to;
+		};
+
+		mutable std::recursive_mutex _mutex;
+		tgui::ScrollablePanel::Ptr _panel;
+		DescribeCallback _describe;
+		Layout _layout;
+		unsigned _generation = 0;
+		std::vector<CellVisual> _visuals;
+		std::unordered_map<size_t, size_t> _cellOfMatch;
+		std::vector<Connector> _connectors;
+		std::shared_ptr<sf::Font> _font;
+		std::unique_ptr<BracketRenderer> _renderer;
+		tgui::Canvas::Ptr _canvas;
+		std::vector<tgui::Button::Ptr> _buttons;
+		size_t _usedButtons = 0;
+		size_t _drawCalls = 0;
+		tgui::Vector2f _lastOffset;
+		tgui::Vector2f _lastSize;
+		sf::Vector2f _camera;
+		float _zoom = 1;
+		bool _dragging = false;
+		sf::Vector2f _dragLast;
+		bool _dirty = true;
+
+		void	_computeConnectors();
+		void	_clampCamera();
+		bool	_isInPanel(sf::Vector2f pos) const;
+		void	_describeCells(std::vector<size_t> &&indexes, unsigned generation);
+		void	_render();
+		tgui::Button::Ptr _getButton(size_t index);
+	};
+}
+
+
+#endif //CHALLONGESOKU_BRACKETVIEW_HPP
@@ -0,0 +1,177 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <map>
+#include <set>
+#include <algorithm>
+#include <mutex>
+#include <memory>
+#include <Exceptions.hpp>
+#include "ConnectionPool.hpp"
+#include "MetricsRegistry.hpp"
+#include "TaskPool.hpp"
+#include "TlsConnection.hpp"
+
+using namespace ChallongeAPI;
+
+namespace ChallongeSoku
+{
+	typedef std::pair<std::string, unsigned short> Endpoint;
+
+	struct Connection {
+		std::unique_ptr<TlsConnection> socket;
+		MetricsRegistry::Clock::time_point opened;
+	};
+
+	struct Pool {
+		std::mutex mutex;
+		bool stopping = false;
+		std::set<Endpoint> warmed;
+		// Connections being opened by a task
+		std::map<Endpoint, size_t> connecting;
+		std::map<Endpoint, std::vector<Connection>> idle;
+	};
+
+	static Pool &getPool()
+	{
+		static Pool pool;
+
+		return pool;
+	}
+
+	static bool isExpired(const Connection &connection)
+	{
+		return MetricsRegistry::Clock::now() - connection.opened >= std::chrono::duration<float>(ConnectionPool::maxIdle);
+	}
+
+	static void openConnection(Pool &pool, const Endpoint &endpoint)
+	{
+		static const auto connectTime = MetricsRegistry::histogram("connections.connect_us");
+		static const auto connectErrors = MetricsRegistry::counter("connections.connect_errors");
+		// Declared first so a connection nobody wants is closed once the lock is released
+		Connection connection{std::make_unique<TlsConnection>()};
+		std::unique_lock<std::mutex> lock{pool.mutex};
+
+		// The host stopped being warmed since
+		if (pool.stopping || !pool.warmed.count(endpoint)) {
+			pool.connecting[endpoint]--;
+			return;
+		}
+		lock.unlock();
+		try {
+			MetricsRegistry::Timer timer{connectTime};
+
+			connection.socket->connect(endpoint.first, endpoint.second);
+			connection.opened = MetricsRegistry::Clock::now();
+		} catch (NetworkException &) {
+			// The request will connect by itself and report the error
+			connectErrors.add();
+			connection.socket.reset();
+		}
+		lock.lock();
+		pool.connecting[endpoint]--;
+		if (connection.socket && !pool.stopping && pool.warmed.count(endpoint))
+			pool.idle[endpoint].push_back(std::move(connection));
+	}
+
+	// Pool mutex must be held
+	static void queueConnections(Pool &pool, const Endpoint &endpoint)
+	{
+		auto &idle = pool.idle[endpoint];
+		auto &connecting = pool.connecting[endpoint];
+
+		idle.erase(std::remove_if(idle.begin(), idle.end(), isExpired), idle.end());
+		for (size_t count = connecting + idle.size(); count < ConnectionPool::connectionsPerHost; count++)
+			if (TaskPool::post("ConnectionPool::connect", [&pool, endpoint]{ openConnection(pool, endpoint); }))
+				connecting++;
+	}
+
+	static Socket::HttpResponse sendRequest(TlsConnection &socket, const Socket::HttpRequest &request)
+	{
+		std::string answer;
+
+		socket.send(Socket::generateHttpRequest(request));
+		answer = socket.readUntilEOF();
+		socket.disconnect();
+		if (answer.empty())
+			throw EOFException("Connection closed by " + request.host + " before answering");
+		return Socket::parseHttpResponse(answer);
+	}
+
+	void ConnectionPool::warm(const std::vector<std::string> &hosts, unsigned short portno)
+	{
+		auto &pool = getPool();
+		std::vector<Connection> closed;
+		std::unique_lock<std::mutex> lock{pool.mutex};
+
+		if (pool.stopping)
+			return;
+		pool.warmed.clear();
+		for (auto &host : hosts)
+			pool.warmed.emplace(host, portno);
+		for (auto it = pool.idle.begin(); it != pool.idle.end(); ) {
+			if (pool.warmed.count(it->first)) {
+				it++;
+				continue;
+			}
+			for (auto &connection : it->second)
+				closed.push_back(std::move(connection));
+			it = pool.idle.erase(it);
+		}
+		for (auto &endpoint : pool.warmed)
+			queueConnections(pool, endpoint);
+	}
+
+	void ConnectionPool::stop()
+	{
+		auto &pool = getPool();
+		std::unique_lock<std::mutex> lock{pool.mutex};
+		auto idle = std::move(pool.idle);
+
+		pool.stopping = true;
+		pool.warmed.clear();
+		pool.idle.clear();
+		lock.unlock();
+	}
+
+	Socket::HttpResponse ConnectionPool::makeHttpRequest(Socket::HttpRequest request)
+	{
+		static const auto warmHits = MetricsRegistry::counter("connections.warm_hits");
+		static const auto coldConnects = MetricsRegistry::counter("connections.cold");
+		static const auto staleConnections = MetricsRegistry::counter("connections.stale");
+		auto &pool = getPool();
+		Endpoint endpoint{request.host, request.portno};
+		std::unique_ptr<TlsConnection> socket;
+		std::unique_lock<std::mutex> lock{pool.mutex};
+
+		if (pool.warmed.count(endpoint)) {
+			auto &idle = pool.idle[endpoint];
+
+			idle.erase(std::remove_if(idle.begin(), idle.end(), isExpired), idle.end());
+			if (!idle.empty()) {
+				socket = std::move(idle.front().socket);
+				idle.erase(idle.begin());
+			}
+			// Open the next one while this request runs
+			queueConnections(pool, endpoint);
+		}
+		lock.unlock();
+
+		request.header["Connection"] = "close";
+		if (socket) {
+			try {
+				warmHits.add();
+				return sendRequest(*socket, request);
+			} catch (NetworkException &) {
+				staleConnections.add();
+			}
+		}
+
+		TlsConnection fresh;
+
+		coldConnects.add();
+		fresh.connect(request.host, request.portno);
+		return sendRequest(fresh, request);
+	}
+}
@@ -0,0 +1,45 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_CONNECTIONPOOL_HPP
+#define CHALLONGESOKU_CONNECTIONPOOL_HPP
+
+
+#include <string>
+#include <vector>
+#include <Socket.hpp>
+
+namespace ChallongeSoku
+{
+	//! @brief Process wide pool of TLS connections opened ahead of the requests needing them.
+	//! @details Every request closes its connection, so each one used to pay a full TCP and TLS
+	//! handshake before sending anything. Connections to the hosts which were warmed are opened by
+	//! TaskPool tasks, and requests to these hosts take one instead of connecting. Whenever one is
+	//! taken, another is opened to the same host while the request is running, so a series of
+	//! requests only waits for the first handshake. Connections are TlsConnections, so after the
+	//! first one to a host the handshakes resume its session. Connections idle for longer than
+	//! maxIdle are not used, as servers drop them anyway.
+	class ConnectionPool {
+	public:
+		//! @brief Seconds a connection stays usable after being opened.
+		static constexpr float maxIdle = 20;
+		//! @brief Connections kept open ahead for each warmed host.
+		static constexpr size_t connectionsPerHost = 1;
+
+		//! @brief Open connections to these hosts in the background, and keep doing so as they are used.
+		//! @details Replaces the hosts warmed before, and closes the connections opened to the others.
+		static void	warm(const std::vector<std::string> &hosts, unsigned short portno = 443);
+		//! @brief Close every connection and stop opening new ones.
+		//! @details Connections still being opened are closed once they are.
+		static void	stop();
+		//! @brief Send a request over a warm connection, or a new one if there is none.
+		//! @details Requests are sent with "Connection: close", the connection is not reused.
+		//! A warm connection which was closed by the server is retried once on a new connection.
+		//! @throw NetworkException
+		static ChallongeAPI::Socket::HttpResponse makeHttpRequest(ChallongeAPI::Socket::HttpRequest request);
+	};
+}
+
+
+#endif //CHALLONGESOKU_CONNECTIONPOOL_HPP
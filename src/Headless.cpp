@@ -0,0 +1,181 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <ctime>
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <optional>
+#include <iostream>
+#include "Headless.hpp"
+#include "SyncEngine.hpp"
+#include "StatusServer.hpp"
+#include "AutoDirector.hpp"
+#include "TaskPool.hpp"
+#include "Resolver.hpp"
+#include "MetricsRegistry.hpp"
+#include "Tracer.hpp"
+
+namespace ChallongeSoku
+{
+	static std::atomic<bool> interrupted{false};
+
+	static void onSignal(int)
+	{
+		interrupted = true;
+	}
+
+	static void saveMetrics(const std::string &path)
+	{
+		try {
+			MetricsRegistry::save(path);
+		} catch (std::exception &e) {
+			std::cerr << "Cannot save metrics: " << e.what() << std::endl;
+		}
+	}
+
+	static void logEvent(const SyncEngine::Event &event)
+	{
+		char date[32];
+		auto now = std::time(nullptr);
+
+		std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+		std::cout << "[" << date << "] "
+			<< SyncEngine::eventTypeStrings[event.type] << " "
+			<< SyncEngine::channelStrings[event.channel] << " "
+			<< SyncEngine::levelStrings[event.level];
+		if (!event.title.empty())
+			std::cout << " \"" << event.title << "\"";
+		if (!event.message.empty())
+			std::cout << ": " << event.message;
+		if (!event.matchIds.empty())
+			std::cout << " (" << event.matchIds.size() << " match(es))";
+		std::cout << std::endl;
+	}
+
+	int runHeadless(const std::vector<std::string> &args)
+	{
+		std::string settingsPath = "settings.json";
+		std::string url;
+		std::optional<unsigned short> port;
+		SyncEngine::Config config;
+		AutoDirector::Config directorConfig;
+		bool forceDirector = false;
+		std::string recordPath;
+		std::string replayPath;
+		std::string metricsPath;
+		std::string tracePath;
+		float replaySpeed = 1;
+		SyncEngine engine;
+		StatusServer server{engine};
+		AutoDirector director{engine};
+
+		for (size_t i = 0; i < args.size(); i++) {
+			if (args[i] == "--headless")
+				continue;
+			if (args[i] == "--port" && i + 1 < args.size())
+				port = std::stoul(args[++i]);
+			else if (args[i] == "--settings" && i + 1 < args.size())
+				settingsPath = args[++i];
+			else if (args[i] == "--auto-director")
+				forceDirector = true;
+			else if (args[i] == "--record" && i + 1 < args.size())
+				recordPath = args[++i];
+			else if (args[i] == "--replay" && i + 1 < args.size())
+				replayPath = args[++i];
+			else if (args[i] == "--replay-speed" && i + 1 < args.size())
+				replaySpeed = std::stof(args[++i]);
+			else if (args[i] == "--metrics" && i + 1 < args.size())
+				metricsPath = args[++i];
+			else if (args[i] == "--trace" && i + 1 < args.size())
+				tracePath = args[++i];
+			else if (args[i].compare(0, 2, "--") == 0) {
+				std::cerr << "Usage: --headless [--port <port>] [--settings <path>] [--auto-director] [--record <path> | --replay <path> [--replay-speed <speed>]] [--metrics <path>] [--trace <path>] [tournament url]" << std::endl;
+				return EXIT_FAILURE;
+			} else
+				url = args[i];
+		}
+
+		std::ifstream file{settingsPath};
+
+		if (!file.fail())
+			try {
+				nlohmann::json value;
+
+				file >> value;
+				config.load(value);
+				if (value.contains("autoDirector"))
+					directorConfig.load(value["autoDirector"]);
+				if (!port && value.contains("statusPort"))
+					port = value["statusPort"].get<unsigned short>();
+			} catch (std::exception &e) {
+				std::cerr << "Error: Cannot load settings from " << settingsPath << ": " << e.what() << std::endl;
+				return EXIT_FAILURE;
+			}
+		try {
+			if (!recordPath.empty())
+				engine.getTrafficLog().startRecording(recordPath);
+			else if (!replayPath.empty()) {
+				engine.getTrafficLog().startReplay(replayPath, replaySpeed);
+				if (url.empty())
+					url = engine.getTrafficLog().getRecordedTournament().value_or("");
+			}
+		} catch (std::exception &e) {
+			std::cerr << "Error: " << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+		engine.setConfig(config);
+		directorConfig.enabled |= forceDirector;
+		director.setConfig(directorConfig);
+		engine.addListener(logEvent);
+		engine.addListener([&server](const SyncEngine::Event &event){
+			server.onEvent(event);
+		});
+		engine.addListener([&director](const SyncEngine::Event &event){
+			director.onEvent(event);
+		});
+		try {
+			server.start(port.value_or(14763));
+		} catch (std::exception &e) {
+			std::cerr << "Error: " << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (!tracePath.empty())
+			Tracer::enable();
+		std::signal(SIGINT, onSignal);
+		std::signal(SIGTERM, onSignal);
+#ifdef SIGPIPE
+		// OpenSSL writes with write(), which can't be given MSG_NOSIGNAL: writing to a TLS connection
+		// the server closed would kill the process instead of failing with EPIPE.
+		std::signal(SIGPIPE, SIG_IGN);
+#endif
+		if (!url.empty())
+			engine.load(url);
+		engine.start();
+		director.start();
+		for (auto lastSave = std::chrono::steady_clock::now(); !interrupted; ) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			if (metricsPath.empty() || std::chrono::steady_clock::now() - lastSave < std::chrono::duration<float>(MetricsRegistry::saveInterval))
+				continue;
+			saveMetrics(metricsPath);
+			lastSave = std::chrono::steady_clock::now();
+		}
+		std::cout << "Stopping" << std::endl;
+		director.stop();
+		engine.stop();
+		server.stop();
+		Resolver::stop();
+		TaskPool::stop();
+		if (!metricsPath.empty())
+			saveMetrics(metricsPath);
+		if (!tracePath.empty())
+			try {
+				Tracer::save(tracePath);
+			} catch (std::exception &e) {
+				std::cerr << "Cannot save trace: " << e.what() << std::endl;
+			}
+		return EXIT_SUCCESS;
+	}
+}
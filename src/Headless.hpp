@@ -0,0 +1,24 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_HEADLESS_HPP
+#define CHALLONGESOKU_HEADLESS_HPP
+
+
+#include <string>
+#include <vector>
+
+namespace ChallongeSoku
+{
+	//! @brief Run the SyncEngine without any window until interrupted.
+	//! @details Every event is logged on its own line and the status API is served on the loopback interface.
+	//! Recognized arguments are --headless, --port <port>, --settings <path>, --auto-director
+	//! (enables the AutoDirector whatever the settings say), --record <path>, --replay <path>, --replay-speed <speed>
+	//! (see TrafficLog) and the URL of the tournament to follow, which defaults to the recorded one when replaying.
+	//! @return The process exit code.
+	int	runHeadless(const std::vector<std::string> &args);
+}
+
+
+#endif //CHALLONGESOKU_HEADLESS_HPP
@@ -0,0 +1,257 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+#include <winsock2.h>
+#define closeSocket closesocket
+#else
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#define closeSocket close
+#endif
+#include <set>
+#include <algorithm>
+#include <Exceptions.hpp>
+#include <JsonUtils.hpp>
+#include "KonniClient.hpp"
+#include "Resolver.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace ChallongeAPI;
+
+namespace ChallongeSoku
+{
+	static void waitFor(intptr_t sock, bool write, Resolver::Clock::time_point deadline, const std::string &host)
+	{
+		auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Resolver::Clock::now()).count();
+		fd_set set;
+		timeval timeout;
+
+		if (remaining <= 0)
+			throw NetworkException("Timed out polling " + host);
+		timeout.tv_sec = remaining / 1000000;
+		timeout.tv_usec = remaining % 1000000;
+		FD_ZERO(&set);
+		FD_SET(sock, &set);
+		if (select(static_cast<int>(sock + 1), write ? nullptr : &set, write ? &set : nullptr, nullptr, &timeout) <= 0)
+			throw NetworkException("Timed out polling " + host);
+	}
+
+	// Plain HTTP over a connection from the Resolver, the answer is read until Konni closes it
+	static Socket::HttpResponse sendRequest(const Socket::HttpRequest &request)
+	{
+		auto deadline = Resolver::Clock::now() + std::chrono::duration_cast<Resolver::Clock::duration>(std::chrono::duration<float>(KonniClient::timeout));
+		auto data = Socket::generateHttpRequest(request);
+		Socket::HttpResponse response;
+		std::string answer;
+		char buffer[4096];
+		intptr_t sock;
+
+		try {
+			sock = Resolver::connect(request.host, request.portno, deadline);
+		} catch (std::runtime_error &e) {
+			throw NetworkException(e.what());
+		}
+		try {
+			for (size_t sent = 0; sent < data.size(); ) {
+				waitFor(sock, true, deadline, request.host);
+
+				auto size = ::send(sock, data.c_str() + sent, static_cast<int>(data.size() - sent), MSG_NOSIGNAL);
+
+				if (size <= 0)
+					throw NetworkException("Cannot send to " + request.host);
+				sent += size;
+			}
+			while (true) {
+				waitFor(sock, false, deadline, request.host);
+
+				auto size = recv(sock, buffer, sizeof(buffer), 0);
+
+				if (size == 0)
+					break;
+				if (size < 0)
+					throw NetworkException("Cannot read from " + request.host);
+				answer.append(buffer, size);
+			}
+		} catch (...) {
+			closeSocket(sock);
+			throw;
+		}
+		closeSocket(sock);
+		if (answer.empty())
+			throw EOFException("Connection closed by " + request.host + " before answering");
+		response = Socket::parseHttpResponse(answer);
+		response.request = request;
+		if (response.returnCode >= 400)
+			throw HTTPErrorException(response);
+		return response;
+	}
+
+	KonniMatch::KonniMatch(const nlohmann::json &value)
+	{
+		getFromJson(this->autopunch,       "autopunch", value);
+		getFromJson(this->clientChallonge, "client_challonge", value);
+		getFromJson(this->clientCharacter, "client_character", value);
+		getFromJson(this->clientCountry,   "client_country", value);
+		getFromJson(this->clientName,      "client_name", value);
+		getFromJson(this->hostChallonge,   "host_challonge", value);
+		getFromJson(this->hostCharacter,   "host_character", value);
+		getFromJson(this->hostCountry,     "host_country", value);
+		getFromJson(this->hostName,        "host_name", value);
+		getFromJson(this->ip,              "ip", value);
+		getFromJson(this->message,         "message", value);
+		getFromJson(this->ranked,          "ranked", value);
+		getFromJson(this->spectatable,     "spectatable", value);
+		getFromJson(this->spectators,      "spectators", value);
+		getFromJson(this->start,           "start", value);
+		getFromJson(this->gameStarted,     "started", value);
+
+		size_t portPos = this->ip.find(':');
+
+		this->port = std::stoul(this->ip.substr(portPos + 1));
+		this->ip = this->ip.substr(0, portPos);
+	}
+
+	KonniClient::KonniClient(const std::string &host, unsigned short port) :
+		_host(host),
+		_port(port)
+	{
+	}
+
+	void KonniClient::setEndpoint(const std::string &host, unsigned short port)
+	{
+		if (host == this->_host && port == this->_port)
+			return;
+		this->_host = host;
+		this->_port = port;
+		this->reset();
+	}
+
+	const std::string &KonniClient::getHost() const
+	{
+		return this->_host;
+	}
+
+	unsigned short KonniClient::getPort() const
+	{
+		return this->_port;
+	}
+
+	void KonniClient::reset()
+	{
+		this->_etag.clear();
+		this->_since.clear();
+		this->_games.clear();
+		this->_list.clear();
+	}
+
+	const std::vector<KonniMatch> &KonniClient::getGames() const
+	{
+		return this->_list;
+	}
+
+	KonniClient::PollResult KonniClient::poll(const std::string &tournament, TrafficLog &traffic)
+	{
+		Socket::HttpRequest requ;
+		PollResult result;
+
+		if (tournament != this->_tournament) {
+			this->reset();
+			this->_tournament = tournament;
+		}
+		requ.portno = this->_port;
+		requ.host = this->_host;
+		requ.httpVer = "HTTP/1.1";
+		requ.method = "GET";
+		requ.path = "/games?tourney=" + tournament;
+		if (!this->_since.empty())
+			requ.path += "&since=" + this->_since;
+		if (!this->_etag.empty())
+			requ.header["If-None-Match"] = this->_etag;
+		requ.header["Connection"] = "close";
+
+		auto res = traffic.makeHttpRequest(requ, [&requ]{
+			return sendRequest(requ);
+		});
+
+		if (res.returnCode == 304)
+			return result;
+
+		this->_etag.clear();
+		for (auto &field : res.header) {
+			std::string name = field.first;
+
+			std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+			if (name == "etag")
+				this->_etag = field.second;
+		}
+
+		auto j = nlohmann::json::parse(res.body);
+
+		if (j.is_object() && j.contains("games"))
+			this->_applyDelta(j, result);
+		else
+			this->_applyFullList(j, result);
+
+		result.changed = result.added || result.updated || result.removed;
+		if (!result.changed)
+			return result;
+		this->_list.clear();
+		this->_list.reserve(this->_games.size());
+		for (auto &game : this->_games)
+			this->_list.push_back(game.second.match);
+		return result;
+	}
+
+	void KonniClient::_updateGame(const nlohmann::json &value, PollResult &result)
+	{
+		std::string key = value["ip"];
+		auto it = this->_games.find(key);
+
+		if (it == this->_games.end()) {
+			this->_games.emplace(key, Game{value, KonniMatch(value)});
+			result.added++;
+		} else if (it->second.raw != value) {
+			it->second.match = KonniMatch(value);
+			it->second.raw = value;
+			result.updated++;
+		}
+	}
+
+	void KonniClient::_applyFullList(const nlohmann::json &value, PollResult &result)
+	{
+		std::set<std::string> seen;
+
+		this->_since.clear();
+		for (auto &game : value) {
+			this->_updateGame(game, result);
+			seen.insert(game["ip"].get<std::string>());
+		}
+		for (auto it = this->_games.begin(); it != this->_games.end(); )
+			if (seen.count(it->first))
+				it++;
+			else {
+				it = this->_games.erase(it);
+				result.removed++;
+			}
+	}
+
+	void KonniClient::_applyDelta(const nlohmann::json &value, PollResult &result)
+	{
+		if (value.contains("full") && value["full"].get<bool>())
+			this->_applyFullList(value["games"], result);
+		else {
+			for (auto &game : value["games"])
+				this->_updateGame(game, result);
+			if (value.contains("removed"))
+				for (auto &ip : value["removed"])
+					result.removed += this->_games.erase(ip.get<std::string>());
+		}
+		getFromJson(this->_since, "since", value);
+	}
+}
@@ -0,0 +1,93 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_KONNICLIENT_HPP
+#define CHALLONGESOKU_KONNICLIENT_HPP
+
+
+#include <map>
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include <Socket.hpp>
+#include "TrafficLog.hpp"
+
+namespace ChallongeSoku
+{
+	struct KonniMatch {
+		bool autopunch;
+		std::string clientChallonge;
+		std::string clientCharacter;
+		std::string clientCountry;
+		std::string clientName;
+		std::string hostChallonge;
+		std::string hostCharacter;
+		std::string hostCountry;
+		std::string hostName;
+		std::string ip;
+		unsigned short port;
+		std::string message;
+		bool ranked;
+		bool spectatable;
+		unsigned spectators;
+		time_t start;
+		bool gameStarted;
+		bool expired = false;
+
+		KonniMatch() = default;
+		KonniMatch(const nlohmann::json &value);
+	};
+
+	//! @brief Keeps an up to date copy of the games Konni knows for a tournament.
+	//! @details Polls are conditional (If-None-Match) so an unchanged game list is neither transferred nor parsed.
+	//! If the server answers with a since token, the next poll only asks for the games that changed since then.
+	//! Otherwise, only the games whose JSON differs from the last poll are converted again.
+	//! Konni is reached through the Resolver, so once its address is known, a slow DNS doesn't stall the polls.
+	class KonniClient {
+	public:
+		struct PollResult {
+			bool changed = false;
+			size_t added = 0;
+			size_t updated = 0;
+			size_t removed = 0;
+		};
+
+		//! @brief Seconds a poll has, from resolving Konni's host to reading its answer.
+		static constexpr float timeout = 10;
+
+		KonniClient(const std::string &host = "delthas.fr", unsigned short port = 14762);
+
+		void	setEndpoint(const std::string &host, unsigned short port);
+		const std::string &getHost() const;
+		unsigned short getPort() const;
+
+		//! @brief Fetch the games hosted for a tournament, through the engine's TrafficLog so polls can be recorded and replayed.
+		//! @throw HTTPErrorException The server answered with an error code.
+		//! @throw NetworkException Konni couldn't be reached or didn't answer in time.
+		PollResult poll(const std::string &tournament, TrafficLog &traffic);
+		const std::vector<KonniMatch> &getGames() const;
+		void	reset();
+
+	private:
+		struct Game {
+			nlohmann::json raw;
+			KonniMatch match;
+		};
+
+		std::string _host;
+		unsigned short _port;
+		std::string _tournament;
+		std::string _etag;
+		std::string _since;
+		std::map<std::string, Game> _games;
+		std::vector<KonniMatch> _list;
+
+		void	_updateGame(const nlohmann::json &value, PollResult &result);
+		void	_applyFullList(const nlohmann::json &value, PollResult &result);
+		void	_applyDelta(const nlohmann::json &value, PollResult &result);
+	};
+}
+
+
+#endif //CHALLONGESOKU_KONNICLIENT_HPP
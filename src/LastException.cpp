@@ -0,0 +1,33 @@
+//
+// Created by Gegel85 on 07/04/2020.
+//
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+#include <cstdlib>
+#include "LastException.hpp"
+
+namespace Utils
+{
+	std::string getLastExceptionName()
+	{
+#ifdef __GNUG__
+		int status;
+		char *value;
+		std::string name;
+
+		auto val = abi::__cxa_current_exception_type();
+
+		if (!val)
+			return "No exception";
+
+		value = abi::__cxa_demangle(val->name(), nullptr, nullptr, &status);
+		name = value;
+		free(value);
+		return name;
+#else
+		return "Unknown exception";
+#endif
+	}
+}
@@ -0,0 +1,20 @@
+//
+// Created by Gegel85 on 07/04/2020.
+//
+
+#ifndef CHALLONGESOKU_LASTEXCEPTION_HPP
+#define CHALLONGESOKU_LASTEXCEPTION_HPP
+
+
+#include <string>
+
+namespace Utils
+{
+	//! @brief Get the last Exception Name
+	//! @details Return the last type of Exception name
+	//! @return std::string The last Exception name
+	std::string getLastExceptionName();
+}
+
+
+#endif //CHALLONGESOKU_LASTEXCEPTION_HPP
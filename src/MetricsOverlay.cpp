@@ -0,0 +1,78 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <cstdio>
+#include <TGUI/TGUI.hpp>
+#include "MetricsOverlay.hpp"
+
+namespace ChallongeSoku
+{
+	static std::string toMilliseconds(uint64_t us)
+	{
+		char buffer[32];
+
+		snprintf(buffer, sizeof(buffer), "%.2fms", us / 1000.);
+		return buffer;
+	}
+
+	void MetricsOverlay::toggle()
+	{
+		this->_visible = !this->_visible;
+		// Show fresh values right away
+		this->_lastRefresh = {};
+	}
+
+	bool MetricsOverlay::isVisible() const
+	{
+		return this->_visible;
+	}
+
+	void MetricsOverlay::draw(sf::RenderTarget &target)
+	{
+		if (!this->_visible)
+			return;
+		if (!this->_font) {
+			this->_font = tgui::getGlobalFont().getFont();
+			this->_text.setFont(*this->_font);
+			this->_text.setCharacterSize(textSize);
+			this->_text.setFillColor(sf::Color::White);
+			this->_text.setPosition(10, 30);
+			this->_background.setFillColor(sf::Color{0, 0, 0, 0xC0});
+		}
+		if (MetricsRegistry::Clock::now() - this->_lastRefresh >= std::chrono::duration<float>(refreshInterval))
+			this->_refresh();
+
+		auto view = target.getView();
+		auto size = target.getSize();
+
+		target.setView(sf::View{sf::FloatRect{0, 0, static_cast<float>(size.x), static_cast<float>(size.y)}});
+		target.draw(this->_background);
+		target.draw(this->_text);
+		target.setView(view);
+	}
+
+	void MetricsOverlay::_refresh()
+	{
+		auto snapshot = MetricsRegistry::snapshot();
+		std::string text;
+
+		for (auto &histogram : snapshot.histograms)
+			text += histogram.first + ": p50 " + toMilliseconds(histogram.second.getPercentile(50)) +
+				", p99 " + toMilliseconds(histogram.second.getPercentile(99)) +
+				", max " + toMilliseconds(histogram.second.max) +
+				" (" + std::to_string(histogram.second.count) + ")\n";
+		for (auto &gauge : snapshot.gauges)
+			text += gauge.first + ": " + std::to_string(static_cast<long long>(gauge.second)) + "\n";
+		for (auto &counter : snapshot.counters)
+			text += counter.first + ": " + std::to_string(counter.second) + "\n";
+		text += "F3 to hide";
+		this->_text.setString(text);
+
+		auto bounds = this->_text.getGlobalBounds();
+
+		this->_background.setPosition(bounds.left - 5, bounds.top - 5);
+		this->_background.setSize({bounds.width + 10, bounds.height + 10});
+		this->_lastRefresh = MetricsRegistry::Clock::now();
+	}
+}
@@ -0,0 +1,40 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_METRICSOVERLAY_HPP
+#define CHALLONGESOKU_METRICSOVERLAY_HPP
+
+
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include "MetricsRegistry.hpp"
+
+namespace ChallongeSoku
+{
+	//! @brief Every metric of the MetricsRegistry, drawn on top of the window by the main loop.
+	//! @details Taking a snapshot sums every thread's shard, so the text is only built again a few times per second.
+	class MetricsOverlay {
+	public:
+		//! @brief Seconds between two snapshots.
+		static constexpr float refreshInterval = 0.5;
+		static constexpr unsigned textSize = 12;
+
+		void	toggle();
+		bool	isVisible() const;
+		//! @brief Draw in the top left corner of the target, whatever its view. Must be called from the GUI thread.
+		void	draw(sf::RenderTarget &target);
+
+	private:
+		bool _visible = false;
+		std::shared_ptr<sf::Font> _font;
+		sf::Text _text;
+		sf::RectangleShape _background;
+		MetricsRegistry::Clock::time_point _lastRefresh;
+
+		void	_refresh();
+	};
+}
+
+
+#endif //CHALLONGESOKU_METRICSOVERLAY_HPP
@@ -0,0 +1,264 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <mutex>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <fstream>
+#include <stdexcept>
+#include "MetricsRegistry.hpp"
+
+namespace ChallongeSoku
+{
+	struct HistogramShard {
+		std::array<std::atomic<uint64_t>, MetricsRegistry::bucketCount> buckets{};
+		std::atomic<uint64_t> count{0};
+		std::atomic<uint64_t> sum{0};
+		std::atomic<uint64_t> max{0};
+	};
+
+	// Only written by its own thread, read by whoever takes a snapshot
+	struct Shard {
+		std::array<std::atomic<uint64_t>, MetricsRegistry::maxCounters> counters{};
+		// Allocated the first time the thread records a value in them
+		std::array<std::atomic<HistogramShard *>, MetricsRegistry::maxHistograms> histograms{};
+
+		~Shard()
+		{
+			for (auto &histogram : this->histograms)
+				delete histogram.load();
+		}
+	};
+
+	struct Registry {
+		std::mutex mutex;
+		std::vector<std::string> counterNames;
+		std::vector<std::string> gaugeNames;
+		std::vector<std::string> histogramNames;
+		std::vector<Shard *> shards;
+		// What the threads which exited recorded
+		std::array<uint64_t, MetricsRegistry::maxCounters> retiredCounters{};
+		std::array<MetricsRegistry::HistogramSnapshot, MetricsRegistry::maxHistograms> retiredHistograms;
+		std::array<std::atomic<double>, MetricsRegistry::maxGauges> gauges{};
+	};
+
+	static Registry &getRegistry()
+	{
+		static Registry registry;
+
+		return registry;
+	}
+
+	static void addHistogram(MetricsRegistry::HistogramSnapshot &result, const HistogramShard &shard)
+	{
+		result.count += shard.count.load(std::memory_order_relaxed);
+		result.sum += shard.sum.load(std::memory_order_relaxed);
+		result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+		for (size_t i = 0; i < MetricsRegistry::bucketCount; i++)
+			result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+	}
+
+	// Registers the shard of the current thread, and merges it in the totals when the thread exits
+	class ShardOwner {
+	public:
+		Shard shard;
+
+		ShardOwner() :
+			// Constructed first, so destroyed after every shard
+			_registry(getRegistry())
+		{
+			std::unique_lock<std::mutex> lock{this->_registry.mutex};
+
+			this->_registry.shards.push_back(&this->shard);
+		}
+
+		~ShardOwner()
+		{
+			std::unique_lock<std::mutex> lock{this->_registry.mutex};
+			auto &shards = this->_registry.shards;
+
+			shards.erase(std::find(shards.begin(), shards.end(), &this->shard));
+			for (size_t i = 0; i < MetricsRegistry::maxCounters; i++)
+				this->_registry.retiredCounters[i] += this->shard.counters[i].load(std::memory_order_relaxed);
+			for (size_t i = 0; i < MetricsRegistry::maxHistograms; i++)
+				if (auto histogram = this->shard.histograms[i].load())
+					addHistogram(this->_registry.retiredHistograms[i], *histogram);
+		}
+
+	private:
+		Registry &_registry;
+	};
+
+	static Shard &getShard()
+	{
+		thread_local ShardOwner owner;
+
+		return owner.shard;
+	}
+
+	// Only the owning thread writes, so a load and a store are enough
+	static void increase(std::atomic<uint64_t> &value, uint64_t amount)
+	{
+		value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	static size_t registerName(std::vector<std::string> &names, const std::string &name, size_t max)
+	{
+		std::unique_lock<std::mutex> lock{getRegistry().mutex};
+		auto it = std::find(names.begin(), names.end(), name);
+
+		if (it != names.end())
+			return it - names.begin();
+		if (names.size() >= max)
+			throw std::length_error("Too many metrics to register " + name);
+		names.push_back(name);
+		return names.size() - 1;
+	}
+
+	void MetricsRegistry::Counter::add(uint64_t value) const
+	{
+		increase(getShard().counters[this->_index], value);
+	}
+
+	void MetricsRegistry::Gauge::set(double value) const
+	{
+		getRegistry().gauges[this->_index].store(value, std::memory_order_relaxed);
+	}
+
+	void MetricsRegistry::Histogram::record(uint64_t value) const
+	{
+		auto &slot = getShard().histograms[this->_index];
+		auto histogram = slot.load(std::memory_order_relaxed);
+
+		if (!histogram) {
+			histogram = new HistogramShard();
+			slot.store(histogram, std::memory_order_release);
+		}
+		increase(histogram->buckets[getBucketIndex(value)], 1);
+		increase(histogram->count, 1);
+		increase(histogram->sum, value);
+		if (value > histogram->max.load(std::memory_order_relaxed))
+			histogram->max.store(value, std::memory_order_relaxed);
+	}
+
+	void MetricsRegistry::Histogram::recordSince(Clock::time_point start) const
+	{
+		this->record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+	}
+
+	double MetricsRegistry::HistogramSnapshot::getMean() const
+	{
+		return this->count ? static_cast<double>(this->sum) / this->count : 0;
+	}
+
+	uint64_t MetricsRegistry::HistogramSnapshot::getPercentile(double percentile) const
+	{
+		uint64_t wanted = std::max<uint64_t>(1, this->count * percentile / 100);
+		uint64_t seen = 0;
+
+		for (size_t i = 0; i < this->buckets.size(); i++) {
+			seen += this->buckets[i];
+			if (seen >= wanted)
+				return std::min(getBucketHighestValue(i), this->max);
+		}
+		return this->max;
+	}
+
+	nlohmann::json MetricsRegistry::Snapshot::toJson() const
+	{
+		nlohmann::json histograms = nlohmann::json::object();
+
+		for (auto &histogram : this->histograms)
+			histograms[histogram.first] = {
+				{"count", histogram.second.count},
+				{"mean",  histogram.second.getMean()},
+				{"p50",   histogram.second.getPercentile(50)},
+				{"p90",   histogram.second.getPercentile(90)},
+				{"p99",   histogram.second.getPercentile(99)},
+				{"max",   histogram.second.max},
+			};
+		return {
+			{"counters",   this->counters},
+			{"gauges",     this->gauges},
+			{"histograms", histograms},
+		};
+	}
+
+	MetricsRegistry::Counter MetricsRegistry::counter(const std::string &name)
+	{
+		return registerName(getRegistry().counterNames, name, maxCounters);
+	}
+
+	MetricsRegistry::Gauge MetricsRegistry::gauge(const std::string &name)
+	{
+		return registerName(getRegistry().gaugeNames, name, maxGauges);
+	}
+
+	MetricsRegistry::Histogram MetricsRegistry::histogram(const std::string &name)
+	{
+		return registerName(getRegistry().histogramNames, name, maxHistograms);
+	}
+
+	MetricsRegistry::Snapshot MetricsRegistry::snapshot()
+	{
+		auto &registry = getRegistry();
+		std::unique_lock<std::mutex> lock{registry.mutex};
+		Snapshot result;
+
+		for (size_t i = 0; i < registry.counterNames.size(); i++) {
+			auto &value = result.counters[registry.counterNames[i]];
+
+			value = registry.retiredCounters[i];
+			for (auto shard : registry.shards)
+				value += shard->counters[i].load(std::memory_order_relaxed);
+		}
+		for (size_t i = 0; i < registry.gaugeNames.size(); i++)
+			result.gauges[registry.gaugeNames[i]] = registry.gauges[i].load(std::memory_order_relaxed);
+		for (size_t i = 0; i < registry.histogramNames.size(); i++) {
+			auto &value = result.histograms[registry.histogramNames[i]];
+
+			value = registry.retiredHistograms[i];
+			for (auto shard : registry.shards)
+				if (auto histogram = shard->histograms[i].load(std::memory_order_acquire))
+					addHistogram(value, *histogram);
+		}
+		return result;
+	}
+
+	void MetricsRegistry::save(const std::string &path)
+	{
+		auto value = snapshot().toJson();
+		std::ofstream stream{path};
+
+		if (stream.fail())
+			throw std::runtime_error("Cannot create " + path);
+		stream << value.dump(4) << std::endl;
+	}
+
+	size_t MetricsRegistry::getBucketIndex(uint64_t value)
+	{
+		unsigned exponent = subBucketBits;
+
+		value = std::min<uint64_t>(value, (1ULL << maxBits) - 1);
+		if (value < (1U << subBucketBits))
+			return value;
+		while (value >> (exponent + 1))
+			exponent++;
+		return ((exponent - subBucketBits + 1) << subBucketBits) + ((value >> (exponent - subBucketBits)) & ((1U << subBucketBits) - 1));
+	}
+
+	uint64_t MetricsRegistry::getBucketHighestValue(size_t index)
+	{
+		if (index < (1U << subBucketBits))
+			return index;
+
+		unsigned exponent = (index >> subBucketBits) + subBucketBits - 1;
+		uint64_t sub = index & ((1U << subBucketBits) - 1);
+		uint64_t lowest = ((1ULL << subBucketBits) + sub) << (exponent - subBucketBits);
+
+		return lowest + (1ULL << (exponent - subBucketBits)) - 1;
+	}
+}
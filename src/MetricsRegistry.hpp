@@ -0,0 +1,122 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_METRICSREGISTRY_HPP
+#define CHALLONGESOKU_METRICSREGISTRY_HPP
+
+
+#include <map>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <json.hpp>
+
+namespace ChallongeSoku
+{
+	//! @brief Process wide counters, gauges and latency histograms.
+	//! @details Metrics are registered by name once, then updated through their handle. Each thread
+	//! updates its own shard with plain relaxed stores, so recording never takes a lock or a locked
+	//! instruction. Shards are only summed when a snapshot is taken, and merged into the totals when
+	//! their thread exits. Gauges are set rather than summed, so they are shared by all threads.
+	//! Histograms store microseconds in log-linear buckets, like HDR histograms: values are exact
+	//! under 2^subBucketBits and within 1/2^subBucketBits above.
+	class MetricsRegistry {
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+		static constexpr size_t maxCounters = 64;
+		static constexpr size_t maxGauges = 64;
+		static constexpr size_t maxHistograms = 32;
+		static constexpr unsigned subBucketBits = 4;
+		//! @brief Values are clamped under 2^maxBits microseconds (about 12 days).
+		static constexpr unsigned maxBits = 40;
+		static constexpr size_t bucketCount = (maxBits - subBucketBits + 1) << subBucketBits;
+		//! @brief Seconds between two saves of the metrics file, when the clients were asked to keep one.
+		static constexpr float saveInterval = 10;
+
+		class Counter {
+		public:
+			void	add(uint64_t value = 1) const;
+
+		private:
+			size_t _index;
+
+			Counter(size_t index) : _index(index) {};
+			friend MetricsRegistry;
+		};
+
+		class Gauge {
+		public:
+			void	set(double value) const;
+
+		private:
+			size_t _index;
+
+			Gauge(size_t index) : _index(index) {};
+			friend MetricsRegistry;
+		};
+
+		class Histogram {
+		public:
+			//! @param value In microseconds.
+			void	record(uint64_t value) const;
+			void	recordSince(Clock::time_point start) const;
+
+		private:
+			size_t _index;
+
+			Histogram(size_t index) : _index(index) {};
+			friend MetricsRegistry;
+		};
+
+		//! @brief Records the time spent in a scope.
+		class Timer {
+		public:
+			Timer(const Histogram &histogram) : _histogram(histogram), _start(Clock::now()) {};
+			~Timer() { this->_histogram.recordSince(this->_start); };
+
+		private:
+			const Histogram &_histogram;
+			Clock::time_point _start;
+		};
+
+		struct HistogramSnapshot {
+			uint64_t count = 0;
+			uint64_t sum = 0;
+			uint64_t max = 0;
+			std::vector<uint64_t> buckets = std::vector<uint64_t>(bucketCount);
+
+			double	getMean() const;
+			//! @brief Highest value of the bucket holding the given percentile (0 to 100).
+			uint64_t getPercentile(double percentile) const;
+		};
+
+		struct Snapshot {
+			std::map<std::string, uint64_t> counters;
+			std::map<std::string, double> gauges;
+			std::map<std::string, HistogramSnapshot> histograms;
+
+			//! @brief Counters and gauges as-is, histograms as count, mean, p50, p90, p99 and max.
+			nlohmann::json toJson() const;
+		};
+
+		//! @throw std::length_error There are already as many metrics of this kind as allowed.
+		static Counter counter(const std::string &name);
+		//! @throw std::length_error There are already as many metrics of this kind as allowed.
+		static Gauge gauge(const std::string &name);
+		//! @throw std::length_error There are already as many metrics of this kind as allowed.
+		static Histogram histogram(const std::string &name);
+		static Snapshot snapshot();
+		//! @brief Write the JSON of a snapshot to a file.
+		//! @throw std::runtime_error The file cannot be created.
+		static void	save(const std::string &path);
+
+		static size_t	getBucketIndex(uint64_t value);
+		static uint64_t getBucketHighestValue(size_t index);
+	};
+}
+
+
+#endif //CHALLONGESOKU_METRICSREGISTRY_HPP
@@ -0,0 +1,247 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <iostream>
+#include <algorithm>
+#include "Notifications.hpp"
+#include "Utils.hpp"
+
+namespace ChallongeSoku
+{
+	// Indexed by Notifications::Level
+	static const char * const toastColors[] = {
+		"#C8F0C8",
+		"#FFE0B0",
+		"#FFC8C8",
+	};
+	static const char * const logColors[] = {
+		"green",
+		"#FF8800",
+		"red",
+	};
+
+	Notifications::Notifications(tgui::Gui &gui) :
+		_gui(gui)
+	{
+	}
+
+	void Notifications::push(Level level, const std::string &title, const std::string &message)
+	{
+		Entry entry{level, title, message, 1, time(nullptr), Clock::now()};
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		std::cerr << title << std::endl << message << std::endl;
+		for (auto &pending : this->_pending)
+			if (_key(pending) == _key(entry)) {
+				pending.count++;
+				pending.last = entry.last;
+				return;
+			}
+		// A flapping upstream must not grow the queue forever
+		if (this->_pending.size() >= pendingSize) {
+			this->_pending.pop_front();
+			this->_dropped++;
+		}
+		this->_pending.push_back(entry);
+	}
+
+	void Notifications::update()
+	{
+		std::deque<Entry> pending;
+		unsigned dropped;
+		auto now = Clock::now();
+
+		{
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			pending.swap(this->_pending);
+			dropped = this->_dropped;
+			this->_dropped = 0;
+		}
+		if (dropped)
+			this->_add({LEVEL_WARNING, "Notifications dropped", std::to_string(dropped) + " notifications came in too fast and were dropped", 1, time(nullptr), now});
+		for (auto &entry : pending)
+			this->_add(entry);
+
+		auto size = this->_toasts.size();
+
+		this->_toasts.erase(std::remove_if(this->_toasts.begin(), this->_toasts.end(), [this, now](const Toast &toast){
+			if (toast.expire > now)
+				return false;
+			this->_gui.remove(toast.panel);
+			if (toast.key.empty())
+				this->_suppressed = 0;
+			return true;
+		}), this->_toasts.end());
+		if (size != this->_toasts.size())
+			this->_layoutToasts();
+	}
+
+	void Notifications::openLog()
+	{
+		auto win = Utils::openWindowWithFocus(this->_gui, 500, 300);
+		auto log = tgui::ChatBox::create();
+
+		win->setTitle("Notifications");
+		log->setPosition(10, 10);
+		log->setSize("&.w - 20", "&.h - 20");
+		log->setTextSize(13);
+		win->add(log);
+		this->_log = log;
+		for (auto &entry : this->_history)
+			this->_appendLog(entry);
+	}
+
+	const std::deque<Notifications::Entry> &Notifications::getHistory() const
+	{
+		return this->_history;
+	}
+
+	void Notifications::_add(const Entry &entry)
+	{
+		auto key = _key(entry);
+		auto it = std::find_if(this->_history.rbegin(), this->_history.rend(), [&key, &entry](const Entry &old){
+			return _key(old) == key && entry.last - old.last < std::chrono::duration<float>(dedupWindow);
+		});
+
+		if (it != this->_history.rend()) {
+			auto toast = std::find_if(this->_toasts.begin(), this->_toasts.end(), [&key](const Toast &toast){
+				return toast.key == key;
+			});
+
+			it->count += entry.count;
+			it->last = entry.last;
+			if (toast != this->_toasts.end()) {
+				toast->text->setText(_toastText(*it));
+				toast->expire = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(toastDuration));
+			}
+			return;
+		}
+		if (this->_history.size() >= historySize)
+			this->_history.pop_front();
+		this->_history.push_back(entry);
+		if (this->_log.lock())
+			this->_appendLog(entry);
+		this->_showToast(entry);
+	}
+
+	void Notifications::_showToast(const Entry &entry)
+	{
+		auto now = Clock::now();
+
+		while (!this->_shown.empty() && now - this->_shown.front() >= std::chrono::duration<float>(rateLimitPeriod))
+			this->_shown.pop_front();
+		if (this->_shown.size() >= rateLimitCount) {
+			this->_suppressed++;
+			return this->_showSummary();
+		}
+		this->_shown.push_back(now);
+
+		Toast toast{_key(entry), nullptr, nullptr, now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(toastDuration))};
+
+		toast.panel = this->_makeToast(entry.level, toast.text, toast.key);
+		toast.text->setText(_toastText(entry));
+		// The oldest toast makes room for the new one
+		if (this->_toasts.size() >= maxToasts) {
+			auto oldest = std::find_if(this->_toasts.begin(), this->_toasts.end(), [](const Toast &toast){
+				return !toast.key.empty();
+			});
+
+			if (oldest == this->_toasts.end())
+				oldest = this->_toasts.begin();
+			this->_gui.remove(oldest->panel);
+			this->_toasts.erase(oldest);
+		}
+		this->_toasts.push_back(toast);
+		this->_layoutToasts();
+	}
+
+	void Notifications::_showSummary()
+	{
+		auto it = std::find_if(this->_toasts.begin(), this->_toasts.end(), [](const Toast &toast){
+			return toast.key.empty();
+		});
+		auto text = std::to_string(this->_suppressed) + " more notification" + (this->_suppressed >= 2 ? "s" : "") + "\nSee Notifications > Show log";
+		auto expire = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(toastDuration));
+
+		if (it != this->_toasts.end()) {
+			it->text->setText(text);
+			it->expire = expire;
+			return;
+		}
+
+		Toast toast{"", nullptr, nullptr, expire};
+
+		toast.panel = this->_makeToast(LEVEL_WARNING, toast.text, toast.key);
+		toast.text->setText(text);
+		this->_toasts.push_back(toast);
+		this->_layoutToasts();
+	}
+
+	tgui::Panel::Ptr Notifications::_makeToast(Level level, tgui::Label::Ptr &text, const std::string &key)
+	{
+		auto panel = tgui::Panel::create({300, 70});
+
+		text = tgui::Label::create();
+		panel->getRenderer()->setBackgroundColor(toastColors[level]);
+		panel->getRenderer()->setBorderColor("black");
+		panel->getRenderer()->setBorders(1);
+		text->setPosition(5, 5);
+		text->setSize("&.w - 10", "&.h - 10");
+		text->setTextSize(12);
+		panel->add(text);
+		// Clicking a toast closes it, it stays in the log
+		panel->connect("Clicked", [this, key]{
+			this->_closeToast(key);
+		});
+		this->_gui.add(panel);
+		return panel;
+	}
+
+	void Notifications::_closeToast(const std::string &key)
+	{
+		auto it = std::find_if(this->_toasts.begin(), this->_toasts.end(), [&key](const Toast &toast){
+			return toast.key == key;
+		});
+
+		if (it == this->_toasts.end())
+			return;
+		// Widgets cannot be removed while they handle their own event
+		it->expire = Clock::now();
+	}
+
+	void Notifications::_layoutToasts()
+	{
+		for (size_t i = 0; i < this->_toasts.size(); i++) {
+			auto &panel = this->_toasts[this->_toasts.size() - i - 1].panel;
+
+			panel->setPosition("&.w - w - 10", "&.h - " + std::to_string((i + 1) * 80));
+			panel->moveToFront();
+		}
+	}
+
+	void Notifications::_appendLog(const Entry &entry)
+	{
+		auto log = this->_log.lock();
+		char buffer[sizeof("00:00:00")];
+
+		if (!log)
+			return;
+		strftime(buffer, sizeof(buffer), "%H:%M:%S", localtime(&entry.time));
+		log->addLine(
+			std::string("[") + buffer + "] " + entry.title + ": " + entry.message + (entry.count >= 2 ? " (x" + std::to_string(entry.count) + ")" : ""),
+			tgui::Color(logColors[entry.level])
+		);
+	}
+
+	std::string Notifications::_key(const Entry &entry)
+	{
+		return entry.title + '\n' + entry.message;
+	}
+
+	std::string Notifications::_toastText(const Entry &entry)
+	{
+		return entry.title + (entry.count >= 2 ? " (x" + std::to_string(entry.count) + ")" : "") + "\n" + entry.message;
+	}
+}
@@ -0,0 +1,96 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_NOTIFICATIONS_HPP
+#define CHALLONGESOKU_NOTIFICATIONS_HPP
+
+
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <TGUI/TGUI.hpp>
+
+namespace ChallongeSoku
+{
+	//! @brief Shows errors and warnings inside the main window.
+	//! @details Any thread may push a notification. They wait in a bounded queue until the GUI thread calls update,
+	//! which turns them into toasts in the bottom right corner and keeps them in a bounded history, shown by openLog.
+	//! A notification identical to one seen less than dedupWindow seconds ago only bumps its counter. At most
+	//! rateLimitCount toasts are opened every rateLimitPeriod seconds, the others are summed up in a single toast.
+	class Notifications {
+	public:
+		enum Level {
+			LEVEL_INFO,
+			LEVEL_WARNING,
+			LEVEL_ERROR,
+		};
+
+		struct Entry {
+			Level level;
+			std::string title;
+			std::string message;
+			unsigned count;
+			time_t time;
+			std::chrono::steady_clock::time_point last;
+		};
+
+		static constexpr size_t pendingSize = 32;
+		static constexpr size_t historySize = 200;
+		static constexpr size_t maxToasts = 4;
+		static constexpr float toastDuration = 8;
+		static constexpr float dedupWindow = 60;
+		static constexpr unsigned rateLimitCount = 3;
+		static constexpr float rateLimitPeriod = 10;
+
+		Notifications(tgui::Gui &gui);
+
+		//! @brief Queue a notification. May be called from any thread.
+		void	push(Level level, const std::string &title, const std::string &message);
+		//! @brief Show what was pushed since last time and close old toasts. Must be called from the GUI thread.
+		void	update();
+		//! @brief Open a window with every notification still in the history. Must be called from the GUI thread.
+		void	openLog();
+		const std::deque<Entry> &getHistory() const;
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		struct Toast {
+			//! @brief Title and message of the entry shown, empty for the summary toast.
+			std::string key;
+			tgui::Panel::Ptr panel;
+			tgui::Label::Ptr text;
+			Clock::time_point expire;
+		};
+
+		tgui::Gui &_gui;
+		std::mutex _mutex;
+		std::deque<Entry> _pending;
+		unsigned _dropped = 0;
+
+		// Only used by the GUI thread
+		std::deque<Entry> _history;
+		std::vector<Toast> _toasts;
+		std::deque<Clock::time_point> _shown;
+		unsigned _suppressed = 0;
+		std::weak_ptr<tgui::ChatBox> _log;
+
+		void	_add(const Entry &entry);
+		void	_showToast(const Entry &entry);
+		void	_showSummary();
+		tgui::Panel::Ptr _makeToast(Level level, tgui::Label::Ptr &text, const std::string &key);
+		void	_closeToast(const std::string &key);
+		void	_layoutToasts();
+		void	_appendLog(const Entry &entry);
+
+		static std::string _key(const Entry &entry);
+		static std::string _toastText(const Entry &entry);
+	};
+}
+
+
+#endif //CHALLONGESOKU_NOTIFICATIONS_HPP
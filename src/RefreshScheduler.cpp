@@ -0,0 +1,101 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <cmath>
+#include <algorithm>
+#include "RefreshScheduler.hpp"
+
+namespace ChallongeSoku
+{
+	const char * const RefreshScheduler::activityStrings[] = {
+		"idle",
+		"pending",
+		"open",
+		"hosting",
+		"complete",
+	};
+
+	// How much the base refresh rate is stretched for each activity
+	static const float activityMultipliers[] = {
+		3,   // ACTIVITY_IDLE
+		6,   // ACTIVITY_PENDING
+		1,   // ACTIVITY_OPEN
+		0.5, // ACTIVITY_HOSTING
+		12,  // ACTIVITY_COMPLETE
+	};
+
+	void RefreshScheduler::reportSuccess(Activity activity, float baseRate)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		float interval = std::max(baseRate, 1.f) * activityMultipliers[activity];
+
+		this->_activity = activity;
+		this->_metrics.consecutiveErrors = 0;
+		this->_schedule(std::min(std::max(interval, minInterval), maxInterval), baseRate);
+	}
+
+	void RefreshScheduler::reportError(float baseRate, std::optional<float> retryAfter)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		float interval;
+
+		this->_metrics.consecutiveErrors++;
+		interval = std::max(baseRate, 1.f) * std::pow(2.f, std::min(this->_metrics.consecutiveErrors, 16U));
+		interval = std::min(std::max(interval, minInterval), maxInterval);
+		if (retryAfter)
+			interval = std::max(interval, *retryAfter);
+		this->_schedule(interval, baseRate);
+	}
+
+	void RefreshScheduler::_schedule(float interval, float baseRate)
+	{
+		this->_interval = interval;
+		this->_totalInterval += interval;
+		this->_metrics.requestsMade++;
+		// A fixed countdown would have polled interval / baseRate times during the same period.
+		// Shorter intervals are not counted against it, or the total would go down while hosting.
+		this->_savedRemainder += std::max(0.f, interval / std::max(baseRate, 1.f) - 1);
+		this->_metrics.requestsSaved = std::floor(this->_savedRemainder);
+		this->_metrics.effectiveInterval = interval;
+		this->_metrics.averageInterval = this->_totalInterval / this->_metrics.requestsMade;
+	}
+
+	float RefreshScheduler::getInterval() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_interval;
+	}
+
+	RefreshScheduler::Activity RefreshScheduler::getActivity() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_activity;
+	}
+
+	RefreshScheduler::Metrics RefreshScheduler::getMetrics() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_metrics;
+	}
+
+	std::optional<float> RefreshScheduler::getRetryAfter(const ChallongeAPI::Socket::HttpResponse &response)
+	{
+		for (auto &field : response.header) {
+			std::string name = field.first;
+
+			std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+			if (name != "retry-after")
+				continue;
+			try {
+				return std::stof(field.second);
+			} catch (std::exception &) {
+				return {};
+			}
+		}
+		return {};
+	}
+}
@@ -0,0 +1,69 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_REFRESHSCHEDULER_HPP
+#define CHALLONGESOKU_REFRESHSCHEDULER_HPP
+
+
+#include <mutex>
+#include <string>
+#include <optional>
+#include <Socket.hpp>
+
+namespace ChallongeSoku
+{
+	//! @brief Decides when refreshView should poll Challonge and Konni again.
+	//! @details The user's refresh rate is used as-is while games are being played
+	//! and stretched when nothing can happen (tournament pending, complete or not loaded).
+	//! Upstream errors apply an exponential backoff and Retry-After is always honored.
+	class RefreshScheduler {
+	public:
+		enum Activity {
+			ACTIVITY_IDLE,
+			ACTIVITY_PENDING,
+			ACTIVITY_OPEN,
+			ACTIVITY_HOSTING,
+			ACTIVITY_COMPLETE,
+		};
+
+		struct Metrics {
+			float effectiveInterval = 0;
+			float averageInterval = 0;
+			unsigned long requestsMade = 0;
+			//! @brief Polls a fixed countdown would have made on top of ours. Hosting polls faster, which saves nothing.
+			unsigned long requestsSaved = 0;
+			unsigned consecutiveErrors = 0;
+		};
+
+		static const char * const activityStrings[];
+
+		//! @brief Max delay between two refreshes, whatever the activity or backoff.
+		static constexpr float maxInterval = 300;
+		//! @brief Min delay between two refreshes, even while hosting.
+		static constexpr float minInterval = 2;
+
+		void	reportSuccess(Activity activity, float baseRate);
+		void	reportError(float baseRate, std::optional<float> retryAfter = {});
+		float	getInterval() const;
+		Activity getActivity() const;
+		Metrics	getMetrics() const;
+
+		//! @brief Extract the delay asked by a Retry-After header.
+		//! @details Only the delta-seconds form is supported, HTTP dates are ignored.
+		static std::optional<float> getRetryAfter(const ChallongeAPI::Socket::HttpResponse &response);
+
+	private:
+		mutable std::mutex _mutex;
+		Activity _activity = ACTIVITY_IDLE;
+		float _interval = 0;
+		float _savedRemainder = 0;
+		float _totalInterval = 0;
+		Metrics _metrics;
+
+		void	_schedule(float interval, float baseRate);
+	};
+}
+
+
+#endif //CHALLONGESOKU_REFRESHSCHEDULER_HPP
@@ -0,0 +1,359 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closeSocket closesocket
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#define closeSocket close
+#endif
+#include <map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "Resolver.hpp"
+#include "MetricsRegistry.hpp"
+#include "Tracer.hpp"
+
+namespace ChallongeSoku
+{
+	struct CacheEntry {
+		std::shared_future<Resolver::Lookup> current;
+		// Runs while the expired answer in current is still used
+		std::shared_future<Resolver::Lookup> refresh;
+	};
+
+	struct PendingLookup;
+
+	struct LookupRequest {
+		std::shared_ptr<PendingLookup> pending;
+		Resolver::LookupFunction function;
+		unsigned short port;
+	};
+
+	struct Cache {
+		std::mutex mutex;
+		std::map<std::pair<std::string, unsigned short>, CacheEntry> entries;
+		Resolver::LookupFunction lookupFunction;
+		std::condition_variable condition;
+		std::deque<LookupRequest> requests;
+		std::vector<std::thread> threads;
+		bool stopping = false;
+	};
+
+	static Cache &getCache()
+	{
+		static Cache cache;
+
+		return cache;
+	}
+
+	static bool isReady(const std::shared_future<Resolver::Lookup> &future)
+	{
+		return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	static Resolver::Lookup lookup(const std::string &host, unsigned short port)
+	{
+		Resolver::Lookup result;
+		addrinfo hints{};
+		addrinfo *info = nullptr;
+		int error;
+
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		error = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &info);
+		if (error != 0 || !info)
+			result.error = "Cannot resolve " + host + (error ? std::string(": ") + gai_strerror(error) : "");
+		for (auto it = info; it; it = it->ai_next) {
+			auto data = reinterpret_cast<const unsigned char *>(it->ai_addr);
+
+			result.addresses.push_back({it->ai_family, it->ai_socktype, it->ai_protocol, {data, data + it->ai_addrlen}});
+		}
+		if (info)
+			freeaddrinfo(info);
+		result.resolved = Resolver::Clock::now();
+		return result;
+	}
+
+	// Answers the lookup with an error if it is dropped before running, when the Resolver stops
+	struct PendingLookup {
+		std::string host;
+		std::promise<Resolver::Lookup> promise;
+		bool answered = false;
+
+		~PendingLookup()
+		{
+			Resolver::Lookup result;
+
+			if (this->answered)
+				return;
+			result.error = "Cannot resolve " + this->host + ": stopped";
+			result.resolved = Resolver::Clock::now();
+			this->promise.set_value(result);
+		}
+	};
+
+	static void lookupLoop(Cache &cache, unsigned index)
+	{
+		static const auto lookupTime = MetricsRegistry::histogram("dns.lookup_us");
+		std::unique_lock<std::mutex> lock{cache.mutex};
+
+		Tracer::setThreadName("Resolver " + std::to_string(index + 1));
+		while (true) {
+			cache.condition.wait(lock, [&cache]{
+				return cache.stopping || !cache.requests.empty();
+			});
+			if (cache.stopping)
+				return;
+
+			auto request = std::move(cache.requests.front());
+
+			cache.requests.pop_front();
+			lock.unlock();
+			{
+				MetricsRegistry::Timer timer{lookupTime};
+				TRACE_SCOPE("Resolver::lookup");
+
+				request.pending->promise.set_value(request.function(request.pending->host, request.port));
+				request.pending->answered = true;
+			}
+			request.pending.reset();
+			lock.lock();
+		}
+	}
+
+	// Cache mutex must be held
+	static std::shared_future<Resolver::Lookup> startLookup(Cache &cache, const std::string &host, unsigned short port)
+	{
+		auto pending = std::make_shared<PendingLookup>();
+		auto future = pending->promise.get_future().share();
+
+		pending->host = host;
+		// Dropping it answers that the Resolver stopped
+		if (cache.stopping)
+			return future;
+		if (cache.threads.empty())
+			for (unsigned i = 0; i < Resolver::lookupThreads; i++)
+				cache.threads.emplace_back(lookupLoop, std::ref(cache), i);
+		cache.requests.push_back({pending, cache.lookupFunction ? cache.lookupFunction : lookup, port});
+		cache.condition.notify_one();
+		return future;
+	}
+
+	std::shared_future<Resolver::Lookup> Resolver::resolveAsync(const std::string &host, unsigned short port)
+	{
+		static const auto cacheHits = MetricsRegistry::counter("dns.cache_hits");
+		static const auto staleHits = MetricsRegistry::counter("dns.stale_hits");
+		static const auto negativeHits = MetricsRegistry::counter("dns.negative_hits");
+		auto &cache = getCache();
+		std::unique_lock<std::mutex> lock{cache.mutex};
+		auto &entry = cache.entries[{host, port}];
+
+		if (entry.refresh.valid() && isReady(entry.refresh)) {
+			entry.current = entry.refresh;
+			entry.refresh = {};
+		}
+		if (!entry.current.valid())
+			return entry.current = startLookup(cache, host, port);
+		// Someone else is already waiting for this one
+		if (!isReady(entry.current))
+			return entry.current;
+
+		auto &result = entry.current.get();
+		auto age = Clock::now() - result.resolved;
+
+		if (!result.error.empty()) {
+			if (age < std::chrono::duration<float>(negativeTtl)) {
+				negativeHits.add();
+				return entry.current;
+			}
+			return entry.current = startLookup(cache, host, port);
+		}
+		if (age < std::chrono::duration<float>(ttl)) {
+			cacheHits.add();
+			return entry.current;
+		}
+		staleHits.add();
+		if (!entry.refresh.valid())
+			entry.refresh = startLookup(cache, host, port);
+		return entry.current;
+	}
+
+	void Resolver::prefetch(const std::string &host, unsigned short port)
+	{
+		resolveAsync(host, port);
+	}
+
+	std::vector<Resolver::Address> Resolver::resolve(const std::string &host, unsigned short port, Clock::time_point deadline)
+	{
+		TRACE_SCOPE("Resolver::resolve");
+		auto future = resolveAsync(host, port);
+
+		if (future.wait_until(deadline) != std::future_status::ready)
+			throw std::runtime_error("Timed out resolving " + host);
+
+		auto &result = future.get();
+
+		if (!result.error.empty())
+			throw std::runtime_error(result.error);
+		return result.addresses;
+	}
+
+	void Resolver::setLookupFunction(const LookupFunction &function)
+	{
+		auto &cache = getCache();
+		std::unique_lock<std::mutex> lock{cache.mutex};
+
+		cache.lookupFunction = function;
+	}
+
+	void Resolver::stop()
+	{
+		auto &cache = getCache();
+		std::unique_lock<std::mutex> lock{cache.mutex};
+		auto requests = std::move(cache.requests);
+		auto threads = std::move(cache.threads);
+
+		cache.stopping = true;
+		cache.requests.clear();
+		cache.threads.clear();
+		lock.unlock();
+		cache.condition.notify_all();
+		for (auto &thread : threads)
+			thread.join();
+		// The lookups which didn't start are answered as stopped when destroyed
+	}
+
+	// Families alternate, starting with the one getaddrinfo preferred
+	static std::vector<Resolver::Address> interleaveFamilies(const std::vector<Resolver::Address> &addresses)
+	{
+		std::vector<Resolver::Address> preferred;
+		std::vector<Resolver::Address> others;
+		std::vector<Resolver::Address> result;
+
+		for (auto &address : addresses)
+			(address.family == addresses.front().family ? preferred : others).push_back(address);
+		for (size_t i = 0; i < preferred.size() || i < others.size(); i++) {
+			if (i < preferred.size())
+				result.push_back(preferred[i]);
+			if (i < others.size())
+				result.push_back(others[i]);
+		}
+		return result;
+	}
+
+	static intptr_t startConnecting(const Resolver::Address &address)
+	{
+		intptr_t sock = ::socket(address.family, address.socktype, address.protocol);
+
+		if (sock < 0)
+			return sock;
+#ifdef _WIN32
+		u_long enable = 1;
+
+		ioctlsocket(sock, FIONBIO, &enable);
+#else
+		fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+		::connect(sock, reinterpret_cast<const sockaddr *>(address.sockaddr.data()), address.sockaddr.size());
+		return sock;
+	}
+
+	intptr_t Resolver::connect(const std::string &host, unsigned short port, Clock::time_point deadline)
+	{
+		TRACE_SCOPE("Resolver::connect");
+		auto addresses = interleaveFamilies(resolve(host, port, deadline));
+		auto attemptDelay = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(connectionAttemptDelay));
+		std::vector<intptr_t> attempts;
+		intptr_t connected = -1;
+		size_t next = 0;
+		bool startNext = true;
+		std::string lastError = "no address";
+		auto closeAll = [&attempts]{
+			for (auto sock : attempts)
+				closeSocket(sock);
+			attempts.clear();
+		};
+
+		// Another address is tried each time one fails or takes too long, and the first one to connect wins
+		while (connected < 0) {
+			if (startNext && next < addresses.size()) {
+				auto sock = startConnecting(addresses[next++]);
+
+				if (sock >= 0)
+					attempts.push_back(sock);
+				else
+					lastError = "Cannot create socket";
+			}
+			startNext = false;
+			if (attempts.empty()) {
+				if (next < addresses.size()) {
+					startNext = true;
+					continue;
+				}
+				throw std::runtime_error("Cannot connect to " + host + ":" + std::to_string(port) + ": " + lastError);
+			}
+
+			auto now = Clock::now();
+			auto until = next < addresses.size() ? std::min(deadline, now + attemptDelay) : deadline;
+			auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(until - now).count();
+			intptr_t highest = 0;
+			fd_set writeSet;
+			fd_set errorSet;
+			timeval timeout;
+
+			if (now >= deadline) {
+				closeAll();
+				throw std::runtime_error("Timed out connecting to " + host + ":" + std::to_string(port));
+			}
+			timeout.tv_sec = remaining / 1000000;
+			timeout.tv_usec = remaining % 1000000;
+			FD_ZERO(&writeSet);
+			FD_ZERO(&errorSet);
+			for (auto sock : attempts) {
+				FD_SET(sock, &writeSet);
+				FD_SET(sock, &errorSet);
+				highest = std::max(highest, sock);
+			}
+			if (select(static_cast<int>(highest + 1), nullptr, &writeSet, &errorSet, &timeout) <= 0) {
+				startNext = true;
+				continue;
+			}
+			for (auto it = attempts.begin(); it != attempts.end(); ) {
+				int error = 0;
+				socklen_t size = sizeof(error);
+
+				if (!FD_ISSET(*it, &writeSet) && !FD_ISSET(*it, &errorSet)) {
+					it++;
+					continue;
+				}
+				getsockopt(*it, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&error), &size);
+				if (!error && connected < 0) {
+					connected = *it;
+					it = attempts.erase(it);
+					continue;
+				}
+				if (error) {
+					lastError = strerror(error);
+					startNext = true;
+				}
+				closeSocket(*it);
+				it = attempts.erase(it);
+			}
+		}
+		closeAll();
+		return connected;
+	}
+}
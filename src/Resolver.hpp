@@ -0,0 +1,83 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_RESOLVER_HPP
+#define CHALLONGESOKU_RESOLVER_HPP
+
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace ChallongeSoku
+{
+	//! @brief Process wide DNS cache, resolving hosts on its own threads.
+	//! @details Every lookup of a host runs getaddrinfo once, whoever asked for it, and its answer is kept for ttl
+	//! seconds. Once expired, it is still used while a new lookup runs in the background, so a slow resolver only
+	//! delays the very first connection to a host. Failures are kept for negativeTtl seconds, so a host which
+	//! cannot be resolved fails right away instead of stalling every retry. getaddrinfo doesn't tell the TTL of
+	//! the records, so both durations are fixed.
+	//! Lookups don't run on the TaskPool: connections are opened from tasks, which would wait for a lookup stuck
+	//! behind them in the pool. ChallongeLib's sockets resolve hosts by themselves, only the connections opened
+	//! here use this cache.
+	class Resolver {
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+		struct Address {
+			int family;
+			int socktype;
+			int protocol;
+			//! @brief The sockaddr to give to connect.
+			std::vector<unsigned char> sockaddr;
+		};
+
+		struct Lookup {
+			//! @brief Ordered as getaddrinfo returned them.
+			std::vector<Address> addresses;
+			//! @brief Set if the host couldn't be resolved.
+			std::string error;
+			Clock::time_point resolved;
+		};
+
+		//! @brief Gives the addresses of a host, and when they were resolved.
+		typedef std::function<Lookup (const std::string &host, unsigned short port)> LookupFunction;
+
+		//! @brief Seconds an answer is used before being refreshed.
+		static constexpr float ttl = 60;
+		//! @brief Seconds a failure is kept before trying again.
+		static constexpr float negativeTtl = 10;
+		//! @brief Seconds to wait for an address to connect before trying the next one as well.
+		static constexpr float connectionAttemptDelay = 0.25;
+		//! @brief Threads running the lookups, started by the first one.
+		static constexpr unsigned lookupThreads = 2;
+
+		//! @brief Start resolving a host, or give the lookup already running or cached.
+		static std::shared_future<Lookup> resolveAsync(const std::string &host, unsigned short port);
+		//! @brief Resolve a host in the background, so connecting to it later doesn't wait.
+		static void	prefetch(const std::string &host, unsigned short port);
+		//! @brief Wait for the addresses of a host.
+		//! @throw std::runtime_error The host couldn't be resolved before the deadline.
+		static std::vector<Address> resolve(const std::string &host, unsigned short port, Clock::time_point deadline);
+		//! @brief Resolve a host and connect to it, Happy Eyeballs style.
+		//! @details Addresses are tried alternating IPv6 and IPv4, starting with the family getaddrinfo preferred.
+		//! The next one is tried as well each time one fails or takes longer than connectionAttemptDelay, and the
+		//! first one to connect is kept.
+		//! @return A connected socket, in non-blocking mode.
+		//! @throw std::runtime_error The host couldn't be resolved or connected to before the deadline.
+		static intptr_t	connect(const std::string &host, unsigned short port, Clock::time_point deadline);
+		//! @brief Replace getaddrinfo, so tests can answer lookups themselves. An empty function restores it.
+		//! @details Answers already cached are kept.
+		static void	setLookupFunction(const LookupFunction &function);
+		//! @brief Wait for the running lookups and join the threads. The others, and the ones started afterwards,
+		//! fail right away. Like TaskPool::stop, it must be called before returning from main.
+		static void	stop();
+	};
+}
+
+
+#endif //CHALLONGESOKU_RESOLVER_HPP
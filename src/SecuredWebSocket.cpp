@@ -2,11 +2,15 @@
 // Created by Gegel85 on 06/04/2019.
 //
 
+#include <cctype>
 #include <cstring>
-#include <sstream>
+#include <algorithm>
 #include <iostream>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
 #include <Exceptions.hpp>
 #include "SecuredWebSocket.hpp"
+#include "Tracer.hpp"
 
 using namespace ChallongeAPI;
 
@@ -31,11 +35,31 @@ namespace ChallongeSoku
 		"TLS handshake",
 	};
 
+	static const char handshakeEnd[] = "\r\n\r\n";
+
+	static std::string encodeBase64(const unsigned char *data, size_t size)
+	{
+		std::string result(4 * ((size + 2) / 3), '\0');
+
+		EVP_EncodeBlock(reinterpret_cast<unsigned char *>(&result[0]), data, size);
+		return result;
+	}
+
 	void SecuredWebSocket::_establishHandshake(const std::string &host)
 	{
 		Socket::HttpRequest	request;
 		Socket::HttpResponse	response;
+		unsigned char	nonce[16];
+		std::string	key;
+		std::string	accept;
+		static const char acceptHeader[] = "Sec-WebSocket-Accept";
 
+		for (size_t i = 0; i < sizeof(nonce); i += 4) {
+			auto value = this->_rand();
+
+			std::memcpy(&nonce[i], &value, 4);
+		}
+		key = encodeBase64(nonce, sizeof(nonce));
 		request.host = host;
 		request.path = this->_path;
 		request.method = "GET";
@@ -44,129 +68,182 @@ namespace ChallongeSoku
 			{"Connection",            "Upgrade"},
 			{"Upgrade",               "websocket"},
 			{"Sec-WebSocket-Version", "13"},
-			{"Sec-WebSocket-Key",     "77CXUYUvC2pMbKIIQZqgiQ=="},
+			{"Sec-WebSocket-Key",     key},
 			{"Sec-WebSocket-Protocol","chat, superchat"},
 		};
 		this->sendHttpRequest(request);
-		response = Socket::parseHttpResponse(this->getRawAnswer());
+		response = Socket::parseHttpResponse(this->_readHandshakeResponse());
 		if (response.returnCode != 101) {
 			this->disconnect();
 			throw InvalidHandshakeException("WebSocket Handshake failed: Server answered with code " + std::to_string(response.returnCode) + " but 101 was expected");
 		}
+		// Header names are case insensitive
+		for (auto &field : response.header)
+			if (std::equal(field.first.begin(), field.first.end(), acceptHeader, acceptHeader + strlen(acceptHeader), [](char a, char b){
+				return std::tolower(a) == std::tolower(b);
+			}))
+				accept = field.second;
+		if (accept != getAcceptKey(key)) {
+			this->disconnect();
+			throw InvalidHandshakeException("WebSocket Handshake failed: Server answered with an invalid Sec-WebSocket-Accept");
+		}
+	}
+
+	std::string SecuredWebSocket::_readHandshakeResponse()
+	{
+		std::string response;
+
+		// The server may send frames right after the blank line, they must be left for getAnswer.
+		// Reading at most the bytes missing to complete the blank line never reads past it.
+		while (response.size() < 4 || response.compare(response.size() - 4, 4, handshakeEnd) != 0) {
+			size_t matched = 3;
+
+			while (matched && (response.size() < matched || response.compare(response.size() - matched, matched, handshakeEnd, matched) != 0))
+				matched--;
+			if (response.size() + 4 - matched > maxHandshakeSize) {
+				TlsConnection::disconnect();
+				throw InvalidHandshakeException("WebSocket Handshake failed: Server answer is longer than " + std::to_string(maxHandshakeSize) + " bytes");
+			}
+			response += this->read(4 - matched);
+		}
+		return response;
+	}
+
+	std::string SecuredWebSocket::getAcceptKey(const std::string &key)
+	{
+		static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+		unsigned char digest[SHA_DIGEST_LENGTH];
+		auto value = key + guid;
 
+		SHA1(reinterpret_cast<const unsigned char *>(value.data()), value.size(), digest);
+		return encodeBase64(digest, sizeof(digest));
 	}
 
-	void SecuredWebSocket::send(const std::string &value)
+	std::string SecuredWebSocket::encodeFrame(unsigned char opcode, const std::string &payload, uint32_t maskKey)
 	{
-		std::stringstream stream;
-		std::string	result = value;
-		unsigned	random_value = this->_rand();
-		std::string	key = std::string("") +
-			static_cast<char>((random_value >> 24U) & 0xFFU) +
-			static_cast<char>((random_value >> 16U) & 0xFFU) +
-			static_cast<char>((random_value >> 8U) & 0xFFU) +
-			static_cast<char>(random_value & 0xFFU);
-
-		for (unsigned i = 0; i < result.size(); i++)
-			result[i] = result[i] ^ key[i % 4];
-		stream << static_cast<char>(0x81);
-		stream << static_cast<char>(0x80 + (value.size() <= 125 ? value.size() : (126 + (value.size() > 65535))));
-		if (value.size() > 65535) {
-			stream << static_cast<char>(value.size() >> 24U);
-			stream << static_cast<char>(value.size() >> 16U);
-			stream << static_cast<char>(value.size() >> 8U);
-			stream << static_cast<char>(value.size());
-		} else if (value.size() > 125) {
-			stream << static_cast<char>(value.size() >> 8U);
-			stream << static_cast<char>(value.size());
+		std::string frame;
+		size_t header;
+		char key[4] = {
+			static_cast<char>((maskKey >> 24U) & 0xFFU),
+			static_cast<char>((maskKey >> 16U) & 0xFFU),
+			static_cast<char>((maskKey >> 8U) & 0xFFU),
+			static_cast<char>(maskKey & 0xFFU),
+		};
+
+		frame.reserve(payload.size() + 14);
+		frame += static_cast<char>(0x80U | opcode);
+		if (payload.size() <= 125)
+			frame += static_cast<char>(0x80U + payload.size());
+		else if (payload.size() <= 65535) {
+			frame += static_cast<char>(0x80U + 126);
+			frame += static_cast<char>(payload.size() >> 8U);
+			frame += static_cast<char>(payload.size());
+		} else {
+			// 64 bits length, most significant byte first
+			frame += static_cast<char>(0x80U + 127);
+			for (int shift = 56; shift >= 0; shift -= 8)
+				frame += static_cast<char>(static_cast<uint64_t>(payload.size()) >> shift);
 		}
-		stream << key << result;
-		SecuredSocket::send(stream.str());
+		frame.append(key, sizeof(key));
+		header = frame.size();
+		frame += payload;
+		applyMask(&frame[header], frame.size() - header, key);
+		return frame;
 	}
 
-	void SecuredWebSocket::_pong(const std::string &validator)
+	void SecuredWebSocket::applyMask(char *data, size_t size, const char key[4])
+	{
+		for (size_t i = 0; i < size; i++)
+			data[i] ^= key[i & 3U];
+	}
+
+	void SecuredWebSocket::send(const std::string &value)
 	{
-		std::stringstream stream;
-		unsigned char byte = 0x8A;
+		TlsConnection::send(encodeFrame(0x1, value, this->_rand()));
+	}
 
+	void SecuredWebSocket::_pong(const std::string &validator)
+	{
 		if (validator.size() > 125)
 			throw InvalidPongException("Pong validator cannot be longer than 125B");
-		stream << byte;
-		byte = 0x80 + validator.size();
-		stream << byte;
-		SecuredSocket::send(stream.str());
+		TlsConnection::send(encodeFrame(0xA, validator, this->_rand()));
 	}
 
-	std::string SecuredWebSocket::getAnswer()
+	SecuredWebSocket::Frame SecuredWebSocket::decodeFrame(const std::function<std::string (size_t size)> &read)
 	{
-		std::string	result;
-		std::string	key;
-		unsigned long	length;
-		unsigned char	opcode;
-		bool	isMasked;
-		bool	isEnd;
+		Frame frame;
+		std::string key;
+		unsigned long length;
+		bool isMasked;
 
-		if (!this->isOpen())
-			throw NotConnectedException("This socket is not connected to a server");
-
-		opcode = this->read(1)[0];
-		isEnd = (opcode >> 7U);
-		opcode &= 0xFU;
+		frame.opcode = read(1)[0];
+		// Waiting for the frame to start is idle time, only reading it is traced
+		TRACE_SCOPE("decodeFrame");
+		frame.isEnd = (frame.opcode >> 7U);
+		frame.opcode &= 0xFU;
 
-		length = this->read(1)[0];
+		length = read(1)[0];
 		isMasked = (length >> 7U);
 		length &= 0x7FU;
 
-		if (length == 126)
-			length = (static_cast<unsigned char>(this->read(1)[0]) << 8U) +
-				static_cast<unsigned char>(this->read(1)[0]);
-		else if (length == 127)
-			length = (static_cast<unsigned char>(this->read(1)[0]) << 24U) +
-				(static_cast<unsigned char>(this->read(1)[0]) << 16U) +
-				(static_cast<unsigned char>(this->read(1)[0]) << 8U) +
-				static_cast<unsigned char>(this->read(1)[0]);
+		if (length == 126) {
+			auto bytes = read(2);
 
-		if (isMasked)
-			key = this->read(4);
+			length = (static_cast<unsigned char>(bytes[0]) << 8U) + static_cast<unsigned char>(bytes[1]);
+		} else if (length == 127) {
+			auto bytes = read(8);
 
-		if (opcode == 0x9) {
-			this->_pong(result);
-			return this->getAnswer();
+			length = 0;
+			for (unsigned char byte : bytes)
+				length = (length << 8U) + byte;
 		}
 
-		result = this->read(length);
-		if (isMasked) {
-			for (unsigned i = 0; i < result.size(); i++)
-				result[i] ^= key[i % 4];
+		if (isMasked)
+			key = read(4);
+		frame.payload = read(length);
+		if (isMasked)
+			applyMask(frame.payload.data(), frame.payload.size(), key.data());
+		return frame;
+	}
+
+	std::string SecuredWebSocket::getAnswer()
+	{
+		if (!this->isOpen())
+			throw NotConnectedException("This socket is not connected to a server");
+
+		auto frame = decodeFrame([this](size_t size){
+			return this->read(size);
+		});
+
+		// The pong echoes the ping's payload
+		if (frame.opcode == 0x9) {
+			this->_pong(frame.payload);
+			return this->getAnswer();
 		}
+		// We never ping, so pongs are unsolicited heartbeats
+		if (frame.opcode == 0xA)
+			return this->getAnswer();
 
-		if (opcode == 0x8) {
+		if (frame.opcode == 0x8) {
 			this->disconnect();
-			int code = (static_cast<unsigned char>(result[0]) << 8U) + static_cast<unsigned char>(result[1]);
+			// 1005 (No Status Rcvd) if the server didn't give one
+			int code = frame.payload.size() < 2 ? 1005 : (static_cast<unsigned char>(frame.payload[0]) << 8U) + static_cast<unsigned char>(frame.payload[1]);
 			throw ConnectionTerminatedException("Server closed connection with code " + std::to_string(code) + " (" + WEBSOCKET_CODE(code) + ")", code);
 		}
 
-		if (!isEnd)
-			return result + this->getAnswer();
-		return result;
+		if (!frame.isEnd)
+			return frame.payload + this->getAnswer();
+		return frame.payload;
 	}
 
 	void SecuredWebSocket::disconnect()
 	{
-		std::stringstream stream;
-		std::string	result = "\x03\xe8";
-		unsigned	random_value = this->_rand();
-		std::string	key = std::string() +
-			static_cast<char>((random_value >> 24U) & 0xFFU) +
-			static_cast<char>((random_value >> 16U) & 0xFFU) +
-			static_cast<char>((random_value >> 8U) & 0xFFU) +
-			static_cast<char>(random_value & 0xFFU);
-
-		for (unsigned i = 0; i < result.size(); i++)
-			result[i] = result[i] ^ key[i % 4];
-		stream << "\x88\x82" << key << result;
-		SecuredSocket::send(stream.str());
-		SecuredSocket::disconnect();
+		// Close with 1000 (Normal Closure), unless the connection is gone already
+		if (this->isOpen())
+			try {
+				TlsConnection::send(encodeFrame(0x8, "\x03\xe8", this->_rand()));
+			} catch (NetworkException &) {}
+		TlsConnection::disconnect();
 	}
 
 	std::string SecuredWebSocket::getRawAnswer()
@@ -176,14 +253,14 @@ namespace ChallongeSoku
 
 	void SecuredWebSocket::sendHttpRequest(const Socket::HttpRequest &request)
 	{
-		std::string requestString = generateHttpRequest(request);
+		std::string requestString = Socket::generateHttpRequest(request);
 
-		SecuredSocket::send(requestString);
+		TlsConnection::send(requestString);
 	}
 
 	void SecuredWebSocket::connect(const std::string &host, unsigned short portno)
 	{
-		SecuredSocket::connect(host, portno);
+		TlsConnection::connect(host, portno);
 
 		std::string realHost = host;
 
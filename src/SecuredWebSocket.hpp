@@ -7,7 +7,11 @@
 
 
 #include <random>
-#include <SecuredSocket.hpp>
+#include <functional>
+#include <cstdint>
+#include <Socket.hpp>
+#include <Exceptions.hpp>
+#include "TlsConnection.hpp"
 
 namespace ChallongeSoku
 {
@@ -23,26 +27,48 @@ namespace ChallongeSoku
 		InvalidPongException(const std::string &&str) : NetworkException(std::move(str)) {};
 	};
 
-	class SecuredWebSocket : public ChallongeAPI::SecuredSocket {
+	//! @brief Websocket client, over a TlsConnection so its host is resolved through the Resolver and its certificate checked.
+	class SecuredWebSocket : public TlsConnection {
 	private:
 		std::string _path;
 		std::random_device	_rand;
 		void	_establishHandshake(const std::string &host);
+		//! @brief Read the answer to the upgrade request, up to the blank line ending its header and not a byte further.
+		std::string _readHandshakeResponse();
 		void	_pong(const std::string &validator);
 
 	public:
+		struct Frame {
+			unsigned char opcode;
+			bool isEnd;
+			//! @brief Unmasked already.
+			std::string payload;
+		};
+
 		static const char * const codesStrings[];
-		using Socket::connect;
+		//! @brief Longest answer to the upgrade request accepted.
+		static constexpr size_t maxHandshakeSize = 8192;
+
+		//! @brief Build a final, masked frame, as a client must send them.
+		static std::string encodeFrame(unsigned char opcode, const std::string &payload, uint32_t maskKey);
+		//! @brief Read a whole frame, header and payload.
+		//! @param read Gives the next bytes of the stream, exactly as many as asked.
+		static Frame	decodeFrame(const std::function<std::string (size_t size)> &read);
+		//! @brief Mask or unmask data in place.
+		static void	applyMask(char *data, size_t size, const char key[4]);
+		//! @brief The Sec-WebSocket-Accept a server must answer to a Sec-WebSocket-Key.
+		static std::string getAcceptKey(const std::string &key);
 
 		SecuredWebSocket() = default;
 		~SecuredWebSocket() = default;
 
 		const std::string &getPath() const;
 		void setPath(const std::string &path);
-		void		send(const std::string &value) override;
-		void		disconnect() override;
-		void		connect(const std::string &host, unsigned short portno) override;
-		void		sendHttpRequest(const HttpRequest &request);
+		void		send(const std::string &value);
+		//! @brief Send a close frame if the connection is still up, and disconnect.
+		void		disconnect();
+		void		connect(const std::string &host, unsigned short portno);
+		void		sendHttpRequest(const ChallongeAPI::Socket::HttpRequest &request);
 		std::string	getAnswer();
 		std::string	getRawAnswer();
 	};
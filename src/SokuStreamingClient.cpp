@@ -0,0 +1,369 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closeSocket closesocket
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <cerrno>
+#include <sys/select.h>
+#include <sys/socket.h>
+#define closeSocket close
+#endif
+#include <future>
+#include <cstring>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <json.hpp>
+#include "SokuStreamingClient.hpp"
+#include "Resolver.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace ChallongeSoku
+{
+	// Thrown when a connection that was kept alive turns out to be closed before anything was read from it
+	class StaleConnectionException : public std::runtime_error {
+	public:
+		StaleConnectionException() : std::runtime_error("Connection closed by SokuStreaming") {}
+	};
+
+	static std::string makeHttpRequest(const std::string &host, const std::string &path, const std::string &body)
+	{
+		return "POST " + path + " HTTP/1.1\r\n"
+			"Host: " + host + "\r\n"
+			"Content-Type: application/json\r\n"
+			"Content-Length: " + std::to_string(body.size()) + "\r\n"
+			"Connection: keep-alive\r\n"
+			"\r\n" + body;
+	}
+
+	// Tells the caller a join won't be made if it is dropped, by the client or the TaskPool stopping,
+	// so nobody waits forever on it
+	struct PendingJoin {
+		SokuStreamingClient::Request request;
+		SokuStreamingClient::Callback callback;
+		bool done = false;
+
+		PendingJoin(const SokuStreamingClient::Request &request, const SokuStreamingClient::Callback &callback) :
+			request(request),
+			callback(callback)
+		{
+		}
+
+		~PendingJoin()
+		{
+			if (!this->done && this->callback)
+				this->callback({false, 0, 0, "", "", "SokuStreaming client stopped"});
+		}
+	};
+
+	SokuStreamingClient::SokuStreamingClient()
+	{
+#ifdef _WIN32
+		WSADATA data;
+
+		WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+	}
+
+	SokuStreamingClient::~SokuStreamingClient()
+	{
+		this->_running = false;
+		// Pending joins are answered as stopped when dropped
+		this->_joins.cancel();
+		this->_joins.wait();
+		this->_disconnect();
+	}
+
+	void SokuStreamingClient::setEndpoint(const std::string &host, unsigned short port)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_host = host;
+		this->_port = port;
+		// The first join doesn't have to wait for the lookup
+		Resolver::prefetch(host, port);
+	}
+
+	void SokuStreamingClient::setTimeout(float seconds)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_timeout = seconds;
+	}
+
+	void SokuStreamingClient::join(const Request &request, const Callback &callback)
+	{
+		auto pending = std::make_shared<PendingJoin>(request, callback);
+
+		// Dropping it answers the callback
+		if (!this->_running)
+			return;
+		this->_joins.post([this, pending]{
+			std::unique_lock<std::mutex> lock{this->_mutex};
+			auto host = this->_host;
+			auto port = this->_port;
+			auto timeout = this->_timeout;
+
+			lock.unlock();
+
+			auto result = this->_perform(pending->request, host, port, timeout);
+
+			pending->done = true;
+			if (pending->callback)
+				pending->callback(result);
+		});
+	}
+
+	SokuStreamingClient::Result SokuStreamingClient::joinSync(const Request &request)
+	{
+		auto promise = std::make_shared<std::promise<Result>>();
+		auto future = promise->get_future();
+
+		this->join(request, [promise](const Result &result){
+			promise->set_value(result);
+		});
+		return future.get();
+	}
+
+	std::string SokuStreamingClient::makeStateBody(const Request &request)
+	{
+		return nlohmann::json{
+			{"left",  {{"name", request.leftName},  {"score", 0}}},
+			{"right", {{"name", request.rightName}, {"score", 0}}},
+			{"round", request.roundName},
+		}.dump();
+	}
+
+	std::string SokuStreamingClient::makeConnectBody(const Request &request)
+	{
+		return nlohmann::json{
+			{"ip",   request.ip},
+			{"port", request.port},
+			{"spec", request.spectate},
+		}.dump();
+	}
+
+	SokuStreamingClient::Result SokuStreamingClient::_perform(const Request &request, const std::string &host, unsigned short port, float timeout)
+	{
+		Result result;
+		// The whole join, reconnections included, must be over before it
+		Deadline deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(timeout));
+		std::string stateRequest = makeHttpRequest(host, "/state", makeStateBody(request));
+		std::string connectRequest = makeHttpRequest(host, "/connect", makeConnectBody(request));
+
+		if (this->_socket >= 0 && (this->_connectedHost != host || this->_connectedPort != port))
+			this->_disconnect();
+		try {
+			Response state;
+
+			// A kept alive connection may have been closed since last time, then it is opened again once
+			for (;;) {
+				bool reused = this->_socket >= 0;
+
+				try {
+					if (!reused)
+						this->_connect(host, port, deadline);
+					this->_sendAll(stateRequest + connectRequest, deadline);
+					state = this->_readResponse(deadline);
+					break;
+				} catch (StaleConnectionException &) {
+					this->_disconnect();
+					if (!reused)
+						throw;
+				}
+			}
+			result.stateCode = state.code;
+			result.stateCodeName = state.codeName;
+			if (state.close) {
+				// SokuStreaming won't answer the pipelined /connect on this connection, it is sent again on a new one
+				this->_disconnect();
+				this->_connect(host, port, deadline);
+				this->_sendAll(connectRequest, deadline);
+			}
+
+			auto connect = this->_readResponse(deadline);
+
+			result.connectCode = connect.code;
+			result.connectCodeName = connect.codeName;
+			if (connect.close)
+				this->_disconnect();
+		} catch (std::exception &e) {
+			this->_disconnect();
+			result.error = e.what();
+		}
+		result.success = result.error.empty() && result.stateCode / 100 == 2 && result.connectCode / 100 == 2;
+		return result;
+	}
+
+	void SokuStreamingClient::_connect(const std::string &host, unsigned short port, Deadline deadline)
+	{
+		this->_socket = Resolver::connect(host, port, deadline);
+		this->_connectedHost = host;
+		this->_connectedPort = port;
+		this->_buffer.clear();
+	}
+
+	void SokuStreamingClient::_disconnect()
+	{
+		if (this->_socket >= 0)
+			closeSocket(this->_socket);
+		this->_socket = -1;
+		this->_buffer.clear();
+	}
+
+	void SokuStreamingClient::_wait(bool write, Deadline deadline)
+	{
+		auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count();
+		fd_set set;
+		timeval timeout;
+
+		if (remaining <= 0)
+			throw std::runtime_error("SokuStreaming timed out");
+		timeout.tv_sec = remaining / 1000000;
+		timeout.tv_usec = remaining % 1000000;
+		FD_ZERO(&set);
+		FD_SET(this->_socket, &set);
+		if (select(static_cast<int>(this->_socket + 1), write ? nullptr : &set, write ? &set : nullptr, nullptr, &timeout) <= 0)
+			throw std::runtime_error("SokuStreaming timed out");
+	}
+
+	void SokuStreamingClient::_sendAll(const std::string &data, Deadline deadline)
+	{
+		for (size_t sent = 0; sent < data.size();) {
+			this->_wait(true, deadline);
+
+			auto size = send(this->_socket, data.c_str() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+			if (size <= 0)
+				throw StaleConnectionException();
+			sent += size;
+		}
+	}
+
+	bool SokuStreamingClient::_receive(Deadline deadline)
+	{
+		char buffer[4096];
+
+		this->_wait(false, deadline);
+
+		auto size = recv(this->_socket, buffer, sizeof(buffer), 0);
+
+		if (size <= 0)
+			return false;
+		this->_buffer.append(buffer, size);
+		return true;
+	}
+
+	SokuStreamingClient::Response SokuStreamingClient::_readResponse(Deadline deadline)
+	{
+		Response response{0, "", "", false};
+		size_t end;
+		std::optional<size_t> length;
+		bool chunked = false;
+
+		while ((end = this->_buffer.find("\r\n\r\n")) == std::string::npos)
+			if (!this->_receive(deadline)) {
+				if (this->_buffer.empty())
+					throw StaleConnectionException();
+				throw std::runtime_error("SokuStreaming closed the connection in the middle of an answer");
+			}
+
+		auto head = this->_buffer.substr(0, end);
+		auto lineEnd = head.find("\r\n");
+		auto statusLine = head.substr(0, lineEnd);
+		auto codeStart = statusLine.find(' ');
+
+		if (codeStart == std::string::npos)
+			throw std::runtime_error("Invalid answer from SokuStreaming: " + statusLine);
+		response.code = std::atoi(statusLine.c_str() + codeStart + 1);
+		if (statusLine.find(' ', codeStart + 1) != std::string::npos)
+			response.codeName = statusLine.substr(statusLine.find(' ', codeStart + 1) + 1);
+		response.close = statusLine.compare(0, 8, "HTTP/1.0") == 0;
+		for (size_t pos = lineEnd; pos != std::string::npos && pos < head.size();) {
+			auto next = head.find("\r\n", pos + 2);
+			auto line = head.substr(pos + 2, next == std::string::npos ? std::string::npos : next - pos - 2);
+			auto colon = line.find(':');
+
+			pos = next;
+			if (colon == std::string::npos)
+				continue;
+
+			auto name = line.substr(0, colon);
+			auto value = line.substr(line.find_first_not_of(' ', colon + 1) == std::string::npos ? line.size() : line.find_first_not_of(' ', colon + 1));
+
+			std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+			std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+			if (name == "content-length")
+				length = std::stoul(value);
+			else if (name == "transfer-encoding")
+				chunked = value.find("chunked") != std::string::npos;
+			else if (name == "connection")
+				response.close = value == "close";
+		}
+		this->_buffer.erase(0, end + 4);
+		if (response.code == 204 || response.code == 304 || response.code / 100 == 1)
+			return response;
+		if (chunked)
+			response.body = this->_readChunked(deadline);
+		else if (length) {
+			while (this->_buffer.size() < *length)
+				if (!this->_receive(deadline))
+					throw std::runtime_error("SokuStreaming closed the connection in the middle of an answer");
+			response.body = this->_buffer.substr(0, *length);
+			this->_buffer.erase(0, *length);
+		} else if (response.close) {
+			// Without a length, the body goes on until the connection is closed
+			while (this->_receive(deadline));
+			response.body = std::move(this->_buffer);
+			this->_buffer.clear();
+		} else
+			// The end of the body can't be told, waiting for it would stall the pipelined answer until the timeout
+			throw std::runtime_error("SokuStreaming answered without a length on a kept alive connection");
+		return response;
+	}
+
+	std::string SokuStreamingClient::_readChunked(Deadline deadline)
+	{
+		std::string body;
+		size_t end;
+		auto receive = [this, deadline]{
+			if (!this->_receive(deadline))
+				throw std::runtime_error("SokuStreaming closed the connection in the middle of an answer");
+		};
+
+		while (true) {
+			while ((end = this->_buffer.find("\r\n")) == std::string::npos)
+				receive();
+
+			// Extensions after the size are ignored, stoul stops at the ';'
+			size_t size = std::stoul(this->_buffer.substr(0, end), nullptr, 16);
+
+			this->_buffer.erase(0, end + 2);
+			if (size == 0)
+				break;
+			while (this->_buffer.size() < size + 2)
+				receive();
+			body.append(this->_buffer, 0, size);
+			this->_buffer.erase(0, size + 2);
+		}
+		// Trailers, up to an empty line
+		while ((end = this->_buffer.find("\r\n")) != 0) {
+			if (end == std::string::npos)
+				receive();
+			else
+				this->_buffer.erase(0, end + 2);
+		}
+		this->_buffer.erase(0, 2);
+		return body;
+	}
+}
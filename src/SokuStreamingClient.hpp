@@ -0,0 +1,103 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_SOKUSTREAMINGCLIENT_HPP
+#define CHALLONGESOKU_SOKUSTREAMINGCLIENT_HPP
+
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <functional>
+#include "TaskPool.hpp"
+
+namespace ChallongeSoku
+{
+	//! @brief Tells SokuStreaming which match to spectate, without blocking the caller.
+	//! @details A join is a POST /state (names and round shown on stream) and a POST /connect (the host to spectate).
+	//! Both requests are pipelined on a single keep-alive connection, reopened once if SokuStreaming closed it in
+	//! the meantime. If SokuStreaming closes it after answering /state, /connect is sent again on a new one.
+	//! Joins are run one after the other on a TaskQueue, and each of them, reconnections included, must be over
+	//! before the timeout. Bodies are serialized with nlohmann::json so any name is escaped properly.
+	//! Answers must have a length or be chunked, unless SokuStreaming closes the connection after them.
+	class SokuStreamingClient {
+	public:
+		struct Request {
+			std::string leftName;
+			std::string rightName;
+			std::string roundName;
+			std::string ip;
+			unsigned short port;
+			bool spectate = true;
+		};
+
+		struct Result {
+			bool success = false;
+			//! @brief HTTP codes of /state and /connect, 0 if they didn't answer.
+			int stateCode = 0;
+			int connectCode = 0;
+			std::string stateCodeName;
+			std::string connectCodeName;
+			//! @brief Set if SokuStreaming couldn't be reached or didn't answer in time.
+			std::string error;
+		};
+
+		typedef std::function<void (const Result &result)> Callback;
+
+		static constexpr float defaultTimeout = 5;
+
+		SokuStreamingClient();
+		~SokuStreamingClient();
+
+		void	setEndpoint(const std::string &host, unsigned short port);
+		void	setTimeout(float seconds);
+		//! @brief Queue a join. The callback is called from a TaskPool worker once it is over, or with an error
+		//! if the join is dropped because the client or the TaskPool stopped first.
+		void	join(const Request &request, const Callback &callback);
+		//! @brief Join and wait for the result.
+		Result	joinSync(const Request &request);
+
+		static std::string makeStateBody(const Request &request);
+		static std::string makeConnectBody(const Request &request);
+
+	private:
+		struct Response {
+			int code;
+			std::string codeName;
+			std::string body;
+			bool close;
+		};
+
+		typedef std::chrono::steady_clock::time_point Deadline;
+
+		std::mutex _mutex;
+		std::string _host = "localhost";
+		unsigned short _port = 80;
+		float _timeout = defaultTimeout;
+		std::atomic<bool> _running{true};
+
+		// Only used by the joins, which run one after the other
+		intptr_t _socket = -1;
+		std::string _connectedHost;
+		unsigned short _connectedPort = 0;
+		std::string _buffer;
+
+		Result	_perform(const Request &request, const std::string &host, unsigned short port, float timeout);
+		void	_connect(const std::string &host, unsigned short port, Deadline deadline);
+		void	_disconnect();
+		void	_wait(bool write, Deadline deadline);
+		void	_sendAll(const std::string &data, Deadline deadline);
+		bool	_receive(Deadline deadline);
+		Response _readResponse(Deadline deadline);
+		std::string _readChunked(Deadline deadline);
+
+		// Last so it is stopped before anything a join uses is destroyed
+		TaskQueue _joins{"SokuStreamingClient::join"};
+	};
+}
+
+
+#endif //CHALLONGESOKU_SOKUSTREAMINGCLIENT_HPP
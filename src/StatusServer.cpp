@@ -0,0 +1,487 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+// Winsock only handles 64 sockets per select by default
+#define FD_SETSIZE 1024
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closeSocket closesocket
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <arpa/inet.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#define closeSocket close
+#endif
+#include <set>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include "StatusServer.hpp"
+#include "MetricsRegistry.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace ChallongeSoku
+{
+	static void setNonBlocking(intptr_t socket)
+	{
+#ifdef _WIN32
+		u_long enable = 1;
+
+		ioctlsocket(socket, FIONBIO, &enable);
+#else
+		fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+	}
+
+	static bool wouldBlock()
+	{
+#ifdef _WIN32
+		return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+		return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+	}
+
+	static std::string makeFrame(const std::string &event, const std::string &data, unsigned long id = 0)
+	{
+		std::string frame;
+
+		frame.reserve(event.size() + data.size() + 32);
+		frame += "event: ";
+		frame += event;
+		frame += "\n";
+		if (id) {
+			frame += "id: ";
+			frame += std::to_string(id);
+			frame += "\n";
+		}
+		frame += "data: ";
+		frame += data;
+		frame += "\n\n";
+		return frame;
+	}
+
+	StatusServer::StatusServer(SyncEngine &engine) :
+		_engine(engine)
+	{
+	}
+
+	StatusServer::~StatusServer()
+	{
+		this->stop();
+	}
+
+	void StatusServer::start(unsigned short port)
+	{
+		sockaddr_in addr{};
+		int enable = 1;
+
+#ifdef _WIN32
+		WSADATA data;
+
+		WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+		this->_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (this->_socket < 0)
+			throw std::runtime_error("Cannot create status socket");
+		setsockopt(this->_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&enable), sizeof(enable));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(this->_socket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(this->_socket, 64) < 0) {
+			closeSocket(this->_socket);
+			this->_socket = -1;
+			throw std::runtime_error("Cannot listen on port " + std::to_string(port));
+		}
+		setNonBlocking(this->_socket);
+		this->_publish();
+		std::cout << "Status API listening on http://127.0.0.1:" << port << std::endl;
+		this->_lastKeepAlive = std::chrono::steady_clock::now();
+		this->_running = true;
+		this->_thread = std::thread(&StatusServer::_loop, this);
+	}
+
+	void StatusServer::stop()
+	{
+		this->_running = false;
+		if (this->_thread.joinable())
+			this->_thread.join();
+		for (auto &client : this->_clients)
+			closeSocket(client.first);
+		this->_clients.clear();
+		this->_subscribers = 0;
+		if (this->_socket >= 0)
+			closeSocket(this->_socket);
+		this->_socket = -1;
+	}
+
+	size_t StatusServer::getSubscriberCount() const
+	{
+		return this->_subscribers;
+	}
+
+	unsigned long StatusServer::getVersion() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_version;
+	}
+
+	void StatusServer::onEvent(const SyncEngine::Event &event)
+	{
+		auto value = SyncEngine::eventToJson(event);
+
+		value["time"] = std::time(nullptr);
+		{
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			this->_events.push_back(value);
+			while (this->_events.size() > maxEvents)
+				this->_events.pop_front();
+		}
+		this->_post("log", value.dump());
+		switch (event.type) {
+		case SyncEngine::EVENT_LOADING:
+		case SyncEngine::EVENT_SNAPSHOT_LOADED:
+		case SyncEngine::EVENT_LOADED:
+		case SyncEngine::EVENT_STRUCTURE_CHANGED:
+		case SyncEngine::EVENT_MATCHES_CHANGED:
+		case SyncEngine::EVENT_HOSTS_CHANGED:
+			this->_publish();
+			break;
+		default:
+			break;
+		}
+	}
+
+	void StatusServer::_post(const std::string &event, const std::string &data)
+	{
+		auto buffer = std::make_shared<const std::string>(makeFrame(event, data));
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_outbox.push_back(buffer);
+	}
+
+	// Compare the engine's state with what was last published and queue what changed as a single diff
+	void StatusServer::_publish()
+	{
+		// Two threads publishing at once could otherwise apply an older state after a newer one
+		std::unique_lock<std::mutex> publishLock{this->_publishMutex};
+		auto current = this->_engine.toJson();
+		nlohmann::json header{
+			{"url", current["url"]},
+			{"tournament", current["tournament"]},
+		};
+		nlohmann::json changed = nlohmann::json::array();
+		nlohmann::json removed = nlohmann::json::array();
+		std::set<size_t> seen;
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		for (auto &match : current["matches"]) {
+			size_t id = match["id"];
+			auto raw = match.dump();
+			auto it = this->_matches.find(id);
+
+			seen.insert(id);
+			if (it != this->_matches.end() && it->second.raw == raw)
+				continue;
+			changed.push_back(match);
+			this->_matches[id] = {match, std::move(raw)};
+		}
+		for (auto it = this->_matches.begin(); it != this->_matches.end();) {
+			if (seen.count(it->first)) {
+				it++;
+				continue;
+			}
+			removed.push_back(it->first);
+			it = this->_matches.erase(it);
+		}
+		if (changed.empty() && removed.empty() && header == this->_header)
+			return;
+
+		nlohmann::json diff = header;
+
+		this->_version++;
+		this->_header = std::move(header);
+		this->_state.reset();
+		diff["version"] = this->_version;
+		diff["matches"] = std::move(changed);
+		diff["removed"] = std::move(removed);
+		this->_outbox.push_back(std::make_shared<const std::string>(makeFrame("diff", diff.dump(), this->_version)));
+	}
+
+	// Serialized once per change, whatever the number of clients asking for it
+	StatusServer::Buffer StatusServer::_getState(unsigned long *version)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		if (version)
+			*version = this->_version;
+		if (this->_state)
+			return this->_state;
+
+		nlohmann::json state = this->_header;
+		nlohmann::json matches = nlohmann::json::array();
+
+		for (auto &match : this->_matches)
+			matches.push_back(match.second.value);
+		state["version"] = this->_version;
+		state["matches"] = std::move(matches);
+		this->_state = std::make_shared<const std::string>(state.dump());
+		return this->_state;
+	}
+
+	std::string StatusServer::_getMatches(const std::string &filter)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		nlohmann::json matches = nlohmann::json::array();
+
+		for (auto &match : this->_matches) {
+			auto &value = match.second.value;
+
+			if (filter == "open" && value["state"] != "open")
+				continue;
+			if (filter == "hosted" && (value["host"].is_null() || value["host"]["expired"]))
+				continue;
+			matches.push_back(value);
+		}
+		return matches.dump();
+	}
+
+	void StatusServer::_loop()
+	{
+		while (this->_running) {
+			fd_set readSet;
+			fd_set writeSet;
+			intptr_t highest = this->_socket;
+			timeval timeout{0, 50000};
+			std::vector<intptr_t> closed;
+
+			this->_broadcast();
+			FD_ZERO(&readSet);
+			FD_ZERO(&writeSet);
+			FD_SET(this->_socket, &readSet);
+			for (auto &client : this->_clients) {
+				FD_SET(client.first, &readSet);
+				if (!client.second.pending.empty())
+					FD_SET(client.first, &writeSet);
+				highest = std::max(highest, client.first);
+			}
+			// Wake up regularly to send what the engine published and so stop() doesn't wait for a client
+			if (select(highest + 1, &readSet, &writeSet, nullptr, &timeout) <= 0)
+				continue;
+			if (FD_ISSET(this->_socket, &readSet))
+				this->_accept();
+			for (auto &client : this->_clients) {
+				if (FD_ISSET(client.first, &readSet) && !this->_read(client.second))
+					closed.push_back(client.first);
+				else if (FD_ISSET(client.first, &writeSet) && !this->_write(client.second))
+					closed.push_back(client.first);
+				// Plain requests are over once answered, streams stay open
+				else if (client.second.answered && !client.second.subscribed && client.second.pending.empty())
+					closed.push_back(client.first);
+			}
+			for (auto socket : closed)
+				this->_close(socket);
+		}
+	}
+
+	void StatusServer::_broadcast()
+	{
+		std::vector<Buffer> outbox;
+		std::vector<intptr_t> dropped;
+		auto now = std::chrono::steady_clock::now();
+
+		{
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			outbox.swap(this->_outbox);
+		}
+		if (now - this->_lastKeepAlive >= std::chrono::seconds(keepAliveInterval)) {
+			static const auto keepAlive = std::make_shared<const std::string>(":\n\n");
+
+			outbox.push_back(keepAlive);
+			this->_lastKeepAlive = now;
+		}
+		if (outbox.empty())
+			return;
+		for (auto &client : this->_clients) {
+			if (!client.second.subscribed)
+				continue;
+			for (auto &buffer : outbox)
+				if (!this->_queue(client.second, buffer)) {
+					std::cerr << "Status API: dropping a subscriber that doesn't keep up" << std::endl;
+					dropped.push_back(client.first);
+					break;
+				}
+		}
+		for (auto socket : dropped)
+			this->_close(socket);
+	}
+
+	void StatusServer::_accept()
+	{
+		while (true) {
+			intptr_t socket = accept(this->_socket, nullptr, nullptr);
+
+			if (socket < 0)
+				return;
+#ifndef _WIN32
+			if (socket >= FD_SETSIZE) {
+				closeSocket(socket);
+				continue;
+			}
+#endif
+			if (this->_clients.size() >= maxClients) {
+				closeSocket(socket);
+				continue;
+			}
+			setNonBlocking(socket);
+			this->_clients[socket].socket = socket;
+		}
+	}
+
+	bool StatusServer::_read(Client &client)
+	{
+		char buffer[4096];
+		auto size = recv(client.socket, buffer, sizeof(buffer), 0);
+
+		if (size < 0)
+			return wouldBlock();
+		if (size == 0)
+			return false;
+		// Nothing else is expected from a client once it got its answer
+		if (client.answered)
+			return true;
+		client.request.append(buffer, size);
+
+		auto end = client.request.find("\r\n\r\n");
+
+		if (end == std::string::npos) {
+			if (client.request.size() <= maxRequestSize)
+				return true;
+			this->_respond(client, "431 Request Header Fields Too Large", R"({"error":"Request too large"})");
+			return true;
+		}
+
+		auto line = client.request.substr(0, client.request.find("\r\n"));
+		auto method = line.substr(0, line.find(' '));
+		auto path = line.size() > method.size() ? line.substr(method.size() + 1) : "";
+
+		path = path.substr(0, path.find(' '));
+		path = path.substr(0, path.find('?'));
+		this->_answer(client, method, path);
+		client.request.clear();
+		return true;
+	}
+
+	bool StatusServer::_write(Client &client)
+	{
+		while (!client.pending.empty()) {
+			auto &buffer = *client.pending.front();
+			auto size = send(client.socket, buffer.c_str() + client.offset, buffer.size() - client.offset, MSG_NOSIGNAL);
+
+			if (size < 0)
+				return wouldBlock();
+			client.offset += size;
+			if (client.offset < buffer.size())
+				return true;
+			if (client.pending.front() == client.answer)
+				client.answer.reset();
+			else
+				client.pendingBytes -= buffer.size();
+			client.offset = 0;
+			client.pending.pop_front();
+		}
+		return true;
+	}
+
+	bool StatusServer::_queue(Client &client, const Buffer &buffer)
+	{
+		if (client.pendingBytes + buffer->size() > maxPendingBytes)
+			return false;
+		client.pending.push_back(buffer);
+		client.pendingBytes += buffer->size();
+		return true;
+	}
+
+	void StatusServer::_queueAnswer(Client &client, const Buffer &buffer)
+	{
+		client.answer = buffer;
+		client.pending.push_back(buffer);
+	}
+
+	void StatusServer::_answer(Client &client, const std::string &method, const std::string &path)
+	{
+		if (method != "GET")
+			return this->_respond(client, "405 Method Not Allowed", R"({"error":"Only GET is supported"})");
+		if (path == "/state")
+			return this->_respond(client, "200 OK", *this->_getState());
+		if (path == "/matches")
+			return this->_respond(client, "200 OK", this->_getMatches(""));
+		if (path == "/matches/open")
+			return this->_respond(client, "200 OK", this->_getMatches("open"));
+		if (path == "/matches/hosted")
+			return this->_respond(client, "200 OK", this->_getMatches("hosted"));
+		if (path == "/log") {
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			return this->_respond(client, "200 OK", nlohmann::json(this->_events).dump());
+		}
+		if (path == "/metrics")
+			return this->_respond(client, "200 OK", MetricsRegistry::snapshot().toJson().dump());
+		if (path != "/events")
+			return this->_respond(client, "404 Not Found", R"({"error":"Not found"})");
+
+		// Both under the same lock, so the diffs that follow apply on top of this state
+		unsigned long version;
+		auto state = this->_getState(&version);
+
+		client.answered = true;
+		client.subscribed = true;
+		this->_subscribers++;
+		this->_queueAnswer(client, std::make_shared<const std::string>(
+			"HTTP/1.1 200 OK\r\n"
+			"Content-Type: text/event-stream\r\n"
+			"Cache-Control: no-cache\r\n"
+			"Connection: keep-alive\r\n"
+			"Access-Control-Allow-Origin: *\r\n"
+			"\r\n"
+			"retry: 2000\n\n" + makeFrame("state", *state, version)
+		));
+	}
+
+	void StatusServer::_respond(Client &client, const std::string &status, const std::string &body)
+	{
+		client.answered = true;
+		this->_queueAnswer(client, std::make_shared<const std::string>(
+			"HTTP/1.1 " + status + "\r\n"
+			"Content-Type: application/json\r\n"
+			"Content-Length: " + std::to_string(body.size()) + "\r\n"
+			"Access-Control-Allow-Origin: *\r\n"
+			"Connection: close\r\n"
+			"\r\n" + body
+		));
+	}
+
+	void StatusServer::_close(intptr_t socket)
+	{
+		auto it = this->_clients.find(socket);
+
+		if (it == this->_clients.end())
+			return;
+		if (it->second.subscribed)
+			this->_subscribers--;
+		closeSocket(socket);
+		this->_clients.erase(it);
+	}
+}
@@ -0,0 +1,118 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_STATUSSERVER_HPP
+#define CHALLONGESOKU_STATUSSERVER_HPP
+
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <json.hpp>
+#include "SyncEngine.hpp"
+
+namespace ChallongeSoku
+{
+	//! @brief Local HTTP API exposing what a SyncEngine knows, for stream overlays and tools.
+	//! @details Routes:
+	//!  - GET /state: the whole tournament, with the version of the last change.
+	//!  - GET /matches, /matches/open, /matches/hosted: all the matches, or only the open or hosted ones.
+	//!  - GET /log: the last events the engine emitted.
+	//!  - GET /metrics: a snapshot of the MetricsRegistry.
+	//!  - GET /events: Server-Sent Events. The whole state is sent first as a "state" event, then every change
+	//!    as a "diff" event holding the matches that changed and the ids of the removed ones. Engine events are
+	//!    forwarded as "log" events.
+	//! A single thread serves every client with non-blocking sockets. Each change is serialized once, and the same
+	//! buffer is queued to every subscriber. Subscribers which can't keep up are dropped and EventSource reconnects them,
+	//! which sends them the whole state again. Only listens on the loopback interface.
+	class StatusServer {
+	public:
+		//! @brief How many events GET /log remembers.
+		static constexpr size_t maxEvents = 100;
+		static constexpr size_t maxClients = 512;
+		//! @brief Bytes a subscriber may have waiting before being dropped, not counting the answer to its request.
+		static constexpr size_t maxPendingBytes = 1 << 20;
+		static constexpr size_t maxRequestSize = 8192;
+		//! @brief Seconds between two SSE comments, so proxies and browsers don't close idle streams.
+		static constexpr unsigned keepAliveInterval = 15;
+
+		StatusServer(SyncEngine &engine);
+		~StatusServer();
+
+		//! @throw std::runtime_error The port cannot be listened on.
+		void	start(unsigned short port);
+		void	stop();
+		//! @brief Forward an event and publish the changes it brought. To be called from an engine listener.
+		void	onEvent(const SyncEngine::Event &event);
+		size_t	getSubscriberCount() const;
+		unsigned long getVersion() const;
+
+	private:
+		typedef std::shared_ptr<const std::string> Buffer;
+
+		struct Client {
+			intptr_t socket;
+			std::string request;
+			std::deque<Buffer> pending;
+			size_t offset = 0;
+			size_t pendingBytes = 0;
+			// Not counted in pendingBytes, so a state bigger than maxPendingBytes is still sent whole
+			Buffer answer;
+			bool answered = false;
+			bool subscribed = false;
+		};
+
+		struct PublishedMatch {
+			nlohmann::json value;
+			std::string raw;
+		};
+
+		SyncEngine &_engine;
+		std::mutex _publishMutex;
+
+		// Everything published so far. Written by the engine's threads, read by the server thread.
+		mutable std::mutex _mutex;
+		std::deque<nlohmann::json> _events;
+		unsigned long _version = 0;
+		nlohmann::json _header;
+		std::map<size_t, PublishedMatch> _matches;
+		Buffer _state;
+		std::vector<Buffer> _outbox;
+
+		std::atomic<bool> _running{false};
+		std::atomic<size_t> _subscribers{0};
+		// Not a TaskPool task: it waits on its sockets in select as long as the server runs
+		std::thread _thread;
+		intptr_t _socket = -1;
+		std::map<intptr_t, Client> _clients;
+		std::chrono::steady_clock::time_point _lastKeepAlive;
+
+		void	_publish();
+		void	_post(const std::string &event, const std::string &data);
+		// The version of the state is given through version if it isn't null
+		Buffer	_getState(unsigned long *version = nullptr);
+		std::string _getMatches(const std::string &filter);
+
+		void	_loop();
+		void	_broadcast();
+		void	_accept();
+		bool	_read(Client &client);
+		bool	_write(Client &client);
+		bool	_queue(Client &client, const Buffer &buffer);
+		void	_queueAnswer(Client &client, const Buffer &buffer);
+		void	_answer(Client &client, const std::string &method, const std::string &path);
+		void	_respond(Client &client, const std::string &status, const std::string &body);
+		void	_close(intptr_t socket);
+	};
+}
+
+
+#endif //CHALLONGESOKU_STATUSSERVER_HPP
@@ -0,0 +1,1335 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <set>
+#include <future>
+#include <iostream>
+#include <tuple>
+#include <algorithm>
+#include <json.hpp>
+#include <Socket.hpp>
+#include <Exceptions.hpp>
+#define private public
+#include <Participant.hpp>
+#include <Tournament.hpp>
+#include <Match.hpp>
+#undef private
+#include <JsonUtils.hpp>
+#include "SyncEngine.hpp"
+#include "MetricsRegistry.hpp"
+#include "Resolver.hpp"
+#include "Tracer.hpp"
+#include "LastException.hpp"
+
+using namespace ChallongeAPI;
+
+namespace ChallongeSoku
+{
+	const char * const SyncEngine::eventTypeStrings[] = {
+		"loading",
+		"snapshot_loaded",
+		"loaded",
+		"load_failed",
+		"structure_changed",
+		"matches_changed",
+		"hosts_changed",
+		"status",
+		"error",
+		"refreshed",
+		"director",
+	};
+
+	const char * const SyncEngine::channelStrings[] = {
+		"sokustreaming",
+		"challonge",
+		"konni",
+		"websocket",
+	};
+
+	const char * const SyncEngine::levelStrings[] = {
+		"ok",
+		"warning",
+		"error",
+	};
+
+	static void incrementId(std::string &id, int index = -2)
+	{
+		if (index <= -2)
+			index = id.size() - 1;
+
+		if (index == -1) {
+			id.reserve(index + 1);
+			id = "1" + id;
+			for (unsigned i = index + 1; i < id.size(); i++)
+				id[i] = '0';
+			return;
+		}
+
+		char c = id[index];
+
+		c++;
+		if (c == ':')
+			c = 'a';
+		if (c == '{')
+			return incrementId(id, index - 1);
+		id[index] = c;
+		for (unsigned i = index + 1; i < id.size(); i++)
+			id[i] = '0';
+	}
+
+	static void addMatchToBracket(const std::shared_ptr<Match> &match, Bracket &bracket)
+	{
+		bracket.roundBounds.first = std::min(match->getRound(), bracket.roundBounds.first);
+		bracket.roundBounds.second = std::max(match->getRound(), bracket.roundBounds.second);
+		bracket.elim[match->getRound()].push_back(match);
+		if (match->getRound() <= 0)
+			return;
+		while (bracket.robbin.size() < static_cast<size_t>(match->getRound()))
+			bracket.robbin.emplace_back();
+		bracket.robbin[match->getRound() - 1].push_back(match);
+	}
+
+	static void addMatchToPool(const std::shared_ptr<Match> &match, Pool &pool)
+	{
+		addMatchToBracket(match, pool[*match->getGroupId()]);
+	}
+
+	static void updateRoundBounds(Bracket &bracket)
+	{
+		bracket.roundBounds.first = INT32_MAX;
+		bracket.roundBounds.second = INT32_MIN;
+		if (bracket.elim.empty())
+			return;
+		bracket.roundBounds.first = bracket.elim.begin()->first;
+		bracket.roundBounds.second = bracket.elim.rbegin()->first;
+	}
+
+	static void removeMatchFromBracket(const std::shared_ptr<Match> &match, Bracket &bracket)
+	{
+		auto erase = [&match](Round &round){
+			round.erase(std::remove(round.begin(), round.end(), match), round.end());
+		};
+		auto it = bracket.elim.find(match->getRound());
+
+		if (it != bracket.elim.end()) {
+			erase(it->second);
+			if (it->second.empty())
+				bracket.elim.erase(it);
+		}
+		if (match->getRound() > 0 && static_cast<size_t>(match->getRound()) <= bracket.robbin.size())
+			erase(bracket.robbin[match->getRound() - 1]);
+		while (!bracket.robbin.empty() && bracket.robbin.back().empty())
+			bracket.robbin.pop_back();
+		updateRoundBounds(bracket);
+	}
+
+	static bool isSameHost(const KonniMatch &a, const KonniMatch &b)
+	{
+		return std::tie(
+			a.autopunch, a.clientChallonge, a.clientCharacter, a.clientCountry, a.clientName,
+			a.hostChallonge, a.hostCharacter, a.hostCountry, a.hostName, a.ip, a.port, a.message,
+			a.ranked, a.spectatable, a.spectators, a.start, a.gameStarted, a.expired
+		) == std::tie(
+			b.autopunch, b.clientChallonge, b.clientCharacter, b.clientCountry, b.clientName,
+			b.hostChallonge, b.hostCharacter, b.hostCountry, b.hostName, b.ip, b.port, b.message,
+			b.ranked, b.spectatable, b.spectators, b.start, b.gameStarted, b.expired
+		);
+	}
+
+	static std::string getGroupStageType(size_t participantsCount, const Pool &pools)
+	{
+		if (pools.empty())
+			return "who cares";
+
+		bool hadZero = false;
+		bool diffSize = false;
+		size_t nbMatchs = 0;
+		size_t nbRounds = 0;
+		size_t participantsPerPool = participantsCount / pools.size();
+
+		for (auto &bracket : pools) {
+			diffSize |= nbRounds && nbRounds != bracket.second.robbin.size();
+			nbRounds = bracket.second.robbin.size();
+			for (auto &round : bracket.second.elim) {
+				if (round.first < 0)
+					return "double elimination";
+				hadZero |= round.second.empty();
+				diffSize |= nbMatchs && nbMatchs != round.second.size();
+				nbMatchs = round.second.size();
+			}
+		}
+		if (participantsCount % pools.size() || hadZero || diffSize || nbMatchs * nbRounds != participantsPerPool * (participantsPerPool - 1) / 2)
+			return "single elimination";
+		return "round robbin";
+	}
+
+	void SyncEngine::Config::load(const nlohmann::json &value)
+	{
+		// Missing keys keep their current value
+		this->apikey               = value.value("apikey", this->apikey);
+		this->username             = value.value("username", this->username);
+		this->sshost               = value.value("sshost", this->sshost);
+		this->ssport               = value.value("ssport", this->ssport);
+		this->konniHost            = value.value("konniHost", this->konniHost);
+		this->konniPort            = value.value("konniPort", this->konniPort);
+		this->sokuStreamingTimeout = value.value("sokuStreamingTimeout", this->sokuStreamingTimeout);
+		this->refreshRate          = value.value("refreshRate", this->refreshRate);
+		this->roundNames           = value.value("roundNames", this->roundNames);
+	}
+
+	SyncEngine::~SyncEngine()
+	{
+		this->stop();
+	}
+
+	void SyncEngine::setConfig(const Config &config)
+	{
+		std::unique_lock<std::mutex> lock{this->_configMutex};
+
+		this->_config = config;
+		this->_client.setCredentials(config.username, config.apikey);
+		this->_sokuStreaming.setEndpoint(config.sshost, config.ssport);
+		this->_sokuStreaming.setTimeout(config.sokuStreamingTimeout);
+	}
+
+	SyncEngine::Config SyncEngine::getConfig() const
+	{
+		std::unique_lock<std::mutex> lock{this->_configMutex};
+
+		return this->_config;
+	}
+
+	void SyncEngine::addListener(const Listener &listener)
+	{
+		this->_listeners.push_back(listener);
+	}
+
+	void SyncEngine::post(const Event &event)
+	{
+		this->_emit(event);
+	}
+
+	void SyncEngine::_emit(const Event &event)
+	{
+		for (auto &listener : this->_listeners)
+			listener(event);
+	}
+
+	void SyncEngine::start()
+	{
+		if (this->_running)
+			return;
+		this->_running = true;
+		this->_refreshThread = std::thread(&SyncEngine::_refreshLoop, this);
+	}
+
+	void SyncEngine::stop()
+	{
+		this->_running = false;
+		this->_refreshCondition.notify_all();
+		this->_traffic.interrupt();
+		if (this->_refreshThread.joinable())
+			this->_refreshThread.join();
+		this->_loadQueue.cancel();
+		this->_loadQueue.wait();
+		this->_disconnectWebSocket();
+	}
+
+	void SyncEngine::_disconnectWebSocket()
+	{
+		{
+			auto lock = this->lock();
+
+			this->_currentTournament.clear();
+		}
+		{
+			std::unique_lock<std::mutex> lock{this->_wsock.mutex};
+
+			this->_wsock.condition.notify_all();
+		}
+		// The socket thread is reading from it, and disconnects it itself once that read fails
+		this->_wsock.socket.interrupt();
+		this->_traffic.interrupt();
+		if (this->_wsock.socketThread.joinable())
+			this->_wsock.socketThread.join();
+		this->_wsock.id = "1";
+	}
+
+	void SyncEngine::load(const std::string &url)
+	{
+		// Only the last tournament asked for matters, the ones which didn't start loading are skipped
+		this->_loadQueue.cancel();
+		this->_loadQueue.post([this, url]{
+			try {
+				this->_disconnectWebSocket();
+				this->_load(url);
+			} catch (HTTPErrorException &e) {
+				auto res = e.getResponse();
+				std::string msg = e.what();
+
+				if (res.returnCode == 401)
+					msg += "\n\nPlease check your credentials.";
+				else if (res.returnCode == 404)
+					msg += "\n\nPlease check the URL.";
+				else if (res.returnCode / 100 == 5)
+					msg += "\n\nPlease try again later.";
+				else {
+					std::cerr << Socket::generateHttpRequest(res.request) << std::endl;
+					msg += "\n\nPlease report this to the developer.";
+				}
+				std::cerr << Socket::generateHttpResponse(res) << std::endl;
+				this->_emit({EVENT_LOAD_FAILED, CHANNEL_CHALLONGE, LEVEL_ERROR, Utils::getLastExceptionName(), msg, {}});
+			} catch (std::exception &e) {
+				this->_emit({EVENT_LOAD_FAILED, CHANNEL_CHALLONGE, LEVEL_ERROR, Utils::getLastExceptionName(), e.what(), {}});
+			}
+		});
+	}
+
+	void SyncEngine::_load(const std::string &url)
+	{
+		auto start = std::chrono::steady_clock::now();
+		auto elapsed = [&start]{
+			return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		};
+		auto snapshot = std::make_shared<TournamentSnapshot>();
+		std::vector<size_t> changed;
+		std::shared_ptr<TournamentSnapshot> tournament;
+		bool fromSnapshot = false;
+
+		this->_emit({EVENT_LOADING, CHANNEL_CHALLONGE, LEVEL_OK, "", url, {}});
+		// Replays must not depend on what was saved on this machine
+		if (this->_traffic.getMode() != TrafficLog::MODE_REPLAY && snapshot->load(TournamentSnapshot::getPath(url))) {
+			{
+				auto lock = this->lock();
+
+				// The snapshot is the tournament until the API answers.
+				// If it never does, the refresh loop keeps retrying this URL and reconciles then.
+				this->_tournament = snapshot;
+				this->_populate(snapshot->type, snapshot->participantsCount, snapshot->participants, snapshot->matches);
+				this->_currentTournament = url;
+			}
+			fromSnapshot = true;
+			this->_connectWebSocket();
+			std::cout << "Snapshot of " << url << " loaded in " << elapsed() << "ms" << std::endl;
+			this->_emit({EVENT_SNAPSHOT_LOADED, CHANNEL_CHALLONGE, LEVEL_OK, snapshot->name, url, {}});
+		}
+		tournament = this->_fetchTournament(url);
+		std::cout << "Tournament fetched in " << elapsed() << "ms" << std::endl;
+		std::cout << "Tournament type is " << tournament->type << std::endl;
+		if (tournament->type == "swiss")
+			throw NotImplementedException("Swiss tournaments are not yet implemented. Sorry....");
+		if (tournament->gameName != "Touhou Hisoutensoku")
+			this->_emit({
+				EVENT_ERROR,
+				CHANNEL_CHALLONGE,
+				LEVEL_WARNING,
+				"Game not supported",
+				"Warning: This tournament's game is " + tournament->gameName + " but it is not supported.\nYou won't be able to use this program to connect to games.",
+				{}
+			});
+		{
+			auto lock = this->lock();
+
+			this->_tournament = tournament;
+			if (fromSnapshot)
+				this->_merge(changed);
+			else
+				this->_populate(tournament->type, tournament->participantsCount, tournament->participants, tournament->matches);
+			this->_currentTournament = url;
+		}
+		// The websocket follows the snapshot's tournament already
+		if (!fromSnapshot)
+			this->_connectWebSocket();
+		this->_saveSnapshot(url);
+		std::cout << "Tournament " << url << " loaded in " << elapsed() << "ms" << std::endl;
+		this->_emit({EVENT_LOADED, CHANNEL_CHALLONGE, LEVEL_OK, tournament->name, url, {}});
+	}
+
+	void SyncEngine::_saveSnapshot(const std::string &url)
+	{
+		if (this->_traffic.getMode() == TrafficLog::MODE_REPLAY)
+			return;
+		try {
+			auto lock = this->lock();
+
+			this->_tournament->save(TournamentSnapshot::getPath(url));
+		} catch (std::exception &e) {
+			std::cerr << "Cannot save snapshot of " << url << ": " << e.what() << std::endl;
+		}
+	}
+
+	std::shared_ptr<TournamentSnapshot> SyncEngine::_fetchTournament(const std::string &url)
+	{
+		TRACE_SCOPE("fetchTournament");
+		std::shared_ptr<TournamentSnapshot> tournament;
+
+		if (this->_traffic.getMode() == TrafficLog::MODE_REPLAY) {
+			auto entry = this->_traffic.currentEntry(TrafficLog::KIND_TOURNAMENT, "api.challonge.com", url);
+
+			if (!entry)
+				throw NetworkException("Nothing recorded for tournament " + url);
+			if (entry->data.contains("error"))
+				throw NetworkException(entry->data["error"].get<std::string>());
+			tournament = std::make_shared<TournamentSnapshot>();
+			if (!tournament->deserialize(TrafficLog::decodeBase64(entry->data["snapshot"])))
+				throw std::runtime_error("Invalid tournament recorded for " + url);
+			return tournament;
+		}
+		try {
+			tournament = std::make_shared<TournamentSnapshot>(*this->_client.getTournamentByName(url), url);
+		} catch (std::exception &e) {
+			this->_traffic.record(TrafficLog::KIND_TOURNAMENT, "api.challonge.com", {{"url", url}, {"error", e.what()}});
+			throw;
+		}
+		if (this->_traffic.getMode() == TrafficLog::MODE_RECORD)
+			this->_traffic.record(TrafficLog::KIND_TOURNAMENT, "api.challonge.com", {
+				{"url",      url},
+				{"snapshot", TrafficLog::encodeBase64(tournament->serialize())},
+			});
+		return tournament;
+	}
+
+	void SyncEngine::_refreshLoop()
+	{
+		Tracer::setThreadName("Refresh");
+		while (this->_running) {
+			this->_refreshing = true;
+			this->_refresh();
+			this->_refreshing = false;
+
+			std::unique_lock<std::mutex> lock{this->_refreshMutex};
+
+			this->_lastRefresh = std::chrono::steady_clock::now();
+			this->_refreshCondition.wait_for(
+				lock,
+				std::chrono::duration<float>(this->_scheduler.getInterval()),
+				[this]{ return !this->_running; }
+			);
+		}
+	}
+
+	float SyncEngine::getTimeUntilRefresh() const
+	{
+		std::unique_lock<std::mutex> lock{this->_refreshMutex};
+		auto elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - this->_lastRefresh).count();
+
+		lock.unlock();
+
+		return std::max(0.f, this->_scheduler.getInterval() - elapsed);
+	}
+
+	bool SyncEngine::isRefreshing() const
+	{
+		return this->_refreshing;
+	}
+
+	RefreshScheduler::Metrics SyncEngine::getSchedulerMetrics() const
+	{
+		return this->_scheduler.getMetrics();
+	}
+
+	void SyncEngine::_checkSokuStreaming()
+	{
+		TRACE_SCOPE("checkSokuStreaming");
+		auto config = this->getConfig();
+		Socket sock;
+		Socket::HttpRequest requ;
+
+		try {
+			requ.portno = config.ssport;
+			requ.host = config.sshost;
+			requ.httpVer = "HTTP/1.1";
+			requ.method = "GET";
+			requ.path = "/connect";
+
+			auto res = this->_traffic.makeHttpRequest(sock, requ);
+
+			this->_emit({EVENT_STATUS, CHANNEL_SOKUSTREAMING, LEVEL_WARNING, "", "Warning: Invalid SokuStreaming version: GET to /connect returned " + std::to_string(res.returnCode) + " " + res.codeName, {}});
+		} catch (HTTPErrorException &e) {
+			switch (e.getResponse().returnCode) {
+			case 404:
+				this->_emit({EVENT_STATUS, CHANNEL_SOKUSTREAMING, LEVEL_WARNING, "", "Warning: Invalid SokuStreaming version: GET to /connect returned 404 " + e.getResponse().codeName, {}});
+				break;
+			case 403:
+				this->_emit({EVENT_STATUS, CHANNEL_SOKUSTREAMING, LEVEL_WARNING, "", "Warning: SokuStreaming refused access to /connect: " + e.getResponse().codeName, {}});
+				break;
+			case 405:
+				this->_emit({EVENT_STATUS, CHANNEL_SOKUSTREAMING, LEVEL_OK, "", "SokuStreaming works", {}});
+				break;
+			default:
+				this->_emit({EVENT_STATUS, CHANNEL_SOKUSTREAMING, LEVEL_WARNING, "", "Warning: Invalid SokuStreaming version: GET to /connect returned " + std::to_string(e.getResponse().returnCode) + " " + e.getResponse().codeName, {}});
+			}
+		} catch (std::exception &e) {
+			std::cerr << e.what() << std::endl;
+			this->_emit({EVENT_STATUS, CHANNEL_SOKUSTREAMING, LEVEL_ERROR, "", "Warning: Cannot connect to SokuStreaming: " + std::string(e.what()), {}});
+		}
+	}
+
+	void SyncEngine::_refresh()
+	{
+		static const auto totalTime = MetricsRegistry::histogram("refresh.total_us");
+		static const auto sokuStreamingTime = MetricsRegistry::histogram("refresh.sokustreaming_us");
+		static const auto challongeTime = MetricsRegistry::histogram("refresh.challonge_us");
+		static const auto konniTime = MetricsRegistry::histogram("refresh.konni_us");
+		MetricsRegistry::Timer timer{totalTime};
+		TRACE_SCOPE("refresh");
+		auto start = MetricsRegistry::Clock::now();
+		bool failed = false;
+		bool hadMatches;
+		bool firstMatches;
+		std::optional<float> retryAfter;
+
+		this->_checkSokuStreaming();
+		sokuStreamingTime.recordSince(start);
+		if (this->getCurrentTournament().empty()) {
+			this->_scheduleNextRefresh(false, {});
+			return this->_emit({EVENT_REFRESHED, CHANNEL_CHALLONGE, LEVEL_OK, "", "", {}});
+		}
+		{
+			auto lock = this->lock();
+
+			hadMatches = !this->_matches.empty();
+		}
+		this->_emit({EVENT_STATUS, CHANNEL_CHALLONGE, LEVEL_OK, "", "", {}});
+		start = MetricsRegistry::Clock::now();
+		failed |= !this->_refreshChallonge(retryAfter);
+		challongeTime.recordSince(start);
+		{
+			auto lock = this->lock();
+
+			// Konni not knowing the tournament is only worth a message box when its matches just appeared
+			firstMatches = hadMatches != !this->_matches.empty();
+		}
+		start = MetricsRegistry::Clock::now();
+		failed |= !this->_refreshKonni(retryAfter, firstMatches);
+		konniTime.recordSince(start);
+		this->_scheduleNextRefresh(failed, retryAfter);
+		this->_emit({EVENT_REFRESHED, CHANNEL_CHALLONGE, LEVEL_OK, "", "", {}});
+	}
+
+	bool SyncEngine::_refreshChallonge(std::optional<float> &retryAfter)
+	{
+		TRACE_SCOPE("refreshChallonge");
+		auto url = this->getCurrentTournament();
+
+		try {
+			std::vector<size_t> changed;
+			auto tournament = this->_fetchTournament(url);
+			bool structureChanged;
+
+			{
+				auto lock = this->lock();
+
+				// Another tournament was loaded in the meantime
+				if (this->_currentTournament != url)
+					return true;
+				this->_tournament = tournament;
+				structureChanged = this->_merge(changed);
+			}
+			// The websocket stays subscribed, only the matches that changed are described again
+			if (structureChanged)
+				this->_emit({EVENT_STRUCTURE_CHANGED, CHANNEL_CHALLONGE, LEVEL_OK, "", "", std::move(changed)});
+			this->_saveSnapshot(url);
+			return true;
+		} catch (HTTPErrorException &e) {
+			std::cerr << e.what() << std::endl;
+			retryAfter = RefreshScheduler::getRetryAfter(e.getResponse());
+			this->_emit({EVENT_STATUS, CHANNEL_CHALLONGE, LEVEL_ERROR, "", "Cannot refresh tournament: " + std::string(e.what()), {}});
+		} catch (std::exception &e) {
+			std::cerr << e.what() << std::endl;
+			this->_emit({EVENT_STATUS, CHANNEL_CHALLONGE, LEVEL_ERROR, "", "Cannot refresh tournament: " + std::string(e.what()), {}});
+		}
+		return false;
+	}
+
+	bool SyncEngine::_refreshKonni(std::optional<float> &retryAfter, bool firstMatches)
+	{
+		TRACE_SCOPE("refreshKonni");
+		auto config = this->getConfig();
+
+		try {
+			this->_konni.setEndpoint(config.konniHost, config.konniPort);
+
+			auto result = this->_konni.poll(this->getCurrentTournament(), this->_traffic);
+
+			if (result.changed)
+				std::cout << "Konni games changed: " << result.added << " added, " << result.updated << " updated, " << result.removed << " removed" << std::endl;
+			std::vector<size_t> changed;
+
+			{
+				auto lock = this->lock();
+
+				changed = this->_matchKonniHosts(this->_konni.getGames());
+			}
+			if (!changed.empty())
+				this->_emit({EVENT_HOSTS_CHANGED, CHANNEL_KONNI, LEVEL_OK, "", "", changed});
+			return true;
+		} catch (HTTPErrorException &e) {
+			auto delay = RefreshScheduler::getRetryAfter(e.getResponse());
+
+			if (delay)
+				retryAfter = std::max(retryAfter.value_or(0), *delay);
+			switch (e.getResponse().returnCode) {
+			case 404:
+				// The tournament isn't linked with Konni, which isn't going to get better by retrying sooner.
+				// It is a successful poll which found no hosts.
+				if (firstMatches)
+					this->_emit({EVENT_ERROR, CHANNEL_KONNI, LEVEL_WARNING, "Discord tournament not started", "Warning: Requesting games to Konni returned 404. Are you sure you linked the tournament with your discord server using the same URL ?", {}});
+				this->_emit({EVENT_STATUS, CHANNEL_KONNI, LEVEL_WARNING, "", "No games: Tournament hasn't been linked with Konni.", {}});
+				this->_konni.reset();
+				{
+					auto lock = this->lock();
+					auto changed = this->_matchKonniHosts({});
+
+					lock.unlock();
+					if (!changed.empty())
+						this->_emit({EVENT_HOSTS_CHANGED, CHANNEL_KONNI, LEVEL_OK, "", "", changed});
+				}
+				return true;
+			default:
+				this->_emit({EVENT_STATUS, CHANNEL_KONNI, LEVEL_ERROR, "", "Cannot refresh games: " + std::string(e.what()), {}});
+			}
+		} catch (std::exception &e) {
+			std::cerr << e.what() << std::endl;
+			this->_emit({EVENT_STATUS, CHANNEL_KONNI, LEVEL_ERROR, "", "Cannot refresh games: " + std::string(e.what()), {}});
+		}
+		return false;
+	}
+
+	RefreshScheduler::Activity SyncEngine::_getTournamentActivity() const
+	{
+		auto lock = this->lock();
+		bool allComplete = !this->_matches.empty();
+
+		if (this->_currentTournament.empty())
+			return RefreshScheduler::ACTIVITY_IDLE;
+		for (auto &host : this->_matchesStates)
+			if (!host.second.expired)
+				return RefreshScheduler::ACTIVITY_HOSTING;
+		for (auto &match : this->_matches) {
+			if (match.second->getState() == "open")
+				return RefreshScheduler::ACTIVITY_OPEN;
+			allComplete &= match.second->getState() == "complete";
+		}
+		return allComplete ? RefreshScheduler::ACTIVITY_COMPLETE : RefreshScheduler::ACTIVITY_PENDING;
+	}
+
+	void SyncEngine::_scheduleNextRefresh(bool failed, std::optional<float> retryAfter)
+	{
+		auto refreshRate = this->getConfig().refreshRate;
+
+		if (failed)
+			this->_scheduler.reportError(refreshRate, retryAfter);
+		else
+			this->_scheduler.reportSuccess(this->_getTournamentActivity(), refreshRate);
+
+		auto metrics = this->_scheduler.getMetrics();
+
+		std::cout << "Next refresh in " << metrics.effectiveInterval << "s (" << RefreshScheduler::activityStrings[this->_scheduler.getActivity()];
+		if (metrics.consecutiveErrors)
+			std::cout << ", " << metrics.consecutiveErrors << " consecutive error(s)";
+		std::cout << "), average interval " << metrics.averageInterval << "s, " << metrics.requestsSaved << " request(s) saved" << std::endl;
+	}
+
+	void SyncEngine::_sendWebSocketMessage(const std::string &channel, nlohmann::json value)
+	{
+		value["channel"] = channel;
+		// The handshake is what gives the client id
+		if (!this->_wsock.clientId.empty())
+			value["clientId"] = this->_wsock.clientId;
+		value["id"] = this->_wsock.id;
+		incrementId(this->_wsock.id);
+		std::cout << "Sending " << value.dump(4) << std::endl;
+
+		auto frame = nlohmann::json::array({value}).dump();
+
+		this->_traffic.record(TrafficLog::KIND_WEBSOCKET_OUT, "stream.challonge.com", frame);
+		// Recorded frames answer on their own
+		if (this->_traffic.getMode() != TrafficLog::MODE_REPLAY)
+			this->_wsock.socket.send(frame);
+	}
+
+	// The Bayeux handshake goes through the websocket itself, so connecting only costs one TLS handshake
+	void SyncEngine::_connectToWebSocket()
+	{
+		static const auto connectTime = MetricsRegistry::histogram("websocket.connect_us");
+		MetricsRegistry::Timer timer{connectTime};
+		TRACE_SCOPE("connectToWebSocket");
+		std::cout << "Connecting websocket to challonge..." << std::endl;
+		if (this->_traffic.getMode() != TrafficLog::MODE_REPLAY) {
+			this->_wsock.socket.setPath("/faye");
+			this->_wsock.socket.connect("stream.challonge.com", 8000);
+		}
+		this->_wsock.clientId.clear();
+		this->_sendWebSocketMessage("/meta/handshake", {
+			{"version",                  "1.0"},
+			{"supportedConnectionTypes", nlohmann::json::array({"websocket"})}
+		});
+		while (true) {
+			auto data = this->_receiveWebSocketFrame();
+
+			if (!data)
+				throw NetworkException("Connection closed during the Faye handshake");
+			for (auto &elem : nlohmann::json::parse(*data)) {
+				if (elem.value("channel", "") != "/meta/handshake")
+					continue;
+				if (!elem.value("successful", false))
+					throw NetworkException("Faye handshake failed: " + elem.value("error", std::string("no reason given")));
+				this->_wsock.clientId = elem["clientId"];
+				this->_sendWebSocketMessage("/meta/connect", {{"connectionType", "websocket"}});
+				return;
+			}
+		}
+	}
+
+	bool SyncEngine::_webSocketLoop()
+	{
+		static const auto frames = MetricsRegistry::counter("websocket.frames");
+		static const auto frameBytes = MetricsRegistry::counter("websocket.bytes");
+		static const auto applyTime = MetricsRegistry::histogram("websocket.apply_us");
+		static const auto connectToFirstPush = MetricsRegistry::histogram("websocket.connect_to_first_push_us");
+		std::string tournamentChan;
+		bool subscribed = false;
+
+		{
+			auto lock = this->lock();
+
+			tournamentChan = "/tournaments/" + std::to_string(this->_tournament->id);
+		}
+		while (true)
+			try {
+				auto data = this->_receiveWebSocketFrame();
+
+				if (!data)
+					return subscribed;
+
+				auto received = std::chrono::steady_clock::now();
+				TRACE_SCOPE("webSocketLoop");
+				nlohmann::json parsed;
+
+				{
+					TRACE_SCOPE("parse");
+
+					parsed = nlohmann::json::parse(*data);
+				}
+
+				frames.add();
+				frameBytes.add(data->size());
+
+				for (auto &elem : parsed) {
+					std::cout << "Received " << elem.dump(4) << std::endl;
+					std::string channel = elem["channel"];
+
+					if (channel == "/meta/subscribe" && !elem["successful"]) {
+						this->_emit({
+							EVENT_ERROR,
+							CHANNEL_WEBSOCKET,
+							LEVEL_ERROR,
+							"Websocket error",
+							"Cannot subscribe to tournament events:\n\n" + elem["error"].get<std::string>(),
+							{}
+						});
+						return false;
+					} else if (channel == "/meta/subscribe")
+						subscribed = true;
+					else if (channel == "/meta/connect")
+						this->_sendWebSocketMessage("/meta/connect", {{"connectionType", "websocket"}});
+					else if (channel == tournamentChan) {
+						std::vector<size_t> changed;
+
+						{
+							MetricsRegistry::Timer timer{applyTime};
+							TRACE_SCOPE("updateTournamentState");
+							auto lock = this->lock();
+
+							this->_updateTournamentState(elem["data"]["TournamentStore"], changed);
+						}
+						this->_emit({EVENT_MATCHES_CHANGED, CHANNEL_WEBSOCKET, LEVEL_OK, "", "", std::move(changed), received});
+						if (this->_wsock.connectStart) {
+							connectToFirstPush.recordSince(*this->_wsock.connectStart);
+							this->_wsock.connectStart.reset();
+						}
+					}
+				}
+			} catch (ConnectionTerminatedException &e) {
+				std::cerr << "Websocket disconnected: " << e.what() << std::endl;
+				return subscribed;
+			} catch (EOFException &e) {
+				// Interrupted on purpose when the tournament is forgotten
+				if (!this->getCurrentTournament().empty())
+					std::cerr << "Websocket error: " << Utils::getLastExceptionName() << ": " << e.what() << std::endl;
+				return subscribed;
+			} catch (std::exception &e) {
+				std::cerr << "Websocket error: " << Utils::getLastExceptionName() << ": " << e.what() << std::endl;
+				return subscribed;
+			}
+	}
+
+	std::optional<std::string> SyncEngine::_receiveWebSocketFrame()
+	{
+		if (this->_traffic.getMode() == TrafficLog::MODE_REPLAY) {
+			auto entry = this->_traffic.nextEntry(TrafficLog::KIND_WEBSOCKET_IN, "stream.challonge.com");
+
+			if (!entry)
+				return {};
+			return entry->data.get<std::string>();
+		}
+
+		auto frame = this->_wsock.socket.getAnswer();
+
+		this->_traffic.record(TrafficLog::KIND_WEBSOCKET_IN, "stream.challonge.com", frame);
+		return frame;
+	}
+
+	void SyncEngine::_connectWebSocket()
+	{
+		this->_wsock.socketThread = std::thread([this]{
+			float delay = 0;
+
+			Tracer::setThreadName("Websocket");
+			do {
+				bool subscribed = false;
+
+				try {
+					size_t id;
+
+					{
+						auto lock = this->lock();
+
+						id = this->_tournament->id;
+					}
+					this->_wsock.connectStart = MetricsRegistry::Clock::now();
+					this->_connectToWebSocket();
+					std::cout << "Subscribing to " << id << std::endl;
+					this->_sendWebSocketMessage(
+						"/meta/subscribe",
+						{
+							{"subscription", "/tournaments/" + std::to_string(id)}
+						}
+					);
+					subscribed = this->_webSocketLoop();
+
+					try {
+						this->_wsock.socket.disconnect();
+					} catch (...) {}
+				} catch (std::exception &e) {
+					std::cerr << "Websocket init error: " << Utils::getLastExceptionName() << ": " << e.what() << std::endl;
+				}
+				// A dropped subscription is resumed right away, but a server rejecting us isn't hammered
+				delay = subscribed ? 0 : std::clamp(delay * 2, minReconnectDelay, maxReconnectDelay);
+				if (delay) {
+					std::unique_lock<std::mutex> lock{this->_wsock.mutex};
+
+					std::cerr << "Reconnecting to the websocket in " << delay << "s" << std::endl;
+					// An expired address is looked up again while waiting instead of when connecting
+					if (this->_traffic.getMode() != TrafficLog::MODE_REPLAY)
+						Resolver::prefetch("stream.challonge.com", 8000);
+					this->_wsock.condition.wait_for(lock, std::chrono::duration<float>(delay), [this]{
+						return this->getCurrentTournament().empty();
+					});
+				}
+			} while (!this->getCurrentTournament().empty() && !(
+				// A replay has nothing to reconnect to once every recorded frame was received
+				this->_traffic.getMode() == TrafficLog::MODE_REPLAY &&
+				this->_traffic.isOver(TrafficLog::KIND_WEBSOCKET_IN, "stream.challonge.com")
+			));
+		});
+	}
+
+	void SyncEngine::_updateTournamentState(nlohmann::json wsockPayload, std::vector<size_t> &changed)
+	{
+		for (auto &round : wsockPayload["matches_by_round"].items()) {
+			for (auto &match : round.value()) {
+				try {
+					if (!match.contains("id") || match["id"].is_null())
+						continue;
+
+					auto it = this->_matches.find(match["id"]);
+
+					if (it != this->_matches.end()) {
+						auto &obj = it->second;
+
+						getFromJson(obj->_forfeited, "forfeited", match);
+						getFromJson(obj->_loserId, "loser_id", match);
+						getFromJson(obj->_winnerId, "winner_id", match);
+						getFromJson(obj->_player1Id, "id", match["player1"]);
+						getFromJson(obj->_player2Id, "id", match["player2"]);
+						getFromJson(obj->_state, "state", match);
+						getFromJson(obj->_scores, "scores", match);
+						changed.push_back(obj->getId());
+					} else {
+						std::cerr << match.dump(4) << " ignored" << std::endl;
+					}
+				} catch (std::exception &e) {
+					std::cerr << "Error updating match " << match << std::endl;
+					std::cerr << e.what() << std::endl;
+				}
+			}
+		}
+		for (auto &elem : wsockPayload["groups"])
+			this->_updateTournamentState(elem, changed);
+	}
+
+	void SyncEngine::_indexParticipants(const std::vector<std::shared_ptr<Participant>> &participants)
+	{
+		this->_participants.clear();
+		this->_challongeUNameToParticipant.clear();
+		for (auto &participant : participants) {
+			this->_participants[participant->getId()] = participant;
+			if (participant->getChallongeUsername())
+				this->_challongeUNameToParticipant[*participant->getChallongeUsername()] = participant;
+			for (auto &alt : participant->getGroupPlayerIds())
+				this->_participants[alt] = participant;
+		}
+	}
+
+	void SyncEngine::_populate(
+		const std::string &type,
+		size_t participantsCount,
+		const std::vector<std::shared_ptr<Participant>> &participants,
+		const std::vector<std::shared_ptr<Match>> &matches
+	)
+	{
+		auto lock = this->lock();
+
+		this->_matchesStates.clear();
+		this->_matches.clear();
+		this->_group.clear();
+		this->_bracket.type = type;
+		this->_bracket.elim.clear();
+		this->_bracket.robbin.clear();
+		this->_bracket.roundBounds.first = INT32_MAX;
+		this->_bracket.roundBounds.second = INT32_MIN;
+		this->_indexParticipants(participants);
+
+		std::cout << "Building round tree" << std::endl;
+		for (auto &match : matches) {
+			this->_matches[match->getId()] = match;
+			std::cout << match->getId() << std::endl;
+			std::cout << (match->getGroupId() ? std::to_string(*match->getGroupId()) : "None") << std::endl;
+			std::cout << match->getState() << std::endl;
+			std::cout << match->getRound() << ":" << match->getSuggestedPlayOrder() << std::endl << std::endl;
+			this->_insertMatch(match);
+		}
+
+		auto groupType = getGroupStageType(participantsCount, this->_group);
+
+		for (auto &elem : this->_group)
+			elem.second.type = groupType;
+	}
+
+	void SyncEngine::_insertMatch(const std::shared_ptr<Match> &match)
+	{
+		if (match->getGroupId())
+			addMatchToPool(match, this->_group);
+		else
+			addMatchToBracket(match, this->_bracket);
+	}
+
+	void SyncEngine::_removeMatch(const std::shared_ptr<Match> &match)
+	{
+		if (!match->getGroupId())
+			return removeMatchFromBracket(match, this->_bracket);
+
+		auto it = this->_group.find(*match->getGroupId());
+
+		if (it == this->_group.end())
+			return;
+		removeMatchFromBracket(match, it->second);
+		if (it->second.elim.empty())
+			this->_group.erase(it);
+	}
+
+	// Apply a freshly fetched tournament to the current brackets. Matches that are still there are updated in place,
+	// new ones are inserted in their round and missing ones are removed, so nothing is rebuilt from scratch.
+	// Returns whether the structure changed. changed is filled with every match to describe again.
+	bool SyncEngine::_merge(std::vector<size_t> &changed)
+	{
+		std::set<size_t> seen;
+		bool groupsChanged = false;
+		size_t added = 0;
+		size_t moved = 0;
+		size_t removed = 0;
+
+		this->_indexParticipants(this->_tournament->participants);
+		for (auto &match : this->_tournament->matches) {
+			auto it = this->_matches.find(match->getId());
+
+			seen.insert(match->getId());
+			changed.push_back(match->getId());
+			if (it == this->_matches.end()) {
+				this->_matches[match->getId()] = match;
+				this->_insertMatch(match);
+				groupsChanged |= match->getGroupId().has_value();
+				added++;
+				continue;
+			}
+
+			auto &existing = it->second;
+			bool relocated = existing->getRound() != match->getRound() || existing->getGroupId() != match->getGroupId();
+
+			if (relocated) {
+				groupsChanged |= existing->getGroupId() || match->getGroupId();
+				this->_removeMatch(existing);
+				moved++;
+			}
+			*existing = *match;
+			if (relocated)
+				this->_insertMatch(existing);
+		}
+		for (auto it = this->_matches.begin(); it != this->_matches.end();) {
+			if (seen.count(it->first)) {
+				it++;
+				continue;
+			}
+			groupsChanged |= it->second->getGroupId().has_value();
+			this->_removeMatch(it->second);
+			this->_matchesStates.erase(it->first);
+			it = this->_matches.erase(it);
+			removed++;
+		}
+		if (groupsChanged) {
+			auto groupType = getGroupStageType(this->_tournament->participantsCount, this->_group);
+
+			for (auto &elem : this->_group)
+				elem.second.type = groupType;
+		}
+		if (added || moved || removed)
+			std::cout << "Tournament structure changed: " << added << " match(es) added, " << moved << " moved, " << removed << " removed" << std::endl;
+		return added || moved || removed;
+	}
+
+	bool SyncEngine::_konniHostIsChallongeMatch(const Match &match, const KonniMatch &host)
+	{
+		auto hostP   = this->_challongeUNameToParticipant[host.hostChallonge]   ?: this->_participants[this->_discordHostToParticipant[host.hostName]];
+		auto clientP = this->_challongeUNameToParticipant[host.clientChallonge] ?: this->_participants[this->_discordHostToParticipant[host.clientName]];
+		auto p1      = this->_participants[*match.getPlayer1Id()];
+		auto p2      = this->_participants[*match.getPlayer2Id()];
+
+		return (p1 == hostP || p2 == hostP) && (!host.gameStarted || p1 == clientP || p2 == clientP || host.clientChallonge.empty());
+	}
+
+	bool SyncEngine::_matchKonniHost(const Match &match, const KonniMatch &host, const std::map<size_t, KonniMatch> &old)
+	{
+		auto it = old.find(match.getId());
+
+		if (match.getState() != "open")
+			return false;
+		if (it != old.end() && it->second.hostChallonge == host.hostChallonge && !it->second.expired) {
+			this->_matchesStates[match.getId()] = host;
+			return true;
+		}
+		if (!match.getPlayer1Id() && !match.getPlayer2Id())
+			return false;
+		if (!this->_konniHostIsChallongeMatch(match, host))
+			return false;
+
+		this->_matchesStates[match.getId()] = host;
+		return true;
+	}
+
+	bool SyncEngine::_matchKonniHostInBracket(const Bracket &bracket, const KonniMatch &host, const std::map<size_t, KonniMatch> &old)
+	{
+		for (auto &round : bracket.elim)
+			for (auto &match : round.second)
+				if (this->_matchKonniHost(*match, host, old))
+					return true;
+		return false;
+	}
+
+	std::vector<size_t> SyncEngine::_matchKonniHosts(const std::vector<KonniMatch> &hosts)
+	{
+		auto previous = this->_matchesStates;
+		auto oldStates = previous;
+		std::vector<size_t> changed;
+		bool v = false;
+
+		this->_matchesStates.clear();
+		for (auto &elem : oldStates)
+			elem.second.expired = true;
+		for (auto &elem : oldStates)
+			if (this->_matches[elem.first]->getState() == "open")
+				this->_matchesStates.emplace(elem);
+
+		if (this->_bracket.elim.empty() && this->_bracket.robbin.empty()) {
+			for (auto &host : hosts) {
+				v = false;
+				for (auto &bracket : this->_group) {
+					v |= this->_matchKonniHostInBracket(bracket.second, host, oldStates);
+					if (v)
+						break;
+				}
+				if (!v)
+					std::cerr << "Error: Cannot find match for (group) host " << host.hostChallonge << std::endl;
+			}
+		} else
+			for (auto &host : hosts)
+				if (!this->_matchKonniHostInBracket(this->_bracket, host, oldStates))
+					std::cerr << "Error: Cannot find match for host " << host.hostChallonge << std::endl;
+
+		for (auto &elem : previous) {
+			auto it = this->_matchesStates.find(elem.first);
+
+			if (it == this->_matchesStates.end() || !isSameHost(it->second, elem.second))
+				changed.push_back(elem.first);
+		}
+		for (auto &elem : this->_matchesStates)
+			if (!previous.count(elem.first))
+				changed.push_back(elem.first);
+		return changed;
+	}
+
+	std::string SyncEngine::getRoundName(const Bracket &bracket, int roundNumber, bool isGroup) const
+	{
+		auto config = this->getConfig();
+
+		if (isGroup)
+			return config.roundNames.at("pool");
+
+		std::string front = (roundNumber < 0 ? "l" : "");
+		std::string realId = front + std::to_string(std::abs(roundNumber));
+		std::string altId = front + std::to_string(std::abs(roundNumber) - std::abs(roundNumber < 0 ? bracket.roundBounds.first : bracket.roundBounds.second) - 1);
+		auto realIt = config.roundNames.find(realId);
+		auto altIt = config.roundNames.find(altId);
+
+		if (altIt != config.roundNames.end())
+			return altIt->second;
+		if (realIt != config.roundNames.end())
+			return realIt->second;
+
+		auto v = config.roundNames[front + "round"];
+		auto pos = v.find("{}");
+
+		if (pos == std::string::npos)
+			return v;
+		return v.replace(pos, pos + 2, std::to_string(std::abs(roundNumber)));
+	}
+
+	bool SyncEngine::joinMatch(size_t matchId)
+	{
+		auto promise = std::make_shared<std::promise<bool>>();
+		auto future = promise->get_future();
+
+		this->joinMatchAsync(matchId, [promise](bool joined){
+			promise->set_value(joined);
+		});
+		return future.get();
+	}
+
+	void SyncEngine::joinMatchAsync(size_t matchId, const std::function<void (bool joined)> &callback)
+	{
+		std::shared_ptr<Participant> participant1;
+		std::shared_ptr<Participant> participant2;
+		std::string roundName;
+		KonniMatch host;
+
+		{
+			auto lock = this->lock();
+			auto match = this->getMatch(matchId);
+			auto hostIt = this->_matchesStates.find(matchId);
+
+			if (!match || hostIt == this->_matchesStates.end()) {
+				if (callback)
+					callback(false);
+				return;
+			}
+			host = hostIt->second;
+			if (match->getPlayer1Id())
+				participant1 = this->getParticipant(*match->getPlayer1Id());
+			if (match->getPlayer2Id())
+				participant2 = this->getParticipant(*match->getPlayer2Id());
+			if (match->getGroupId())
+				roundName = this->getRoundName(this->_group[*match->getGroupId()], match->getRound(), true);
+			else
+				roundName = this->getRoundName(this->_bracket, match->getRound(), false);
+		}
+
+		if (!participant1 || !participant2) {
+			this->_emit({
+				EVENT_ERROR,
+				CHANNEL_SOKUSTREAMING,
+				LEVEL_ERROR,
+				"Connect error",
+				"Cannot connect to a match that doesn't have 2 participants.\nThis is a bug. Please report this to the tool developer.",
+				{}
+			});
+			if (callback)
+				callback(false);
+			return;
+		}
+
+		SokuStreamingClient::Request request;
+
+		request.leftName  = (participant1->getUsername() == host.hostChallonge ? participant1 : participant2)->getDisplayName();
+		request.rightName = (participant1->getUsername() == host.hostChallonge ? participant2 : participant1)->getDisplayName();
+		request.roundName = roundName;
+		request.ip = host.ip;
+		request.port = host.port;
+		this->_sokuStreaming.join(request, [this, callback](const SokuStreamingClient::Result &result){
+			this->_reportJoin(result);
+			if (callback)
+				callback(result.success);
+		});
+	}
+
+	void SyncEngine::_reportJoin(const SokuStreamingClient::Result &result)
+	{
+		if (result.success)
+			return;
+		if (!result.error.empty()) {
+			this->_emit({EVENT_ERROR, CHANNEL_SOKUSTREAMING, LEVEL_ERROR, "Connect error", "Cannot reach SokuStreaming: " + result.error, {}});
+			std::cerr << "SokuStreaming: " << result.error << std::endl;
+			return;
+		}
+		if (result.stateCode / 100 != 2) {
+			this->_emit({EVENT_ERROR, CHANNEL_SOKUSTREAMING, LEVEL_ERROR, "State error", "Cannot set state: " + std::to_string(result.stateCode) + " " + result.stateCodeName + "\nThis is a bug. Please report this to the tool developer.", {}});
+			std::cerr << "SokuStreaming: POST /state returned " << result.stateCode << " " << result.stateCodeName << std::endl;
+			return;
+		}
+		if (result.connectCode == 503) {
+			this->_emit({EVENT_ERROR, CHANNEL_SOKUSTREAMING, LEVEL_ERROR, "Connect error", "Cannot connect to host: " + std::to_string(result.connectCode) + " " + result.connectCodeName + "\nPlease stop connecting/hosting before trying to connect.", {}});
+			return;
+		}
+		this->_emit({EVENT_ERROR, CHANNEL_SOKUSTREAMING, LEVEL_ERROR, "Connect error", "Cannot connect to host: " + std::to_string(result.connectCode) + " " + result.connectCodeName + "\nThis is a bug. Please report this to the tool developer.", {}});
+		std::cerr << "SokuStreaming: POST /connect returned " << result.connectCode << " " << result.connectCodeName << std::endl;
+	}
+
+	std::unique_lock<std::recursive_mutex> SyncEngine::lock() const
+	{
+		return std::unique_lock<std::recursive_mutex>{this->_mutex};
+	}
+
+	std::string SyncEngine::getCurrentTournament() const
+	{
+		auto lock = this->lock();
+
+		return this->_currentTournament;
+	}
+
+	std::shared_ptr<TournamentSnapshot> SyncEngine::getTournament() const
+	{
+		auto lock = this->lock();
+
+		return this->_tournament;
+	}
+
+	TrafficLog &SyncEngine::getTrafficLog()
+	{
+		return this->_traffic;
+	}
+
+	const std::map<size_t, std::shared_ptr<Match>> &SyncEngine::getMatches() const
+	{
+		return this->_matches;
+	}
+
+	std::shared_ptr<Match> SyncEngine::getMatch(size_t id) const
+	{
+		auto it = this->_matches.find(id);
+
+		if (it == this->_matches.end())
+			return nullptr;
+		return it->second;
+	}
+
+	std::shared_ptr<Participant> SyncEngine::getParticipant(size_t id) const
+	{
+		auto it = this->_participants.find(id);
+
+		if (it == this->_participants.end())
+			return nullptr;
+		return it->second;
+	}
+
+	const std::map<size_t, KonniMatch> &SyncEngine::getHosts() const
+	{
+		return this->_matchesStates;
+	}
+
+	const Pool &SyncEngine::getGroup() const
+	{
+		return this->_group;
+	}
+
+	const Bracket &SyncEngine::getBracket() const
+	{
+		return this->_bracket;
+	}
+
+	nlohmann::json SyncEngine::toJson() const
+	{
+		auto lock = this->lock();
+		nlohmann::json result;
+		nlohmann::json matches = nlohmann::json::array();
+		auto side = [this](const std::optional<size_t> &playerId, std::optional<int> score) -> nlohmann::json {
+			auto participant = playerId ? this->getParticipant(*playerId) : nullptr;
+
+			if (!playerId)
+				return nullptr;
+			return {
+				{"id", *playerId},
+				{"name", participant ? nlohmann::json(participant->getDisplayName()) : nlohmann::json(nullptr)},
+				{"score", score ? nlohmann::json(*score) : nlohmann::json(nullptr)},
+			};
+		};
+
+		result["url"] = this->_currentTournament;
+		result["tournament"] = nullptr;
+		if (this->_tournament)
+			result["tournament"] = {
+				{"id", this->_tournament->id},
+				{"name", this->_tournament->name},
+				{"type", this->_tournament->type},
+				{"game", this->_tournament->gameName},
+			};
+		for (auto &elem : this->_matches) {
+			auto &match = *elem.second;
+			auto &scores = match.getScores();
+			auto hostIt = this->_matchesStates.find(elem.first);
+			auto groupIt = match.getGroupId() ? this->_group.find(*match.getGroupId()) : this->_group.end();
+			auto &bracket = groupIt == this->_group.end() ? this->_bracket : groupIt->second;
+			nlohmann::json value{
+				{"id", match.getId()},
+				{"identifier", match.getSuggestedPlayOrder()},
+				{"round", match.getRound()},
+				{"roundName", this->getRoundName(bracket, match.getRound(), groupIt != this->_group.end())},
+				{"group", match.getGroupId() ? nlohmann::json(*match.getGroupId()) : nlohmann::json(nullptr)},
+				{"state", match.getState()},
+				{"player1", side(match.getPlayer1Id(), scores ? std::optional<int>(scores->first) : std::nullopt)},
+				{"player2", side(match.getPlayer2Id(), scores ? std::optional<int>(scores->second) : std::nullopt)},
+				{"winner", match.getWinnerId() ? nlohmann::json(*match.getWinnerId()) : nlohmann::json(nullptr)},
+				{"host", nullptr},
+			};
+
+			if (hostIt != this->_matchesStates.end()) {
+				auto &host = hostIt->second;
+
+				value["host"] = {
+					{"host", host.hostName},
+					{"client", host.clientName},
+					{"ip", host.ip},
+					{"port", host.port},
+					{"started", host.gameStarted},
+					{"expired", host.expired},
+					{"spectators", host.spectators},
+				};
+			}
+			matches.push_back(value);
+		}
+		result["matches"] = matches;
+		return result;
+	}
+
+	nlohmann::json SyncEngine::eventToJson(const Event &event)
+	{
+		return {
+			{"type", eventTypeStrings[event.type]},
+			{"channel", channelStrings[event.channel]},
+			{"level", levelStrings[event.level]},
+			{"title", event.title},
+			{"message", event.message},
+			{"matches", event.matchIds},
+		};
+	}
+}
@@ -0,0 +1,256 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_SYNCENGINE_HPP
+#define CHALLONGESOKU_SYNCENGINE_HPP
+
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <condition_variable>
+#include <json.hpp>
+#include <Client.hpp>
+#include <Exceptions.hpp>
+#include "Bracket.hpp"
+#include "KonniClient.hpp"
+#include "RefreshScheduler.hpp"
+#include "SecuredWebSocket.hpp"
+#include "SokuStreamingClient.hpp"
+#include "TaskPool.hpp"
+#include "TournamentSnapshot.hpp"
+#include "TrafficLog.hpp"
+
+namespace ChallongeSoku
+{
+	//! @brief Keeps a tournament in sync with Challonge, Konni and SokuStreaming, without any window.
+	//! @details Tournaments are loaded from their snapshot first, then from Challonge, and followed through the
+	//! Challonge websocket. Challonge and Konni are polled when the RefreshScheduler says so, and Konni hosts are
+	//! matched with Challonge matches. Clients (the GUI, the headless runner) learn what happened through events,
+	//! which are emitted from the engine's threads and never while the tournament data is locked.
+	class SyncEngine {
+	public:
+		struct Config {
+			std::string apikey;
+			std::string username;
+			std::string sshost = "localhost";
+			unsigned short ssport = 80;
+			float sokuStreamingTimeout = SokuStreamingClient::defaultTimeout;
+			std::string konniHost = "delthas.fr";
+			unsigned short konniPort = 14762;
+			float refreshRate = 10;
+			std::map<std::string, std::string> roundNames = {
+				{"round", "Round {}"},
+				{"-1", "Grand final"},
+				{"-2", "Final"},
+				{"-3", "Demi-final"},
+				{"lround", "Loser round {}"},
+				{"l-2", "Loser demi-final"},
+				{"l-1", "Loser final"},
+				{"pool", "Pool"},
+			};
+
+			//! @brief Read the keys the engine cares about from the content of settings.json.
+			//! @throw nlohmann::json::type_error value isn't an object or a key has the wrong type.
+			void	load(const nlohmann::json &value);
+		};
+
+		enum EventType {
+			//! @brief A tournament started loading. message is its URL.
+			EVENT_LOADING,
+			//! @brief The tournament was loaded from its snapshot. title is its name.
+			EVENT_SNAPSHOT_LOADED,
+			//! @brief The tournament was fetched from Challonge and is now followed. title is its name.
+			EVENT_LOADED,
+			EVENT_LOAD_FAILED,
+			//! @brief Matches were added, moved or removed. matchIds are all the matches to describe again.
+			EVENT_STRUCTURE_CHANGED,
+			//! @brief Some matches were updated in place.
+			EVENT_MATCHES_CHANGED,
+			//! @brief Which Konni game is hosted on some matches changed. matchIds are those matches.
+			EVENT_HOSTS_CHANGED,
+			//! @brief How talking to a service went. An empty message clears the previous one.
+			EVENT_STATUS,
+			//! @brief Something the user should be told about, in a message box if there is a GUI.
+			EVENT_ERROR,
+			//! @brief A refresh is over, the next one is scheduled.
+			EVENT_REFRESHED,
+			//! @brief The AutoDirector switched matches or couldn't.
+			EVENT_DIRECTOR,
+		};
+
+		enum Channel {
+			CHANNEL_SOKUSTREAMING,
+			CHANNEL_CHALLONGE,
+			CHANNEL_KONNI,
+			CHANNEL_WEBSOCKET,
+		};
+
+		enum Level {
+			LEVEL_OK,
+			LEVEL_WARNING,
+			LEVEL_ERROR,
+		};
+
+		struct Event {
+			EventType type;
+			Channel channel = CHANNEL_CHALLONGE;
+			Level level = LEVEL_OK;
+			std::string title;
+			std::string message;
+			std::vector<size_t> matchIds;
+			//! @brief When the websocket frame which caused the event was received, if it was one.
+			std::optional<std::chrono::steady_clock::time_point> received;
+		};
+
+		typedef std::function<void (const Event &event)> Listener;
+
+		static const char * const eventTypeStrings[];
+		static const char * const channelStrings[];
+		static const char * const levelStrings[];
+
+		//! @brief Seconds before reconnecting the websocket after a failed handshake or subscription, doubled after each other one.
+		static constexpr float minReconnectDelay = 0.5;
+		static constexpr float maxReconnectDelay = 30;
+
+		SyncEngine() = default;
+		~SyncEngine();
+
+		void	setConfig(const Config &config);
+		Config	getConfig() const;
+		//! @brief Listeners must be added before anything is started.
+		void	addListener(const Listener &listener);
+		//! @brief Start refreshing SokuStreaming, Challonge and Konni on the scheduler's rhythm.
+		void	start();
+		//! @brief Stop every thread and forget the current tournament.
+		void	stop();
+		//! @brief Forget the current tournament and load another one in the background.
+		void	load(const std::string &url);
+		//! @brief Have SokuStreaming spectate the host matched with a match. Blocks until it answered.
+		//! @return false if the match isn't hosted or SokuStreaming refused. The reason is emitted as an EVENT_ERROR.
+		bool	joinMatch(size_t matchId);
+		//! @brief Same as joinMatch, but returns right away.
+		//! @details The callback is called once SokuStreaming answered, from the SokuStreaming client's thread,
+		//! or right away if the match cannot be joined.
+		void	joinMatchAsync(size_t matchId, const std::function<void (bool joined)> &callback);
+		//! @brief Emit an event on behalf of something built on top of the engine.
+		void	post(const Event &event);
+		std::string getRoundName(const Bracket &bracket, int roundNumber, bool isGroup = false) const;
+		float	getTimeUntilRefresh() const;
+		bool	isRefreshing() const;
+		RefreshScheduler::Metrics getSchedulerMetrics() const;
+		//! @brief Start recording or replaying with it before anything is loaded.
+		TrafficLog &getTrafficLog();
+
+		//! @brief Everything below may be changed by the engine's threads at any time, so lock first.
+		std::unique_lock<std::recursive_mutex> lock() const;
+		std::string getCurrentTournament() const;
+		std::shared_ptr<TournamentSnapshot> getTournament() const;
+		const std::map<size_t, std::shared_ptr<ChallongeAPI::Match>> &getMatches() const;
+		std::shared_ptr<ChallongeAPI::Match> getMatch(size_t id) const;
+		std::shared_ptr<ChallongeAPI::Participant> getParticipant(size_t id) const;
+		const std::map<size_t, KonniMatch> &getHosts() const;
+		const Pool &getGroup() const;
+		const Bracket &getBracket() const;
+		//! @brief Everything about the current tournament, as served by the local API.
+		nlohmann::json toJson() const;
+
+		static nlohmann::json eventToJson(const Event &event);
+
+	private:
+		struct ChallongeWSock {
+			SecuredWebSocket socket;
+			std::string clientId;
+			std::string id = "1";
+			// Not a TaskPool task: it is blocked reading the websocket for as long as it is connected
+			std::thread socketThread;
+			//! @brief When the last connection started, until the first push is received.
+			std::optional<std::chrono::steady_clock::time_point> connectStart;
+			//! @brief Wakes the socket thread waiting to reconnect once the tournament is forgotten.
+			std::mutex mutex;
+			std::condition_variable condition;
+		};
+
+		mutable std::mutex _configMutex;
+		Config _config;
+		std::vector<Listener> _listeners;
+
+		mutable std::recursive_mutex _mutex;
+		std::string _currentTournament;
+		std::shared_ptr<TournamentSnapshot> _tournament;
+		std::map<size_t, std::shared_ptr<ChallongeAPI::Match>> _matches;
+		std::map<size_t, std::shared_ptr<ChallongeAPI::Participant>> _participants;
+		std::map<std::string, std::shared_ptr<ChallongeAPI::Participant>> _challongeUNameToParticipant;
+		std::map<std::string, size_t> _discordHostToParticipant;
+		std::map<size_t, KonniMatch> _matchesStates;
+		Pool _group;
+		Bracket _bracket{"", {}, {}, {INT32_MAX, INT32_MIN}, nullptr};
+
+		ChallongeAPI::Client _client{"", ""};
+		TrafficLog _traffic;
+		KonniClient _konni;
+		RefreshScheduler _scheduler;
+		ChallongeWSock _wsock;
+		TaskQueue _loadQueue{"load"};
+		// Not a TaskPool task: it waits for the scheduler's interval between refreshes for the whole session,
+		// and the pool has no timers, so it would hold a worker anyway.
+		std::thread _refreshThread;
+		mutable std::mutex _refreshMutex;
+		std::condition_variable _refreshCondition;
+		std::chrono::steady_clock::time_point _lastRefresh = std::chrono::steady_clock::now();
+		std::atomic<bool> _running{false};
+		std::atomic<bool> _refreshing{false};
+		// Last so its joins are over before anything their callbacks may use is destroyed
+		SokuStreamingClient _sokuStreaming;
+
+		void	_emit(const Event &event);
+		void	_disconnectWebSocket();
+		void	_load(const std::string &url);
+		std::shared_ptr<TournamentSnapshot> _fetchTournament(const std::string &url);
+		void	_refreshLoop();
+		void	_refresh();
+		void	_checkSokuStreaming();
+		void	_reportJoin(const SokuStreamingClient::Result &result);
+		bool	_refreshChallonge(std::optional<float> &retryAfter);
+		bool	_refreshKonni(std::optional<float> &retryAfter, bool firstMatches);
+		void	_scheduleNextRefresh(bool failed, std::optional<float> retryAfter);
+		RefreshScheduler::Activity _getTournamentActivity() const;
+		void	_saveSnapshot(const std::string &url);
+
+		void	_sendWebSocketMessage(const std::string &channel, nlohmann::json value);
+		void	_connectToWebSocket();
+		void	_connectWebSocket();
+		//! @return Whether the subscription was accepted.
+		bool	_webSocketLoop();
+		std::optional<std::string> _receiveWebSocketFrame();
+		void	_updateTournamentState(nlohmann::json wsockPayload, std::vector<size_t> &changed);
+
+		void	_indexParticipants(const std::vector<std::shared_ptr<ChallongeAPI::Participant>> &participants);
+		void	_populate(
+			const std::string &type,
+			size_t participantsCount,
+			const std::vector<std::shared_ptr<ChallongeAPI::Participant>> &participants,
+			const std::vector<std::shared_ptr<ChallongeAPI::Match>> &matches
+		);
+		bool	_merge(std::vector<size_t> &changed);
+		void	_insertMatch(const std::shared_ptr<ChallongeAPI::Match> &match);
+		void	_removeMatch(const std::shared_ptr<ChallongeAPI::Match> &match);
+
+		bool	_konniHostIsChallongeMatch(const ChallongeAPI::Match &match, const KonniMatch &host);
+		bool	_matchKonniHost(const ChallongeAPI::Match &match, const KonniMatch &host, const std::map<size_t, KonniMatch> &old);
+		bool	_matchKonniHostInBracket(const Bracket &bracket, const KonniMatch &host, const std::map<size_t, KonniMatch> &old);
+		std::vector<size_t> _matchKonniHosts(const std::vector<KonniMatch> &hosts);
+	};
+}
+
+
+#endif //CHALLONGESOKU_SYNCENGINE_HPP
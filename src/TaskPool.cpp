@@ -0,0 +1,299 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <deque>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+#include "TaskPool.hpp"
+#include "MetricsRegistry.hpp"
+#include "Tracer.hpp"
+
+namespace ChallongeSoku
+{
+	struct Job {
+		const char *name;
+		TaskPool::Task task;
+		CancellationToken token;
+		MetricsRegistry::Clock::time_point posted;
+		// Called instead of the task when it won't run
+		TaskPool::Task dropped;
+	};
+
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	struct WorkerPool {
+		std::mutex mutex;
+		std::condition_variable condition;
+		// Read by the workers between jobs, without the lock
+		std::atomic<bool> stopping{false};
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::vector<std::thread> threads;
+		std::atomic<size_t> pending{0};
+		std::atomic<size_t> next{0};
+	};
+
+	// Index of the worker running on this thread
+	static thread_local std::optional<size_t> currentWorker;
+
+	static WorkerPool &getPool()
+	{
+		static WorkerPool pool;
+
+		return pool;
+	}
+
+	bool CancellationToken::isCancelled() const
+	{
+		return this->_cancelled && this->_cancelled->load(std::memory_order_relaxed);
+	}
+
+	CancellationToken CancellationSource::getToken() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		CancellationToken token;
+
+		token._cancelled = this->_cancelled;
+		return token;
+	}
+
+	void CancellationSource::cancel()
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_cancelled->store(true, std::memory_order_relaxed);
+		this->_cancelled = std::make_shared<std::atomic<bool>>(false);
+	}
+
+	static std::optional<Job> takeJob(WorkerPool &pool, size_t index)
+	{
+		static const auto stolen = MetricsRegistry::counter("tasks.stolen");
+		auto count = pool.workers.size();
+
+		for (size_t i = 0; i < count; i++) {
+			auto &worker = *pool.workers[(index + i) % count];
+			std::unique_lock<std::mutex> lock{worker.mutex};
+
+			if (worker.jobs.empty())
+				continue;
+
+			// Own jobs are taken from the front, stolen ones from the back
+			auto job = std::move(i ? worker.jobs.back() : worker.jobs.front());
+
+			if (i) {
+				worker.jobs.pop_back();
+				stolen.add();
+			} else
+				worker.jobs.pop_front();
+			pool.pending--;
+			return job;
+		}
+		return {};
+	}
+
+	static void workerLoop(WorkerPool &pool, size_t index)
+	{
+		static const auto waitTime = MetricsRegistry::histogram("tasks.wait_us");
+		static const auto runTime = MetricsRegistry::histogram("tasks.run_us");
+		static const auto cancelled = MetricsRegistry::counter("tasks.cancelled");
+
+		currentWorker = index;
+		Tracer::setThreadName("Worker " + std::to_string(index + 1));
+		// Once stopping, the jobs left are dropped by stop instead
+		while (!pool.stopping) {
+			auto job = takeJob(pool, index);
+
+			if (!job) {
+				std::unique_lock<std::mutex> lock{pool.mutex};
+
+				pool.condition.wait(lock, [&pool]{
+					return pool.stopping || pool.pending;
+				});
+				continue;
+			}
+			waitTime.recordSince(job->posted);
+			if (job->token.isCancelled()) {
+				cancelled.add();
+				if (job->dropped)
+					job->dropped();
+				continue;
+			}
+			try {
+				MetricsRegistry::Timer timer{runTime};
+				TraceSpan span{job->name};
+
+				job->task();
+			} catch (std::exception &e) {
+				std::cerr << job->name << ": " << e.what() << std::endl;
+			}
+		}
+	}
+
+	size_t TaskPool::getWorkerCount()
+	{
+		return std::max(minWorkers, std::thread::hardware_concurrency());
+	}
+
+	bool TaskPool::post(const char *name, const Task &task, const CancellationToken &token)
+	{
+		return _post(name, task, token, nullptr);
+	}
+
+	bool TaskPool::_post(const char *name, const Task &task, const CancellationToken &token, const Task &dropped)
+	{
+		auto &pool = getPool();
+		std::unique_lock<std::mutex> lock{pool.mutex};
+
+		if (pool.stopping)
+			return false;
+		if (pool.threads.empty()) {
+			for (size_t i = 0; i < getWorkerCount(); i++)
+				pool.workers.push_back(std::make_unique<Worker>());
+			for (size_t i = 0; i < pool.workers.size(); i++)
+				pool.threads.emplace_back(workerLoop, std::ref(pool), i);
+		}
+
+		// Held until the job is queued, so stop can't miss it
+		auto index = currentWorker.value_or(pool.next++ % pool.workers.size());
+		auto &worker = *pool.workers[index];
+		Job job{name, task, token, MetricsRegistry::Clock::now(), dropped};
+
+		{
+			std::unique_lock<std::mutex> workerLock{worker.mutex};
+
+			// A worker posting a follow up to its own task likely runs it next, while its data is still in cache
+			if (currentWorker)
+				worker.jobs.push_front(std::move(job));
+			else
+				worker.jobs.push_back(std::move(job));
+		}
+		pool.pending++;
+		lock.unlock();
+		pool.condition.notify_one();
+		return true;
+	}
+
+	void TaskPool::stop()
+	{
+		auto &pool = getPool();
+		std::unique_lock<std::mutex> lock{pool.mutex};
+
+		pool.stopping = true;
+		lock.unlock();
+		pool.condition.notify_all();
+		for (auto &thread : pool.threads)
+			thread.join();
+		pool.threads.clear();
+		for (auto &worker : pool.workers)
+			for (auto &job : worker->jobs)
+				if (job.dropped)
+					job.dropped();
+		for (auto &worker : pool.workers)
+			worker->jobs.clear();
+		pool.pending = 0;
+	}
+
+	struct TaskQueue::Shared {
+		const char *name;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<std::pair<TaskPool::Task, CancellationToken>> tasks;
+		// A job running the next task is on the pool
+		bool scheduled = false;
+	};
+
+	TaskQueue::TaskQueue(const char *name) :
+		_shared(std::make_shared<Shared>())
+	{
+		this->_shared->name = name;
+	}
+
+	TaskQueue::~TaskQueue()
+	{
+		this->cancel();
+		this->wait();
+	}
+
+	void TaskQueue::post(const TaskPool::Task &task, const CancellationToken &token)
+	{
+		std::unique_lock<std::mutex> lock{this->_shared->mutex};
+
+		this->_shared->tasks.emplace_back(task, token);
+		if (this->_shared->scheduled)
+			return;
+		this->_shared->scheduled = true;
+		lock.unlock();
+
+		_schedule(this->_shared);
+	}
+
+	void TaskQueue::_schedule(const std::shared_ptr<Shared> &shared)
+	{
+		auto drop = [shared]{
+			std::unique_lock<std::mutex> lock{shared->mutex};
+			auto tasks = std::move(shared->tasks);
+
+			shared->tasks.clear();
+			shared->scheduled = false;
+			shared->condition.notify_all();
+			// What the tasks hold may do anything when destroyed
+			lock.unlock();
+		};
+
+		if (!TaskPool::_post(shared->name, [shared]{ _runNext(shared); }, {}, drop))
+			drop();
+	}
+
+	// Runs a single task, then posts itself again, so a busy queue doesn't hold a worker
+	void TaskQueue::_runNext(const std::shared_ptr<Shared> &shared)
+	{
+		std::unique_lock<std::mutex> lock{shared->mutex};
+
+		if (!shared->tasks.empty()) {
+			auto task = std::move(shared->tasks.front());
+
+			shared->tasks.pop_front();
+			lock.unlock();
+			try {
+				if (!task.second.isCancelled())
+					task.first();
+			} catch (std::exception &e) {
+				std::cerr << shared->name << ": " << e.what() << std::endl;
+			}
+			task.first = nullptr;
+			lock.lock();
+		}
+		if (!shared->tasks.empty()) {
+			lock.unlock();
+			return _schedule(shared);
+		}
+		shared->scheduled = false;
+		shared->condition.notify_all();
+	}
+
+	void TaskQueue::cancel()
+	{
+		std::unique_lock<std::mutex> lock{this->_shared->mutex};
+		auto tasks = std::move(this->_shared->tasks);
+
+		this->_shared->tasks.clear();
+		// What the tasks hold may do anything when destroyed
+		lock.unlock();
+	}
+
+	void TaskQueue::wait()
+	{
+		std::unique_lock<std::mutex> lock{this->_shared->mutex};
+
+		this->_shared->condition.wait(lock, [this]{
+			return !this->_shared->scheduled;
+		});
+	}
+}
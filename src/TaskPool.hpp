@@ -0,0 +1,98 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_TASKPOOL_HPP
+#define CHALLONGESOKU_TASKPOOL_HPP
+
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+namespace ChallongeSoku
+{
+	//! @brief Tells tasks that what they were started for is gone, like the tournament they were loading.
+	//! @details A default constructed token is never cancelled.
+	class CancellationToken {
+	public:
+		bool	isCancelled() const;
+
+	private:
+		std::shared_ptr<const std::atomic<bool>> _cancelled;
+
+		friend class CancellationSource;
+	};
+
+	class CancellationSource {
+	public:
+		CancellationToken getToken() const;
+		//! @brief Cancel every token given so far. The ones given afterwards are not.
+		void	cancel();
+
+	private:
+		mutable std::mutex _mutex;
+		std::shared_ptr<std::atomic<bool>> _cancelled = std::make_shared<std::atomic<bool>>(false);
+	};
+
+	//! @brief Process wide worker threads running short lived tasks, so updates don't create a thread each time.
+	//! @details Each worker has its own deque. Tasks posted from a worker go in front of its own deque,
+	//! the others are spread over the workers. Idle workers steal from the back of the others' deques.
+	//! Workers are started by the first post, and must be stopped before returning from main, as
+	//! the metrics and the tracer are gone after that. Loops running for the whole session (refresh,
+	//! websocket, status server, auto director) keep their own thread, they would hold a worker forever.
+	class TaskPool {
+	public:
+		typedef std::function<void ()> Task;
+
+		//! @brief Workers started, whatever the number of cores, as tasks mostly wait on the network.
+		static constexpr unsigned minWorkers = 4;
+
+		//! @brief Run a task on a worker, unless the token is cancelled by then.
+		//! @param name Shown in traces, must be a string literal.
+		//! @return false if the pool was stopped, then the task is dropped.
+		static bool	post(const char *name, const Task &task, const CancellationToken &token = {});
+		//! @brief Wait for the running tasks, drop the others and join the workers.
+		//! @details Tasks posted afterwards are dropped as well, TaskQueues included, so those posting themselves
+		//! again don't keep the workers running.
+		static void	stop();
+		static size_t	getWorkerCount();
+
+	private:
+		//! @param dropped Called instead of the task if it is cancelled or the pool stops before it runs.
+		static bool	_post(const char *name, const Task &task, const CancellationToken &token, const Task &dropped);
+
+		friend class TaskQueue;
+	};
+
+	//! @brief Named queue of tasks run on the TaskPool one after the other, in the order they were posted.
+	//! @details Tasks of different queues run in parallel. Destroying a queue drops its pending tasks and
+	//! waits for the running one, so tasks may use whatever the queue's owner holds.
+	class TaskQueue {
+	public:
+		//! @param name Shown in traces, must be a string literal.
+		TaskQueue(const char *name);
+		~TaskQueue();
+
+		TaskQueue(const TaskQueue &) = delete;
+		TaskQueue &operator=(const TaskQueue &) = delete;
+
+		void	post(const TaskPool::Task &task, const CancellationToken &token = {});
+		//! @brief Drop the tasks which didn't start yet.
+		void	cancel();
+		//! @brief Wait until every task posted so far ran, or was dropped.
+		void	wait();
+
+	private:
+		struct Shared;
+
+		std::shared_ptr<Shared> _shared;
+
+		static void	_schedule(const std::shared_ptr<Shared> &shared);
+		static void	_runNext(const std::shared_ptr<Shared> &shared);
+	};
+}
+
+
+#endif //CHALLONGESOKU_TASKPOOL_HPP
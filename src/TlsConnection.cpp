@@ -0,0 +1,301 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <wincrypt.h>
+#define closeSocket closesocket
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#define closeSocket close
+#endif
+#include <map>
+#include <deque>
+#include <mutex>
+#include <climits>
+#include <algorithm>
+#include <openssl/err.h>
+#include <Exceptions.hpp>
+#include "TlsConnection.hpp"
+#include "MetricsRegistry.hpp"
+#include "Resolver.hpp"
+#include "Tracer.hpp"
+
+using namespace ChallongeAPI;
+
+namespace ChallongeSoku
+{
+#ifdef _WIN32
+	// OpenSSL doesn't look into the Windows certificate store, so its root certificates are given to it
+	static void addSystemCertificates(X509_STORE *store)
+	{
+		auto system = CertOpenSystemStoreA(0, "ROOT");
+		PCCERT_CONTEXT certificate = nullptr;
+
+		if (!system)
+			return;
+		while ((certificate = CertEnumCertificatesInStore(system, certificate))) {
+			auto data = static_cast<const unsigned char *>(certificate->pbCertEncoded);
+			auto x509 = d2i_X509(nullptr, &data, certificate->cbCertEncoded);
+
+			if (!x509)
+				continue;
+			X509_STORE_add_cert(store, x509);
+			X509_free(x509);
+		}
+		CertCloseStore(system, 0);
+	}
+#endif
+
+	struct SessionCache {
+		std::mutex mutex;
+		SSL_CTX *context;
+		// Keyed by host:port, newest last
+		std::map<std::string, std::deque<SSL_SESSION *>> sessions;
+
+		SessionCache()
+		{
+			this->context = SSL_CTX_new(TLS_client_method());
+			SSL_CTX_set_verify(this->context, SSL_VERIFY_PEER, nullptr);
+			SSL_CTX_set_default_verify_paths(this->context);
+#ifdef _WIN32
+			addSystemCertificates(SSL_CTX_get_cert_store(this->context));
+#endif
+			// Sessions are only kept here, the context's own cache is for servers
+			SSL_CTX_set_session_cache_mode(this->context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+			SSL_CTX_sess_set_new_cb(this->context, TlsConnection::_onNewSession);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+			// Servers often close the connection without a close_notify once their answer is sent
+			SSL_CTX_set_options(this->context, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+		}
+
+		~SessionCache()
+		{
+			for (auto &host : this->sessions)
+				for (auto session : host.second)
+					SSL_SESSION_free(session);
+			SSL_CTX_free(this->context);
+		}
+	};
+
+	static SessionCache &getCache()
+	{
+		static SessionCache cache;
+
+		return cache;
+	}
+
+	static std::string getErrorString()
+	{
+		auto error = ERR_get_error();
+		char buffer[256];
+
+		if (!error)
+			return "connection closed";
+		ERR_error_string_n(error, buffer, sizeof(buffer));
+		return buffer;
+	}
+
+	TlsConnection::TlsConnection()
+	{
+#ifdef _WIN32
+		WSADATA data;
+
+		WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+	}
+
+	TlsConnection::~TlsConnection()
+	{
+		this->disconnect();
+	}
+
+	void TlsConnection::connect(const std::string &host, unsigned short portno)
+	{
+		static const auto resumed = MetricsRegistry::counter("tls.resumed_handshakes");
+		static const auto full = MetricsRegistry::counter("tls.full_handshakes");
+		TRACE_SCOPE("TlsConnection::connect");
+		auto &cache = getCache();
+		auto deadline = Resolver::Clock::now() + std::chrono::duration_cast<Resolver::Clock::duration>(std::chrono::duration<float>(connectTimeout));
+
+		this->disconnect();
+		ERR_clear_error();
+		try {
+			this->_socket = Resolver::connect(host, portno, deadline);
+		} catch (std::runtime_error &e) {
+			throw NetworkException(e.what());
+		}
+		// OpenSSL is used in blocking mode
+#ifdef _WIN32
+		u_long disable = 0;
+
+		ioctlsocket(this->_socket, FIONBIO, &disable);
+#else
+		fcntl(this->_socket, F_SETFL, fcntl(this->_socket, F_GETFL, 0) & ~O_NONBLOCK);
+#endif
+
+		this->_key = host + ":" + std::to_string(portno);
+		this->_ssl = SSL_new(cache.context);
+		SSL_set_fd(this->_ssl, static_cast<int>(this->_socket));
+		SSL_set_tlsext_host_name(this->_ssl, host.c_str());
+		// An address is checked against the addresses the certificate is for, a name against its names
+		if (!X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(this->_ssl), host.c_str()))
+			SSL_set1_host(this->_ssl, host.c_str());
+		SSL_set_app_data(this->_ssl, this);
+		// The answer is read until the server closes, so no close_notify is written to a closed connection.
+		// SSL_shutdown still marks the session as ended properly, which keeps it resumable.
+		SSL_set_quiet_shutdown(this->_ssl, 1);
+		{
+			std::unique_lock<std::mutex> lock{cache.mutex};
+			auto &sessions = cache.sessions[this->_key];
+
+			if (!sessions.empty()) {
+				SSL_set_session(this->_ssl, sessions.back());
+				if (SSL_SESSION_get_protocol_version(sessions.back()) >= TLS1_3_VERSION) {
+					SSL_SESSION_free(sessions.back());
+					sessions.pop_back();
+				}
+			}
+		}
+		if (SSL_connect(this->_ssl) != 1) {
+			auto verification = SSL_get_verify_result(this->_ssl);
+			auto error = verification == X509_V_OK ? getErrorString() : X509_verify_cert_error_string(verification);
+
+			this->disconnect();
+			throw NetworkException("TLS handshake with " + host + " failed: " + error);
+		}
+		(SSL_session_reused(this->_ssl) ? resumed : full).add();
+	}
+
+	void TlsConnection::send(const std::string &data)
+	{
+		if (!this->_ssl)
+			throw NotConnectedException("This socket is not connected to a server");
+		for (size_t sent = 0; sent < data.size(); ) {
+			int size = SSL_write(this->_ssl, data.c_str() + sent, static_cast<int>(data.size() - sent));
+
+			if (size <= 0)
+				throw NetworkException("Cannot send to " + this->_key + ": " + getErrorString());
+			sent += size;
+		}
+	}
+
+	std::string TlsConnection::read(size_t size)
+	{
+		std::string result(size, '\0');
+
+		if (!this->_ssl)
+			throw NotConnectedException("This socket is not connected to a server");
+		for (size_t received = 0; received < size; ) {
+			int count = SSL_read(this->_ssl, &result[received], static_cast<int>(std::min<size_t>(size - received, INT_MAX)));
+
+			if (count > 0) {
+				received += count;
+				continue;
+			}
+
+			auto error = SSL_get_error(this->_ssl, count);
+
+			if (error == SSL_ERROR_ZERO_RETURN || (error == SSL_ERROR_SYSCALL && ERR_peek_error() == 0))
+				throw EOFException("Connection closed by " + this->_key);
+			throw NetworkException("Cannot read from " + this->_key + ": " + getErrorString());
+		}
+		return result;
+	}
+
+	std::string TlsConnection::readUntilEOF()
+	{
+		std::string result;
+		char buffer[16384];
+
+		if (!this->_ssl)
+			throw NotConnectedException("This socket is not connected to a server");
+		while (true) {
+			int size = SSL_read(this->_ssl, buffer, sizeof(buffer));
+
+			if (size > 0) {
+				result.append(buffer, size);
+				continue;
+			}
+
+			auto error = SSL_get_error(this->_ssl, size);
+
+			if (error == SSL_ERROR_ZERO_RETURN || (error == SSL_ERROR_SYSCALL && ERR_peek_error() == 0))
+				return result;
+			throw NetworkException("Cannot read from " + this->_key + ": " + getErrorString());
+		}
+	}
+
+	void TlsConnection::disconnect()
+	{
+		if (this->_ssl) {
+			SSL_shutdown(this->_ssl);
+			SSL_free(this->_ssl);
+			this->_ssl = nullptr;
+		}
+		if (this->_socket >= 0)
+			closeSocket(this->_socket);
+		this->_socket = -1;
+	}
+
+	void TlsConnection::interrupt()
+	{
+		intptr_t sock = this->_socket;
+
+		if (sock < 0)
+			return;
+#ifdef _WIN32
+		shutdown(sock, SD_BOTH);
+#else
+		shutdown(sock, SHUT_RDWR);
+#endif
+	}
+
+	bool TlsConnection::isOpen() const
+	{
+		return this->_ssl != nullptr;
+	}
+
+	bool TlsConnection::isResumed() const
+	{
+		return this->_ssl && SSL_session_reused(this->_ssl);
+	}
+
+	void TlsConnection::clearSessions()
+	{
+		auto &cache = getCache();
+		std::unique_lock<std::mutex> lock{cache.mutex};
+
+		for (auto &host : cache.sessions)
+			for (auto session : host.second)
+				SSL_SESSION_free(session);
+		cache.sessions.clear();
+	}
+
+	void TlsConnection::trustCertificate(X509 *certificate)
+	{
+		X509_STORE_add_cert(SSL_CTX_get_cert_store(getCache().context), certificate);
+	}
+
+	// Called by OpenSSL whenever the server gives a session, during the handshake or later on with TLS 1.3
+	int TlsConnection::_onNewSession(SSL *ssl, SSL_SESSION *session)
+	{
+		auto connection = static_cast<TlsConnection *>(SSL_get_app_data(ssl));
+		auto &cache = getCache();
+		std::unique_lock<std::mutex> lock{cache.mutex};
+		auto &sessions = cache.sessions[connection->_key];
+
+		// The reference is ours now
+		sessions.push_back(session);
+		if (sessions.size() > maxSessionsPerHost) {
+			SSL_SESSION_free(sessions.front());
+			sessions.pop_front();
+		}
+		return 1;
+	}
+}
@@ -0,0 +1,75 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_TLSCONNECTION_HPP
+#define CHALLONGESOKU_TLSCONNECTION_HPP
+
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <openssl/ssl.h>
+
+namespace ChallongeSoku
+{
+	//! @brief TLS client connection resuming the sessions of the earlier connections to the same host.
+	//! @details ChallongeLib's SecuredSocket keeps its SSL objects to itself, so each of its connections does a
+	//! full handshake. Sessions given by servers (TLS 1.2 tickets, TLS 1.3 PSKs) are kept process wide, keyed by
+	//! host and port, and offered by the next connection to it, which then skips the certificate exchange and the
+	//! key agreement. TLS 1.3 tickets are only offered once, as RFC 8446 advises and OpenSSL servers require.
+	//! Servers give a couple on each connection, but only once it is read, so a few are kept for each host:
+	//! pooled connections opened ahead still find one. Certificates must be signed by one of the system's root
+	//! certificates and be for the host connected to.
+	class TlsConnection {
+	public:
+		//! @brief Seconds to resolve the host and open the TCP connection, through the Resolver.
+		static constexpr float connectTimeout = 10;
+		//! @brief Sessions kept for each host, the oldest ones are dropped.
+		static constexpr size_t maxSessionsPerHost = 4;
+
+		TlsConnection();
+		~TlsConnection();
+
+		TlsConnection(const TlsConnection &) = delete;
+		TlsConnection &operator=(const TlsConnection &) = delete;
+
+		//! @throw NetworkException
+		void	connect(const std::string &host, unsigned short portno);
+		//! @throw NetworkException
+		void	send(const std::string &data);
+		//! @brief Read exactly size bytes.
+		//! @throw EOFException The server closed the connection first.
+		//! @throw NetworkException
+		std::string read(size_t size);
+		//! @brief Read until the server closes the connection.
+		//! @throw NetworkException
+		std::string readUntilEOF();
+		void	disconnect();
+		//! @brief Make the reads and writes fail, including the one blocking another thread right now.
+		//! @details Unlike disconnect, it may be called from any thread. The connection still has to be disconnected
+		//! by the thread using it.
+		void	interrupt();
+		bool	isOpen() const;
+		//! @brief Whether the handshake resumed an earlier session instead of doing a full one.
+		bool	isResumed() const;
+
+		//! @brief Forget every session kept, so the next connections do a full handshake.
+		static void	clearSessions();
+		//! @brief Trust a certificate on top of the system's ones, for a server with a self-signed certificate.
+		static void	trustCertificate(X509 *certificate);
+
+	private:
+		// Read by interrupt from other threads
+		std::atomic<intptr_t> _socket{-1};
+		SSL *_ssl = nullptr;
+		std::string _key;
+
+		static int	_onNewSession(SSL *ssl, SSL_SESSION *session);
+
+		friend struct SessionCache;
+	};
+}
+
+
+#endif //CHALLONGESOKU_TLSCONNECTION_HPP
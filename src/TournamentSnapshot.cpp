@@ -0,0 +1,347 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include "TournamentSnapshot.hpp"
+
+using namespace ChallongeAPI;
+
+namespace ChallongeSoku
+{
+#pragma pack(push, 1)
+	struct StringRef {
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct SnapshotHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t id;
+		uint64_t participantsCount;
+		uint32_t matchCount;
+		uint32_t participantCount;
+		uint32_t groupIdCount;
+		uint32_t stringsSize;
+		StringRef url;
+		StringRef name;
+		StringRef type;
+		StringRef gameName;
+	};
+
+	struct MatchRecord {
+		uint64_t id;
+		uint64_t groupId;
+		uint64_t player1Id;
+		uint64_t player2Id;
+		uint64_t winnerId;
+		uint64_t loserId;
+		uint64_t prerequisites[2];
+		int32_t round;
+		int32_t suggestedPlayOrder;
+		int32_t scores[2];
+		uint8_t prerequisiteCount;
+		uint8_t flags;
+		StringRef state;
+	};
+
+	struct ParticipantRecord {
+		uint64_t id;
+		uint32_t groupIdsOffset;
+		uint32_t groupIdsCount;
+		uint8_t flags;
+		StringRef displayName;
+		StringRef username;
+		StringRef challongeUsername;
+		StringRef portraitUrl;
+	};
+#pragma pack(pop)
+
+	enum MatchFlags : uint8_t {
+		MATCH_HAS_GROUP          = 1U << 0U,
+		MATCH_HAS_PLAYER1        = 1U << 1U,
+		MATCH_HAS_PLAYER2        = 1U << 2U,
+		MATCH_HAS_WINNER         = 1U << 3U,
+		MATCH_HAS_LOSER          = 1U << 4U,
+		MATCH_HAS_SCORES         = 1U << 5U,
+		MATCH_PLAYER1_PREREQ_LOSER = 1U << 6U,
+		MATCH_PLAYER2_PREREQ_LOSER = 1U << 7U,
+	};
+
+	enum ParticipantFlags : uint8_t {
+		PARTICIPANT_HAS_CHALLONGE_USERNAME = 1U << 0U,
+		PARTICIPANT_HAS_PORTRAIT           = 1U << 1U,
+	};
+
+	class StringTable {
+	private:
+		std::string _data;
+
+	public:
+		StringRef add(const std::string &str)
+		{
+			StringRef ref{static_cast<uint32_t>(this->_data.size()), static_cast<uint32_t>(str.size())};
+
+			this->_data += str;
+			return ref;
+		}
+
+		const std::string &getData() const
+		{
+			return this->_data;
+		}
+	};
+
+	template<typename T>
+	static nlohmann::json optionalToJson(bool present, T value)
+	{
+		if (!present)
+			return nullptr;
+		return value;
+	}
+
+	TournamentSnapshot::TournamentSnapshot(const Tournament &tournament, const std::string &url) :
+		id(tournament.getId()),
+		url(url),
+		name(tournament.getName()),
+		type(tournament.getTournamentType()),
+		gameName(tournament.getGameName()),
+		participantsCount(tournament.getParticipantsCount()),
+		matches(tournament.getMatches()),
+		participants(tournament.getParticipants())
+	{
+	}
+
+	std::string TournamentSnapshot::getPath(const std::string &url)
+	{
+		std::string name = url;
+
+		for (auto &c : name)
+			if (!std::isalnum(c) && c != '-' && c != '_')
+				c = '_';
+		return "snapshots/" + name + ".snap";
+	}
+
+	void TournamentSnapshot::save(const std::string &path) const
+	{
+		std::filesystem::path filePath{path};
+		std::filesystem::path tmpPath{path + ".tmp"};
+		auto data = this->serialize();
+
+		if (filePath.has_parent_path())
+			std::filesystem::create_directories(filePath.parent_path());
+
+		std::ofstream stream{tmpPath, std::ios::binary};
+
+		stream.write(data.data(), data.size());
+		stream.close();
+		if (stream.fail())
+			return;
+		std::filesystem::rename(tmpPath, filePath);
+	}
+
+	bool TournamentSnapshot::load(const std::string &path)
+	{
+		std::ifstream stream{path, std::ios::binary};
+
+		if (stream.fail())
+			return false;
+		return this->deserialize({std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()});
+	}
+
+	std::string TournamentSnapshot::serialize() const
+	{
+		SnapshotHeader header;
+		StringTable strings;
+		std::vector<MatchRecord> matchRecords;
+		std::vector<ParticipantRecord> participantRecords;
+		std::vector<uint64_t> groupIds;
+
+		std::memcpy(header.magic, magic, sizeof(header.magic));
+		header.version = version;
+		header.id = this->id;
+		header.participantsCount = this->participantsCount;
+		header.url = strings.add(this->url);
+		header.name = strings.add(this->name);
+		header.type = strings.add(this->type);
+		header.gameName = strings.add(this->gameName);
+
+		matchRecords.reserve(this->matches.size());
+		for (auto &match : this->matches) {
+			MatchRecord record{};
+			auto &prerequisites = match->getPrerequisiteMatchIds();
+			auto &scores = match->getScores();
+
+			record.id = match->getId();
+			record.round = match->getRound();
+			record.suggestedPlayOrder = match->getSuggestedPlayOrder();
+			record.state = strings.add(match->getState());
+			record.prerequisiteCount = std::min<size_t>(prerequisites.size(), 2);
+			for (unsigned i = 0; i < record.prerequisiteCount; i++)
+				record.prerequisites[i] = prerequisites[i];
+			if (match->getGroupId()) {
+				record.flags |= MATCH_HAS_GROUP;
+				record.groupId = *match->getGroupId();
+			}
+			if (match->getPlayer1Id()) {
+				record.flags |= MATCH_HAS_PLAYER1;
+				record.player1Id = *match->getPlayer1Id();
+			}
+			if (match->getPlayer2Id()) {
+				record.flags |= MATCH_HAS_PLAYER2;
+				record.player2Id = *match->getPlayer2Id();
+			}
+			if (match->getWinnerId()) {
+				record.flags |= MATCH_HAS_WINNER;
+				record.winnerId = *match->getWinnerId();
+			}
+			if (match->getLoserId()) {
+				record.flags |= MATCH_HAS_LOSER;
+				record.loserId = *match->getLoserId();
+			}
+			if (scores) {
+				record.flags |= MATCH_HAS_SCORES;
+				record.scores[0] = scores->first;
+				record.scores[1] = scores->second;
+			}
+			if (match->isPlayer1IsPrereqMatchLoser())
+				record.flags |= MATCH_PLAYER1_PREREQ_LOSER;
+			if (match->isPlayer2IsPrereqMatchLoser())
+				record.flags |= MATCH_PLAYER2_PREREQ_LOSER;
+			matchRecords.push_back(record);
+		}
+
+		participantRecords.reserve(this->participants.size());
+		for (auto &participant : this->participants) {
+			ParticipantRecord record{};
+			const auto &ids = participant->getGroupPlayerIds();
+
+			record.id = participant->getId();
+			record.displayName = strings.add(participant->getDisplayName());
+			record.username = strings.add(participant->getUsername());
+			record.groupIdsOffset = groupIds.size();
+			record.groupIdsCount = ids.size();
+			groupIds.insert(groupIds.end(), ids.begin(), ids.end());
+			if (participant->getChallongeUsername()) {
+				record.flags |= PARTICIPANT_HAS_CHALLONGE_USERNAME;
+				record.challongeUsername = strings.add(*participant->getChallongeUsername());
+			}
+			if (participant->getAttachedParticipatablePortraitUrl()) {
+				record.flags |= PARTICIPANT_HAS_PORTRAIT;
+				record.portraitUrl = strings.add(*participant->getAttachedParticipatablePortraitUrl());
+			}
+			participantRecords.push_back(record);
+		}
+
+		header.matchCount = matchRecords.size();
+		header.participantCount = participantRecords.size();
+		header.groupIdCount = groupIds.size();
+		header.stringsSize = strings.getData().size();
+
+		std::string data;
+
+		data.reserve(
+			sizeof(header) +
+			matchRecords.size() * sizeof(*matchRecords.data()) +
+			participantRecords.size() * sizeof(*participantRecords.data()) +
+			groupIds.size() * sizeof(*groupIds.data()) +
+			strings.getData().size()
+		);
+		data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+		data.append(reinterpret_cast<const char *>(matchRecords.data()), matchRecords.size() * sizeof(*matchRecords.data()));
+		data.append(reinterpret_cast<const char *>(participantRecords.data()), participantRecords.size() * sizeof(*participantRecords.data()));
+		data.append(reinterpret_cast<const char *>(groupIds.data()), groupIds.size() * sizeof(*groupIds.data()));
+		data.append(strings.getData().data(), strings.getData().size());
+		return data;
+	}
+
+	bool TournamentSnapshot::deserialize(const std::string &buffer)
+	{
+		SnapshotHeader header;
+
+		if (buffer.size() < sizeof(header))
+			return false;
+		std::memcpy(&header, buffer.data(), sizeof(header));
+		if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version)
+			return false;
+
+		size_t matchesOffset = sizeof(header);
+		size_t participantsOffset = matchesOffset + header.matchCount * sizeof(MatchRecord);
+		size_t groupIdsOffset = participantsOffset + header.participantCount * sizeof(ParticipantRecord);
+		size_t stringsOffset = groupIdsOffset + header.groupIdCount * sizeof(uint64_t);
+
+		if (stringsOffset + header.stringsSize != buffer.size())
+			return false;
+
+		const char *strings = buffer.data() + stringsOffset;
+		auto getString = [&header, strings](const StringRef &ref){
+			if (static_cast<uint64_t>(ref.offset) + ref.size > header.stringsSize)
+				throw std::out_of_range("Invalid string reference in snapshot");
+			return std::string(strings + ref.offset, ref.size);
+		};
+
+		try {
+			this->id = header.id;
+			this->participantsCount = header.participantsCount;
+			this->url = getString(header.url);
+			this->name = getString(header.name);
+			this->type = getString(header.type);
+			this->gameName = getString(header.gameName);
+
+			this->matches.clear();
+			this->matches.reserve(header.matchCount);
+			for (size_t i = 0; i < header.matchCount; i++) {
+				MatchRecord record;
+				std::string prerequisites;
+
+				std::memcpy(&record, buffer.data() + matchesOffset + i * sizeof(record), sizeof(record));
+				for (unsigned j = 0; j < record.prerequisiteCount && j < 2; j++)
+					prerequisites += (j ? "," : "") + std::to_string(record.prerequisites[j]);
+				this->matches.push_back(std::make_shared<Match>(nlohmann::json{
+					{"id",                            record.id},
+					{"state",                         getString(record.state)},
+					{"round",                         record.round},
+					{"suggested_play_order",          record.suggestedPlayOrder},
+					{"group_id",                      optionalToJson(record.flags & MATCH_HAS_GROUP, record.groupId)},
+					{"player1_id",                    optionalToJson(record.flags & MATCH_HAS_PLAYER1, record.player1Id)},
+					{"player2_id",                    optionalToJson(record.flags & MATCH_HAS_PLAYER2, record.player2Id)},
+					{"winner_id",                     optionalToJson(record.flags & MATCH_HAS_WINNER, record.winnerId)},
+					{"loser_id",                      optionalToJson(record.flags & MATCH_HAS_LOSER, record.loserId)},
+					{"player1_prereq_match_id",       optionalToJson(record.prerequisiteCount >= 1, record.prerequisites[0])},
+					{"player2_prereq_match_id",       optionalToJson(record.prerequisiteCount >= 2, record.prerequisites[1])},
+					{"prerequisite_match_ids_csv",    prerequisites},
+					{"player1_is_prereq_match_loser", (record.flags & MATCH_PLAYER1_PREREQ_LOSER) != 0},
+					{"player2_is_prereq_match_loser", (record.flags & MATCH_PLAYER2_PREREQ_LOSER) != 0},
+					{"scores_csv",                    (record.flags & MATCH_HAS_SCORES) ? std::to_string(record.scores[0]) + "-" + std::to_string(record.scores[1]) : ""},
+				}));
+			}
+
+			this->participants.clear();
+			this->participants.reserve(header.participantCount);
+			for (size_t i = 0; i < header.participantCount; i++) {
+				ParticipantRecord record;
+				std::vector<uint64_t> ids;
+
+				std::memcpy(&record, buffer.data() + participantsOffset + i * sizeof(record), sizeof(record));
+				if (static_cast<uint64_t>(record.groupIdsOffset) + record.groupIdsCount > header.groupIdCount)
+					return false;
+				ids.resize(record.groupIdsCount);
+				std::memcpy(ids.data(), buffer.data() + groupIdsOffset + record.groupIdsOffset * sizeof(uint64_t), ids.size() * sizeof(uint64_t));
+				this->participants.push_back(std::make_shared<Participant>(nlohmann::json{
+					{"id",                                   record.id},
+					{"display_name",                         getString(record.displayName)},
+					{"username",                             getString(record.username)},
+					{"challonge_username",                   optionalToJson(record.flags & PARTICIPANT_HAS_CHALLONGE_USERNAME, getString(record.challongeUsername))},
+					{"attached_participatable_portrait_url", optionalToJson(record.flags & PARTICIPANT_HAS_PORTRAIT, getString(record.portraitUrl))},
+					{"group_player_ids",                     ids},
+				}));
+			}
+		} catch (std::exception &) {
+			return false;
+		}
+		return true;
+	}
+}
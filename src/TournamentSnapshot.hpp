@@ -0,0 +1,54 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_TOURNAMENTSNAPSHOT_HPP
+#define CHALLONGESOKU_TOURNAMENTSNAPSHOT_HPP
+
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <Tournament.hpp>
+#include <Match.hpp>
+#include <Participant.hpp>
+
+namespace ChallongeSoku
+{
+	//! @brief Last known state of a tournament, saved on disk so the bracket can be drawn before the API answers.
+	//! @details The file is a fixed header followed by fixed size match and participant records,
+	//! a table of group player ids and a string table. Records only hold offsets, so the file can be
+	//! used as-is from a memory mapping. Any version or size mismatch makes the file be ignored.
+	struct TournamentSnapshot {
+		static constexpr uint32_t version = 1;
+		static constexpr char magic[4] = {'C', 'S', 'N', 'P'};
+
+		size_t id = 0;
+		std::string url;
+		std::string name;
+		std::string type;
+		std::string gameName;
+		size_t participantsCount = 0;
+		std::vector<std::shared_ptr<ChallongeAPI::Match>> matches;
+		std::vector<std::shared_ptr<ChallongeAPI::Participant>> participants;
+
+		TournamentSnapshot() = default;
+		TournamentSnapshot(const ChallongeAPI::Tournament &tournament, const std::string &url);
+
+		//! @brief Load a snapshot.
+		//! @return false if the file doesn't exist or is not a valid snapshot.
+		bool	load(const std::string &path);
+		//! @brief Save the snapshot. The file is written aside then renamed so a crash never leaves a truncated snapshot.
+		void	save(const std::string &path) const;
+		//! @brief The content of the snapshot file.
+		std::string serialize() const;
+		//! @return false if the data is not a valid snapshot.
+		bool	deserialize(const std::string &data);
+
+		static std::string getPath(const std::string &url);
+	};
+}
+
+
+#endif //CHALLONGESOKU_TOURNAMENTSNAPSHOT_HPP
@@ -0,0 +1,176 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <mutex>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <json.hpp>
+#include "Tracer.hpp"
+
+namespace ChallongeSoku
+{
+	struct Span {
+		const char *name;
+		Tracer::Clock::time_point start;
+		Tracer::Clock::time_point end;
+	};
+
+	// Only the owning thread appends, the lock is there for save and clear
+	struct ThreadBuffer {
+		std::mutex mutex;
+		unsigned id;
+		std::string name;
+		std::vector<Span> spans;
+		size_t dropped = 0;
+	};
+
+	struct TraceRegistry {
+		std::mutex mutex;
+		Tracer::Clock::time_point start = Tracer::Clock::now();
+		unsigned nextId = 1;
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	};
+
+	static TraceRegistry &getRegistry()
+	{
+		static TraceRegistry registry;
+
+		return registry;
+	}
+
+	// Registers the buffer of the current thread. Most threads live as long as the program, but the
+	// websocket one is started again for every tournament loaded, so the buffers of the threads which
+	// exited without recording anything are forgotten.
+	class BufferOwner {
+	public:
+		std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+
+		BufferOwner() :
+			// Constructed first, so destroyed after every buffer owner
+			_registry(getRegistry())
+		{
+			std::unique_lock<std::mutex> lock{this->_registry.mutex};
+
+			this->buffer->id = this->_registry.nextId++;
+			this->buffer->name = "Thread " + std::to_string(this->buffer->id);
+			this->_registry.buffers.push_back(this->buffer);
+		}
+
+		~BufferOwner()
+		{
+			std::unique_lock<std::mutex> lock{this->_registry.mutex};
+			std::unique_lock<std::mutex> bufferLock{this->buffer->mutex};
+			auto &buffers = this->_registry.buffers;
+
+			if (this->buffer->spans.empty() && !this->buffer->dropped)
+				buffers.erase(std::find(buffers.begin(), buffers.end(), this->buffer));
+		}
+
+	private:
+		TraceRegistry &_registry;
+	};
+
+	static ThreadBuffer &getBuffer()
+	{
+		thread_local BufferOwner owner;
+
+		return *owner.buffer;
+	}
+
+	void Tracer::enable()
+	{
+		_enabled = true;
+	}
+
+	void Tracer::disable()
+	{
+		_enabled = false;
+	}
+
+	void Tracer::setThreadName(const std::string &name)
+	{
+		auto &buffer = getBuffer();
+		std::unique_lock<std::mutex> lock{buffer.mutex};
+
+		buffer.name = name;
+	}
+
+	void Tracer::clear()
+	{
+		auto &registry = getRegistry();
+		std::unique_lock<std::mutex> lock{registry.mutex};
+
+		for (auto &buffer : registry.buffers) {
+			std::unique_lock<std::mutex> bufferLock{buffer->mutex};
+
+			buffer->spans.clear();
+			buffer->dropped = 0;
+		}
+		registry.start = Clock::now();
+	}
+
+	void Tracer::record(const char *name, Clock::time_point start, Clock::time_point end)
+	{
+		auto &buffer = getBuffer();
+		std::unique_lock<std::mutex> lock{buffer.mutex};
+
+		if (buffer.spans.size() >= maxSpansPerThread) {
+			buffer.dropped++;
+			return;
+		}
+		buffer.spans.push_back({name, start, end});
+	}
+
+	void Tracer::save(const std::string &path)
+	{
+		auto &registry = getRegistry();
+		std::unique_lock<std::mutex> lock{registry.mutex};
+		std::ofstream stream{path};
+		bool first = true;
+		auto write = [&stream, &first](const nlohmann::json &event){
+			stream << (first ? "\n" : ",\n") << event.dump();
+			first = false;
+		};
+		auto toUs = [&registry](Clock::time_point time){
+			return std::chrono::duration_cast<std::chrono::microseconds>(time - registry.start).count();
+		};
+
+		if (stream.fail())
+			throw std::runtime_error("Cannot create " + path);
+		stream << R"({"displayTimeUnit":"ms","traceEvents":[)";
+		for (auto &buffer : registry.buffers) {
+			std::unique_lock<std::mutex> bufferLock{buffer->mutex};
+
+			write({
+				{"name", "thread_name"},
+				{"ph",   "M"},
+				{"pid",  1},
+				{"tid",  buffer->id},
+				{"args", {{"name", buffer->name}}},
+			});
+			for (auto &span : buffer->spans)
+				write({
+					{"name", span.name},
+					{"ph",   "X"},
+					{"pid",  1},
+					{"tid",  buffer->id},
+					{"ts",   toUs(span.start)},
+					{"dur",  std::chrono::duration_cast<std::chrono::microseconds>(span.end - span.start).count()},
+				});
+			if (buffer->dropped)
+				write({
+					{"name", "Spans dropped: " + std::to_string(buffer->dropped)},
+					{"ph",   "i"},
+					{"s",    "t"},
+					{"pid",  1},
+					{"tid",  buffer->id},
+					{"ts",   buffer->spans.empty() ? 0 : toUs(buffer->spans.back().end)},
+				});
+		}
+		stream << "\n]}" << std::endl;
+	}
+}
@@ -0,0 +1,77 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_TRACER_HPP
+#define CHALLONGESOKU_TRACER_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#ifdef CHALLONGESOKU_NO_TRACE
+#define TRACE_SCOPE(name) do {} while (false)
+#else
+//! @brief Trace the rest of the current scope under a name, which must be a string literal.
+#define TRACE_SCOPE(name) ChallongeSoku::TraceSpan TRACE_CONCAT(_traceSpan, __LINE__){name}
+#endif
+
+namespace ChallongeSoku
+{
+	//! @brief Collects spans from every thread and saves them as a Chrome trace, which Perfetto and chrome://tracing open.
+	//! @details Nothing is recorded until enable is called: a disabled span only costs a relaxed load.
+	//! Each thread appends to its own buffer, which is kept after the thread exits so its spans are
+	//! still saved. Buffers stop recording when they are full, and the trace says how many spans were dropped.
+	class Tracer {
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+		//! @brief Spans a single thread can hold before dropping the next ones.
+		static constexpr size_t maxSpansPerThread = 1 << 18;
+
+		static void	enable();
+		static void	disable();
+		static bool	isEnabled() { return _enabled.load(std::memory_order_relaxed); };
+		//! @brief Name the calling thread in the trace. Threads without a name are called "Thread <id>".
+		static void	setThreadName(const std::string &name);
+		//! @brief Forget every span recorded so far.
+		static void	clear();
+		//! @brief Write every span recorded so far in the Chrome trace event format.
+		//! @throw std::runtime_error The file cannot be created.
+		static void	save(const std::string &path);
+		static void	record(const char *name, Clock::time_point start, Clock::time_point end);
+
+	private:
+		inline static std::atomic<bool> _enabled{false};
+	};
+
+	class TraceSpan {
+	public:
+		TraceSpan(const char *name) :
+			_name(Tracer::isEnabled() ? name : nullptr)
+		{
+			if (this->_name)
+				this->_start = Tracer::Clock::now();
+		};
+
+		~TraceSpan()
+		{
+			if (this->_name)
+				Tracer::record(this->_name, this->_start, Tracer::Clock::now());
+		};
+
+		TraceSpan(const TraceSpan &) = delete;
+		TraceSpan &operator=(const TraceSpan &) = delete;
+
+	private:
+		const char *_name;
+		Tracer::Clock::time_point _start;
+	};
+}
+
+
+#endif //CHALLONGESOKU_TRACER_HPP
@@ -0,0 +1,301 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <cmath>
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <Exceptions.hpp>
+#include "TrafficLog.hpp"
+
+using namespace ChallongeAPI;
+
+namespace ChallongeSoku
+{
+	const char * const TrafficLog::kindStrings[] = {
+		"http",
+		"ws<",
+		"ws>",
+		"tournament",
+	};
+
+	static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	static std::string withoutQuery(const std::string &path)
+	{
+		return path.substr(0, path.find('?'));
+	}
+
+	TrafficLog::~TrafficLog()
+	{
+		this->interrupt();
+	}
+
+	void TrafficLog::startRecording(const std::string &path)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_file.open(path);
+		if (this->_file.fail())
+			throw std::runtime_error("Cannot create " + path);
+		this->_file << nlohmann::json{
+			{"format",  "ChallongeSoku traffic"},
+			{"version", version},
+			{"date",    time(nullptr)},
+		}.dump() << std::endl;
+		this->_mode = MODE_RECORD;
+		this->_start = Clock::now();
+	}
+
+	void TrafficLog::startReplay(const std::string &path, float speed)
+	{
+		std::ifstream file{path};
+		std::string line;
+		std::vector<Entry> entries;
+
+		if (file.fail())
+			throw std::runtime_error("Cannot open " + path);
+		if (!std::getline(file, line))
+			throw std::runtime_error(path + " is empty");
+
+		auto header = nlohmann::json::parse(line);
+
+		if (header.value("format", "") != "ChallongeSoku traffic" || header.value("version", 0U) != version)
+			throw std::runtime_error(path + " is not a traffic log of this version");
+		while (std::getline(file, line)) {
+			if (line.empty())
+				continue;
+
+			auto value = nlohmann::json::parse(line);
+			std::string kind = value["k"];
+			auto it = std::find(std::begin(kindStrings), std::end(kindStrings), kind);
+
+			if (it == std::end(kindStrings))
+				throw std::runtime_error("Unknown traffic kind " + kind + " in " + path);
+			entries.push_back({value["t"].get<float>() / 1000, static_cast<Kind>(it - std::begin(kindStrings)), value["h"], value["d"]});
+		}
+
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_entries = std::move(entries);
+		this->_cursors.clear();
+		this->_speed = speed;
+		this->_mode = MODE_REPLAY;
+		this->_start = Clock::now();
+	}
+
+	TrafficLog::Mode TrafficLog::getMode() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_mode;
+	}
+
+	std::optional<std::string> TrafficLog::getRecordedTournament() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		for (auto &entry : this->_entries)
+			if (entry.kind == KIND_TOURNAMENT)
+				return entry.data["url"].get<std::string>();
+		return {};
+	}
+
+	Socket::HttpResponse TrafficLog::makeHttpRequest(Socket &socket, const Socket::HttpRequest &request)
+	{
+		return this->makeHttpRequest(request, [&socket, &request]{
+			return socket.makeHttpRequest(request);
+		});
+	}
+
+	Socket::HttpResponse TrafficLog::makeHttpRequest(const Socket::HttpRequest &request, const std::function<Socket::HttpResponse ()> &perform)
+	{
+		Socket::HttpResponse response;
+		auto mode = this->getMode();
+		auto toJson = [&request](const Socket::HttpResponse &response){
+			return nlohmann::json{
+				{"method",   request.method},
+				{"path",     request.path},
+				{"code",     response.returnCode},
+				{"codeName", response.codeName},
+				{"header",   response.header},
+				{"body",     response.body},
+			};
+		};
+
+		if (mode == MODE_LIVE)
+			return perform();
+		if (mode == MODE_RECORD)
+			try {
+				response = perform();
+				this->record(KIND_HTTP, request.host, toJson(response));
+				return response;
+			} catch (HTTPErrorException &e) {
+				this->record(KIND_HTTP, request.host, toJson(e.getResponse()));
+				throw;
+			} catch (std::exception &e) {
+				this->record(KIND_HTTP, request.host, {
+					{"method", request.method},
+					{"path",   request.path},
+					{"error",  e.what()},
+				});
+				throw;
+			}
+
+		auto entry = this->currentEntry(KIND_HTTP, request.host, request.path);
+
+		if (!entry)
+			throw NetworkException("Nothing recorded for " + request.host + withoutQuery(request.path));
+		if (entry->data.contains("error"))
+			throw NetworkException(entry->data["error"].get<std::string>());
+		response.returnCode = entry->data["code"];
+		response.codeName = entry->data["codeName"];
+		response.header = entry->data["header"].get<std::map<std::string, std::string>>();
+		response.body = entry->data["body"];
+		response.request = request;
+		if (response.returnCode >= 400)
+			throw HTTPErrorException(response);
+		return response;
+	}
+
+	void TrafficLog::record(Kind kind, const std::string &host, const nlohmann::json &data)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		if (this->_mode != MODE_RECORD)
+			return;
+		this->_file << nlohmann::json{
+			{"t", std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - this->_start).count()},
+			{"k", kindStrings[kind]},
+			{"h", host},
+			{"d", data},
+		}.dump() << '\n';
+		this->_file.flush();
+	}
+
+	std::optional<TrafficLog::Entry> TrafficLog::nextEntry(Kind kind, const std::string &host)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		auto &cursor = this->_cursors[{kind, host}];
+
+		while (cursor < this->_entries.size() && (this->_entries[cursor].kind != kind || this->_entries[cursor].host != host))
+			cursor++;
+		if (cursor >= this->_entries.size())
+			return {};
+
+		auto entry = this->_entries[cursor];
+
+		if (!this->_waitUntil(lock, entry.time))
+			return {};
+		cursor++;
+		return entry;
+	}
+
+	std::optional<TrafficLog::Entry> TrafficLog::currentEntry(Kind kind, const std::string &host, const std::string &path)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		float now = this->_speed <= 0 ? INFINITY : std::chrono::duration<float>(Clock::now() - this->_start).count() * this->_speed;
+		auto key = withoutQuery(path);
+		const Entry *first = nullptr;
+		const Entry *current = nullptr;
+
+		for (auto &entry : this->_entries) {
+			if (entry.kind != kind || entry.host != host)
+				continue;
+			if (withoutQuery(entry.data.value("path", entry.data.value("url", ""))) != key)
+				continue;
+			if (!first)
+				first = &entry;
+			if (entry.time > now)
+				break;
+			current = &entry;
+		}
+		if (current)
+			return *current;
+		if (!first)
+			return {};
+
+		auto entry = *first;
+
+		if (!this->_waitUntil(lock, entry.time))
+			return {};
+		return entry;
+	}
+
+	bool TrafficLog::isOver(Kind kind, const std::string &host) const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		auto it = this->_cursors.find({kind, host});
+
+		for (size_t i = it == this->_cursors.end() ? 0 : it->second; i < this->_entries.size(); i++)
+			if (this->_entries[i].kind == kind && this->_entries[i].host == host)
+				return false;
+		return true;
+	}
+
+	void TrafficLog::interrupt()
+	{
+		{
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			this->_interrupts++;
+		}
+		this->_condition.notify_all();
+	}
+
+	bool TrafficLog::_waitUntil(std::unique_lock<std::mutex> &lock, float time)
+	{
+		auto interrupts = this->_interrupts;
+
+		if (this->_speed <= 0)
+			return true;
+		this->_condition.wait_until(lock, this->_start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(time / this->_speed)), [this, interrupts]{
+			return this->_interrupts != interrupts;
+		});
+		return this->_interrupts == interrupts;
+	}
+
+	std::string TrafficLog::encodeBase64(const std::string &data)
+	{
+		std::string result;
+		unsigned value = 0;
+		int bits = -6;
+
+		result.reserve((data.size() + 2) / 3 * 4);
+		for (unsigned char c : data) {
+			value = (value << 8) + c;
+			bits += 8;
+			for (; bits >= 0; bits -= 6)
+				result += base64Chars[(value >> bits) & 0x3F];
+		}
+		if (bits > -6)
+			result += base64Chars[((value << 8) >> (bits + 8)) & 0x3F];
+		while (result.size() % 4)
+			result += '=';
+		return result;
+	}
+
+	std::string TrafficLog::decodeBase64(const std::string &data)
+	{
+		std::string result;
+		unsigned value = 0;
+		int bits = -8;
+
+		result.reserve(data.size() / 4 * 3);
+		for (char c : data) {
+			auto pos = std::strchr(base64Chars, c);
+
+			if (c == '=' || !c || !pos)
+				break;
+			value = (value << 6) + (pos - base64Chars);
+			bits += 6;
+			if (bits >= 0) {
+				result += static_cast<char>((value >> bits) & 0xFF);
+				bits -= 8;
+			}
+		}
+		return result;
+	}
+}
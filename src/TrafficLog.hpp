@@ -0,0 +1,108 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_TRAFFICLOG_HPP
+#define CHALLONGESOKU_TRAFFICLOG_HPP
+
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <optional>
+#include <functional>
+#include <condition_variable>
+#include <json.hpp>
+#include <Socket.hpp>
+
+namespace ChallongeSoku
+{
+	//! @brief Records what the engine exchanges with Challonge, Konni and SokuStreaming, and plays it back.
+	//! @details The log is a JSON object per line: a header, then one line per exchange with the number of
+	//! milliseconds since the recording started. When replaying, the log stands in for the servers:
+	//!  - HTTP requests get the last response recorded for the same host and path by that time in the
+	//!  replay, or wait for the first one.
+	//!  - Websocket frames are received one after the other, each at its own time.
+	//! Times are divided by the replay speed, and a speed of 0 plays everything as fast as possible.
+	//! The Challonge REST API is only reached through ChallongeLib, so tournaments are recorded as snapshots.
+	class TrafficLog {
+	public:
+		enum Kind {
+			KIND_HTTP,
+			KIND_WEBSOCKET_IN,
+			KIND_WEBSOCKET_OUT,
+			KIND_TOURNAMENT,
+		};
+
+		enum Mode {
+			MODE_LIVE,
+			MODE_RECORD,
+			MODE_REPLAY,
+		};
+
+		struct Entry {
+			//! @brief Seconds since the recording started.
+			float time;
+			Kind kind;
+			std::string host;
+			nlohmann::json data;
+		};
+
+		static constexpr unsigned version = 2;
+		static const char * const kindStrings[];
+
+		TrafficLog() = default;
+		~TrafficLog();
+
+		//! @throw std::runtime_error The file cannot be created.
+		void	startRecording(const std::string &path);
+		//! @throw std::runtime_error The file cannot be read or isn't a traffic log.
+		void	startReplay(const std::string &path, float speed = 1);
+		Mode	getMode() const;
+		//! @brief URL of the first tournament in the log being replayed, if any.
+		std::optional<std::string> getRecordedTournament() const;
+
+		//! @brief Perform a request, record it or replay it, depending on the mode.
+		//! @throw HTTPErrorException The response has an error code, like Socket::makeHttpRequest.
+		ChallongeAPI::Socket::HttpResponse makeHttpRequest(ChallongeAPI::Socket &socket, const ChallongeAPI::Socket::HttpRequest &request);
+		//! @brief Same, for a request made by something else than a ChallongeLib socket.
+		//! @param perform Makes the request, and throws HTTPErrorException for an error code.
+		ChallongeAPI::Socket::HttpResponse makeHttpRequest(const ChallongeAPI::Socket::HttpRequest &request, const std::function<ChallongeAPI::Socket::HttpResponse ()> &perform);
+		void	record(Kind kind, const std::string &host, const nlohmann::json &data);
+		//! @brief When replaying, the next entry of a stream (websocket frames), once its time has come.
+		//! @return Nothing if the stream is over or interrupt was called in the meantime.
+		std::optional<Entry> nextEntry(Kind kind, const std::string &host);
+		//! @brief When replaying, the last entry recorded for a host and path by now (HTTP, tournaments).
+		//! @return Nothing if there is no such entry or interrupt was called while waiting for the first one.
+		std::optional<Entry> currentEntry(Kind kind, const std::string &host, const std::string &path);
+		//! @brief Whether a stream has been played entirely.
+		bool	isOver(Kind kind, const std::string &host) const;
+		//! @brief Wake everything waiting in nextEntry or currentEntry.
+		void	interrupt();
+
+		static std::string encodeBase64(const std::string &data);
+		static std::string decodeBase64(const std::string &data);
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		mutable std::mutex _mutex;
+		std::condition_variable _condition;
+		Mode _mode = MODE_LIVE;
+		Clock::time_point _start;
+		std::ofstream _file;
+		float _speed = 1;
+		unsigned _interrupts = 0;
+		std::vector<Entry> _entries;
+		//! @brief Index of the next entry of each stream, by kind and host.
+		std::map<std::pair<Kind, std::string>, size_t> _cursors;
+
+		bool	_waitUntil(std::unique_lock<std::mutex> &lock, float time);
+	};
+}
+
+
+#endif //CHALLONGESOKU_TRAFFICLOG_HPP
@@ -0,0 +1,37 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include "UiQueue.hpp"
+
+namespace ChallongeSoku
+{
+	void UiQueue::post(const std::function<void ()> &fct)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_tasks.push_back(fct);
+	}
+
+	size_t UiQueue::process()
+	{
+		std::deque<std::function<void ()>> tasks;
+
+		// Tasks may post other tasks, they will be run next frame
+		{
+			std::unique_lock<std::mutex> lock{this->_mutex};
+
+			tasks.swap(this->_tasks);
+		}
+		for (auto &task : tasks)
+			task();
+		return tasks.size();
+	}
+
+	size_t UiQueue::getPendingCount() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_tasks.size();
+	}
+}
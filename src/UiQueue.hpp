@@ -0,0 +1,33 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_UIQUEUE_HPP
+#define CHALLONGESOKU_UIQUEUE_HPP
+
+
+#include <mutex>
+#include <deque>
+#include <functional>
+
+namespace ChallongeSoku
+{
+	//! @brief Lets worker threads hand work to the GUI thread.
+	//! @details Widgets must only be touched from the GUI thread. Workers post what they want
+	//! done and the main loop runs it between two frames, in the order it was posted.
+	class UiQueue {
+	public:
+		void	post(const std::function<void ()> &fct);
+		//! @brief Run everything posted so far. Must be called from the GUI thread.
+		//! @return How many tasks were run.
+		size_t	process();
+		size_t	getPendingCount() const;
+
+	private:
+		mutable std::mutex _mutex;
+		std::deque<std::function<void ()>> _tasks;
+	};
+}
+
+
+#endif //CHALLONGESOKU_UIQUEUE_HPP
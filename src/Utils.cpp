@@ -2,9 +2,6 @@
 // Created by Gegel85 on 07/04/2020.
 //
 
-#ifdef __GNUG__
-#include <cxxabi.h>
-#endif
 #include <filesystem>
 #include <regex>
 #include <codecvt>
@@ -85,27 +82,6 @@ namespace Utils
 		return myconv.to_bytes(str);
 	}
 
-	std::string getLastExceptionName()
-	{
-#ifdef __GNUG__
-		int status;
-		char *value;
-		std::string name;
-
-		auto val = abi::__cxa_current_exception_type();
-
-		if (!val)
-			return "No exception";
-
-		value = abi::__cxa_demangle(val->name(), nullptr, nullptr, &status);
-		name = value;
-		free(value);
-		return name;
-#else
-		return "Unknown exception";
-#endif
-	}
-
 	int	dispMsg(const std::string &title, const std::string &content, int variate)
 	{
 		auto button = tgui::Button::create("OK");
@@ -439,6 +415,16 @@ namespace Utils
 		return window;
 	}
 
+	size_t countWidgets(const std::vector<tgui::Widget::Ptr> &widgets)
+	{
+		size_t count = widgets.size();
+
+		for (auto &widget : widgets)
+			if (auto container = std::dynamic_pointer_cast<tgui::Container>(widget))
+				count += countWidgets(container->getWidgets());
+		return count;
+	}
+
 	Color HSLtoRGB(const HSLColor &color)
 	{
 		struct {
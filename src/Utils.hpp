@@ -10,6 +10,7 @@
 #include <vector>
 #include <filesystem>
 #include <TGUI/TGUI.hpp>
+#include "LastException.hpp"
 
 #ifndef _WIN32
 #define MB_ICONERROR 1
@@ -47,11 +48,6 @@ namespace Utils
 	//! @note On Non-Windows systems, it will simulate the Windows dialog box. Only MB_ICONERROR and MB_OK are simulated on those systems.
 	int	dispMsg(const std::string &title, const std::string &content, int variate);
 
-	//! @brief Get the last Exception Name
-	//! @details Return the last type of Exception name
-	//! @return std::string The last Exception name
-	std::string getLastExceptionName();
-
 	//! @brief Opens a FileDialog
 	//! @param title Title of the FileDialog
 	//! @param basePath The path of the FileDialog
@@ -108,6 +104,11 @@ namespace Utils
 	//! @return A pointer to the window
 	tgui::ChildWindow::Ptr makeColorPickWindow(tgui::Gui &gui, const std::function<void(Color color)> &onFinish, Color startColor);
 
+	//! @brief Count widgets, including the ones inside containers.
+	//! @param widgets The widgets to count, usually the ones of a Gui.
+	//! @return The number of widgets in the whole tree.
+	size_t	countWidgets(const std::vector<tgui::Widget::Ptr> &widgets);
+
 	HSLColor RGBtoHSL(const Color &color);
 	Color HSLtoRGB(const HSLColor &color);
 	bool point_in_ellipse(int x, int y, int rx, int ry);
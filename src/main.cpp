@@ -2,18 +2,30 @@
 #include <SFML/Graphics.hpp>
 #include <TGUI/TGUI.hpp>
 #include <Socket.hpp>
+#include <set>
 #include <json.hpp>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <csignal>
 #include <Exceptions.hpp>
-#define private public
 #include <Participant.hpp>
 #include <Tournament.hpp>
 #include <Match.hpp>
-#undef private
-#include <JsonUtils.hpp>
-#include <Client.hpp>
 #include <fstream>
-#include "SecuredWebSocket.hpp"
+#include "SyncEngine.hpp"
+#include "BracketLayout.hpp"
+#include "BracketView.hpp"
+#include "ConnectionPool.hpp"
+#include "Resolver.hpp"
+#include "Headless.hpp"
+#include "StatusServer.hpp"
+#include "TaskPool.hpp"
+#include "AutoDirector.hpp"
+#include "Notifications.hpp"
+#include "MetricsOverlay.hpp"
+#include "Tracer.hpp"
+#include "UiQueue.hpp"
 #include "Utils.hpp"
 
 #if !defined(USERNAME) || !defined(APIKEY)
@@ -26,66 +38,16 @@
 using namespace ChallongeSoku;
 using namespace ChallongeAPI;
 
-struct KonniMatch {
-	bool autopunch;
-	std::string clientChallonge;
-	std::string clientCharacter;
-	std::string clientCountry;
-	std::string clientName;
-	std::string hostChallonge;
-	std::string hostCharacter;
-	std::string hostCountry;
-	std::string hostName;
-	std::string ip;
-	unsigned short port;
-	std::string message;
-	bool ranked;
-	bool spectatable;
-	unsigned spectators;
-	time_t start;
-	bool gameStarted;
-	bool expired = false;
-
-	KonniMatch() = default;
-	KonniMatch(const nlohmann::json &value) {
-		getFromJson(this->autopunch,       "autopunch", value);
-		getFromJson(this->clientChallonge, "client_challonge", value);
-		getFromJson(this->clientCharacter, "client_character", value);
-		getFromJson(this->clientCountry,   "client_country", value);
-		getFromJson(this->clientName,      "client_name", value);
-		getFromJson(this->hostChallonge,   "host_challonge", value);
-		getFromJson(this->hostCharacter,   "host_character", value);
-		getFromJson(this->hostCountry,     "host_country", value);
-		getFromJson(this->hostName,        "host_name", value);
-		getFromJson(this->ip,              "ip", value);
-		getFromJson(this->message,         "message", value);
-		getFromJson(this->ranked,          "ranked", value);
-		getFromJson(this->spectatable,     "spectatable", value);
-		getFromJson(this->spectators,      "spectators", value);
-		getFromJson(this->start,           "start", value);
-		getFromJson(this->gameStarted,     "started", value);
-
-		size_t portPos = this->ip.find(':');
-
-		this->port = std::stoul(this->ip.substr(portPos + 1));
-		this->ip = this->ip.substr(0, portPos);
-	}
-	KonniMatch& operator=(const nlohmann::json &value);
-};
-
-struct ChallongeWSock {
-	SecuredWebSocket socket;
-	std::string clientId;
-	std::string id;
-	std::thread socketThread;
-};
-
 struct Settings {
 	std::string apikey;
 	std::string username;
 	std::string sshost;
 	unsigned short ssport;
+	float sokuStreamingTimeout;
+	std::string konniHost;
+	unsigned short konniPort;
 	float refreshRate;
+	unsigned short statusPort;
 	bool useChallongeUsernames;
 	tgui::Color noStartedColor;
 	tgui::Color hostingColor;
@@ -94,6 +56,7 @@ struct Settings {
 	tgui::Color loserColor;
 	tgui::Color wasHostingColor;
 	std::map<std::string, std::string> roundNames;
+	AutoDirector::Config autoDirector;
 
 	~Settings() {
 		this->save();
@@ -114,7 +77,11 @@ struct Settings {
 			{ "username",              this->username },
 			{ "sshost",                this->sshost },
 			{ "ssport",                this->ssport },
+			{ "sokuStreamingTimeout",  this->sokuStreamingTimeout },
+			{ "konniHost",             this->konniHost },
+			{ "konniPort",             this->konniPort },
 			{ "refreshRate",           this->refreshRate },
+			{ "statusPort",            this->statusPort },
 			{ "useChallongeUsernames", this->useChallongeUsernames },
 			{ "noStartedColor",        serializeColor(this->noStartedColor) },
 			{ "hostingColor",          serializeColor(this->hostingColor) },
@@ -122,7 +89,8 @@ struct Settings {
 			{ "winnerColor",           serializeColor(this->winnerColor) },
 			{ "loserColor",            serializeColor(this->loserColor) },
 			{ "wasHostingColor",       serializeColor(this->wasHostingColor) },
-			{ "roundNames",            this->roundNames }
+			{ "roundNames",            this->roundNames },
+			{ "autoDirector",          this->autoDirector.toJson() }
 		};
 
 		file << value.dump(4) << std::endl;
@@ -149,7 +117,15 @@ struct Settings {
 		this->username              = value["username"];
 		this->sshost                = value["sshost"];
 		this->ssport                = value["ssport"];
+		if (value.contains("sokuStreamingTimeout"))
+			this->sokuStreamingTimeout = value["sokuStreamingTimeout"];
+		if (value.contains("konniHost"))
+			this->konniHost     = value["konniHost"];
+		if (value.contains("konniPort"))
+			this->konniPort     = value["konniPort"];
 		this->refreshRate           = value["refreshRate"];
+		if (value.contains("statusPort"))
+			this->statusPort    = value["statusPort"];
 		this->useChallongeUsernames = value["useChallongeUsernames"];
 		this->noStartedColor        = unserializeColor(value["noStartedColor"]);
 		this->hostingColor          = unserializeColor(value["hostingColor"]);
@@ -158,78 +134,72 @@ struct Settings {
 		this->loserColor            = unserializeColor(value["loserColor"]);
 		this->wasHostingColor       = unserializeColor(value["wasHostingColor"]);
 		this->roundNames            = value["roundNames"].get<std::map<std::string, std::string>>();
+		if (value.contains("autoDirector"))
+			this->autoDirector.load(value["autoDirector"]);
 	}
 };
 
-typedef std::vector<std::shared_ptr<Match>> Round;
-typedef std::vector<Round> RobinBracket;
-typedef std::map<int, Round> ElimBracket;
-
-struct Bracket {
-	std::string type;
-	ElimBracket elim;
-	RobinBracket robbin;
-	std::pair<int, int> roundBounds;
-	std::shared_ptr<Match> last;
+// Changed matches waiting for the next bracket update, merged so a burst of pushes is only described once
+struct PendingUpdate {
+	bool all = false;
+	std::set<size_t> matchIds;
+	size_t requests = 0;
+	// Oldest websocket frame merged in
+	std::optional<std::chrono::steady_clock::time_point> received;
+	std::chrono::steady_clock::time_point firstRequest;
+	// Posted to the GUI thread once the cells are described
+	std::vector<std::function<void ()>> then;
 };
 
-typedef std::map<size_t, Bracket> Pool;
-
 struct State {
-	std::thread updateBracketThread;
-	std::vector<std::thread> messages;
 	sf::RenderWindow win;
 	tgui::Gui gui;
-	sf::Clock countdown;
-	ChallongeWSock wsock;
+	Notifications notifications;
+	MetricsOverlay overlay;
+	std::unique_ptr<BracketView> bracketView;
+	BracketLayout layout;
 	Settings settings;
-	std::string currentTournament;
-	std::thread stateUpdateThread;
-	std::map<size_t, KonniMatch> matchesStates;
-	std::shared_ptr<Tournament> tournament;
-	std::map<size_t, std::shared_ptr<Match>> matches;
-	std::map<std::string, size_t> discordHostToParticipant;
-	std::map<size_t, std::shared_ptr<Participant>> participants;
-	std::map<std::string, std::shared_ptr<Participant>> ChallongeUNameToParticipant;
-	Pool group;
-	Bracket bracket;
-	bool displayMutex;
-	bool updateMutex;
-
-	Client client;
+	SyncEngine engine;
+	std::unique_ptr<StatusServer> status;
+	AutoDirector director;
+	// Held while describing the cells
+	std::mutex updateMutex;
+
 	sf::Texture defaultTexture;
+	std::mutex imagesMutex;
 	std::map<std::string, sf::Texture> images;
+	UiQueue ui;
+	//! @brief Cancelled whenever another tournament starts loading.
+	CancellationSource tournament;
+	// Only used by the GUI thread
+	std::chrono::steady_clock::time_point loadStart;
+	std::optional<long> timeToFirstBracket;
+	// Oldest websocket frame whose changes are described but not on screen yet
+	std::optional<std::chrono::steady_clock::time_point> renderPending;
+	std::mutex pendingMutex;
+	PendingUpdate pendingUpdate;
+	std::atomic<bool> updateRunning{false};
+	// Last so their tasks are over before anything they use is destroyed
+	TaskQueue bracketQueue{"updateBracketState"};
+	TaskQueue portraitQueue{"loadPortraits"};
 };
 
-void lockMutex(bool &mutex)
-{
-	while (mutex) std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	mutex = true;
-}
-
-void openMsgBox(State &state, const std::string &title, const std::string &desc, int variate)
-{
-	auto fct = [desc, title, variate] {
-#ifdef _WIN32
-		MessageBoxA(nullptr, desc.c_str(), title.c_str(), variate);
-#else
-		Utils::dispMsg(title, desc, variate);
-#endif
-	};
-
-	state.messages.emplace_back(fct);
-}
-
 void handleEvents(State &state)
 {
 	sf::Event event;
 
 	while (state.win.pollEvent(event)) {
-		state.gui.handleEvent(event);
+		bool handled = state.gui.handleEvent(event);
+
+		state.bracketView->handleEvent(event, handled);
 		switch (event.type) {
 		case sf::Event::Closed:
 			state.win.close();
 			break;
+		case sf::Event::KeyPressed:
+			if (event.key.code == sf::Keyboard::F3)
+				state.overlay.toggle();
+			break;
 		case sf::Event::Resized:
 			state.gui.setView(sf::View{sf::FloatRect{
 				0,
@@ -244,88 +214,41 @@ void handleEvents(State &state)
 	}
 }
 
-void incrementId(std::string &id, int index = -2)
+// Only looks in the cache, so it never waits on the network
+const sf::Texture *findTexture(State &state, const std::string &link)
 {
-	if (index <= -2)
-		index = id.size() - 1;
-
-	if (index == -1) {
-		id.reserve(index + 1);
-		id = "1" + id;
-		for (unsigned i = index + 1; i < id.size(); i++)
-			id[i] = '0';
-		return;
-	}
-
-	char c = id[index];
+	std::unique_lock<std::mutex> lock{state.imagesMutex};
+	auto it = state.images.find(link);
 
-	c++;
-	if (c == ':')
-		c = 'a';
-	if (c == '{')
-		return incrementId(id, index - 1);
-	id[index] = c;
-	for (unsigned i = index + 1; i < id.size(); i++)
-		id[i] = '0';
+	if (it == state.images.end())
+		return nullptr;
+	return &it->second;
 }
 
-void sendWebSocketMessage(ChallongeWSock &sock, const std::string &channel, nlohmann::json value)
+std::string getLinkHost(const std::string &link)
 {
-	value["channel"] = channel;
-	value["clientId"] = sock.clientId;
-	value["id"] = sock.id;
-	incrementId(sock.id);
-	std::cout << "Sending " << value.dump(4) << std::endl;
-	sock.socket.send(nlohmann::json::array({
-		value
-	}).dump());
-}
+	auto tmp = link.substr(link.find("//") + 2);
 
-void updateTournamentState(State &state, nlohmann::json wsockPayload)
-{
-	for (auto &round : wsockPayload["matches_by_round"].items()) {
-		for (auto &match : round.value()) {
-			try {
-				if (!match.contains("id") || match["id"].is_null())
-					continue;
-
-				auto it = state.matches.find(match["id"]);
-
-				if (it != state.matches.end()) {
-					auto &obj = it->second;
-
-					getFromJson(obj->_forfeited, "forfeited", match);
-					getFromJson(obj->_loserId, "loser_id", match);
-					getFromJson(obj->_winnerId, "winner_id", match);
-					getFromJson(obj->_player1Id, "id", match["player1"]);
-					getFromJson(obj->_player2Id, "id", match["player2"]);
-					getFromJson(obj->_state, "state", match);
-					getFromJson(obj->_scores, "scores", match);
-				} else {
-					std::cerr << match.dump(4) << " ignored" << std::endl;
-				}
-			} catch (std::exception &e) {
-				std::cerr << "Error updating match " << match << std::endl;
-				std::cerr << e.what() << std::endl;
-			}
-		}
-	}
-	for (auto &elem : wsockPayload["groups"])
-		updateTournamentState(state, elem);
+	return tmp.substr(0, tmp.find('/'));
 }
 
 sf::Texture &getTexture(State &state, const std::string &link)
 {
+	static const auto fetchTime = MetricsRegistry::histogram("images.fetch_us");
+	static const auto fetchErrors = MetricsRegistry::counter("images.fetch_errors");
+
 	try {
-		if (state.images.find(link) != state.images.end())
-			return state.images[link];
+		if (auto texture = findTexture(state, link))
+			return const_cast<sf::Texture &>(*texture);
+
+		MetricsRegistry::Timer timer{fetchTime};
+		TRACE_SCOPE("getTexture");
 
 		sf::Image image;
-		SecuredSocket socket;
 		auto tmp = link.substr(link.find("//") + 2);
 		Socket::HttpRequest request;
 
-		request.host = tmp.substr(0, tmp.find('/'));
+		request.host = getLinkHost(link);
 		if (tmp.find('/') == std::string::npos)
 			request.path = "/";
 		else
@@ -334,51 +257,33 @@ sf::Texture &getTexture(State &state, const std::string &link)
 		request.method = "GET";
 		request.portno = 443;
 
-		auto response = socket.makeHttpRequest(request);
+		auto response = ConnectionPool::makeHttpRequest(request);
 
 		if (response.returnCode / 100 == 3) {
 			auto &t = getTexture(state, response.header["Location"]);
+			std::unique_lock<std::mutex> lock{state.imagesMutex};
 
 			state.images[link] = t;
 			return t;
 		}
 		if (!image.loadFromMemory(response.body.c_str(), response.body.size())) {
 			std::cerr << link << ": Parsing failed" << std::endl;
+			fetchErrors.add();
 			return state.defaultTexture;
 		}
+
+		std::unique_lock<std::mutex> lock{state.imagesMutex};
+
 		state.images[link].loadFromImage(image);
 		return state.images[link];
 	} catch (NetworkException &e) {
 		std::cerr << link << ": " << e.what() << std::endl;
+		fetchErrors.add();
 		return state.defaultTexture;
 	}
 }
 
-std::string generatesRoundName(State &state, const Bracket &bracket, int roundNumber, bool isGroup = false)
-{
-	if (isGroup)
-		return state.settings.roundNames.at("pool");
-
-	std::string front = (roundNumber < 0 ? "l" : "");
-	std::string realId = front + std::to_string(std::abs(roundNumber));
-	std::string altId = front + std::to_string(std::abs(roundNumber) - std::abs(roundNumber < 0 ? bracket.roundBounds.first : bracket.roundBounds.second) - 1);
-	auto realIt = state.settings.roundNames.find(realId);
-	auto altIt = state.settings.roundNames.find(altId);
-
-	if (altIt != state.settings.roundNames.end())
-		return altIt->second;
-	if (realIt != state.settings.roundNames.end())
-		return realIt->second;
-
-	auto v = state.settings.roundNames[front + "round"];
-	auto pos = v.find("{}");
-
-	if (pos == std::string::npos)
-		return v;
-	return v.replace(pos, pos + 2, std::to_string(std::abs(roundNumber)));
-}
-
-void updateMatchSidePanel(State &state, tgui::Panel::Ptr pan, const Match &match, bool player1)
+void describeMatchSide(State &state, CellSide &side, const Match &match, bool player1)
 {
 	auto &scores = match.getScores();
 	auto prerequ = player1 ? match.isPlayer1IsPrereqMatchLoser() : match.isPlayer2IsPrereqMatchLoser();
@@ -387,36 +292,27 @@ void updateMatchSidePanel(State &state, tgui::Panel::Ptr pan, const Match &match
 	auto playerId = player1 ? match.getPlayer1Id() : match.getPlayer2Id();
 	auto score = scores ? (player1 ? scores->first : scores->second) : std::optional<int>{};
 
-	auto username = pan->get<tgui::Label>("Username");
-	auto textbox = pan->get<tgui::TextBox>("TextBox");
-	auto picture = pan->get<tgui::Picture>("ProfilePic");
-	auto scoreLabel = pan->get<tgui::Label>("Score");
-
-	auto other = otherId ? state.matches[*otherId] : std::optional<std::shared_ptr<Match>>{};
-	auto participant = playerId ? state.participants[*playerId] : std::optional<std::shared_ptr<Participant>>{};
+	auto other = otherId ? state.engine.getMatch(*otherId) : nullptr;
+	auto participant = playerId ? state.engine.getParticipant(*playerId) : nullptr;
 	auto isWinner = playerId && match.getWinnerId() && match.getWinnerId() == playerId;
 	auto isLoser = playerId && match.getLoserId() && match.getLoserId() == playerId;
 
-	auto replacementStr = (prerequ ? "Loser of " : "Winner of ") + (other ? std::to_string((*other)->getSuggestedPlayOrder()) : "");
-	std::optional<sf::Texture> texture;
-
-	if (participant && *participant && (*participant)->getAttachedParticipatablePortraitUrl())
-		texture = getTexture(state, *(*participant)->getAttachedParticipatablePortraitUrl());
+	auto replacementStr = (prerequ ? "Loser of " : "Winner of ") + (other ? std::to_string(other->getSuggestedPlayOrder()) : "");
 
-	lockMutex(state.displayMutex);
-	if (participant) {
-		if (*participant) {
-			if (texture)
-				picture->getRenderer()->setTexture(*texture);
-			username->setText((*participant)->getDisplayName());
-			username->getRenderer()->setTextColor("black");
+	if (playerId) {
+		if (participant) {
+			// Portraits are streamed in by loadPortraits, cells are described again once theirs arrived
+			if (participant->getAttachedParticipatablePortraitUrl())
+				side.portrait = findTexture(state, *participant->getAttachedParticipatablePortraitUrl());
+			side.name = participant->getDisplayName();
+			side.nameColor = sf::Color::Black;
 		} else {
-			username->setText("Invalid participant " + std::to_string(*playerId));
-			username->getRenderer()->setTextColor("red");
+			side.name = "Invalid participant " + std::to_string(*playerId);
+			side.nameColor = sf::Color::Red;
 		}
 	} else {
-		username->setText(replacementStr);
-		username->getRenderer()->setTextColor("#AAAAAA");
+		side.name = replacementStr;
+		side.nameColor = sf::Color{0xAA, 0xAA, 0xAA};
 	}
 
 	tgui::Color color = state.settings.noStartedColor;
@@ -426,753 +322,393 @@ void updateMatchSidePanel(State &state, tgui::Panel::Ptr pan, const Match &match
 	else if (isWinner)
 		color = state.settings.winnerColor;
 
-	textbox->getRenderer()->setBackgroundColor(color);
-	scoreLabel->setText(score ? std::to_string(*score) : "-");
-	state.displayMutex = false;
+	side.scoreColor = color;
+	side.score = score ? std::to_string(*score) : "-";
 }
 
-void updateMatchPanel(State &state, const Bracket &bracket, const Match &match, tgui::Panel::Ptr panel, bool isGroup)
+// Must be called with the engine locked
+void describeMatch(State &state, CellVisual &visual, const Match &match)
 {
-	auto pan = state.gui.get<tgui::Panel>("Match" + std::to_string(match.getId()));
-	auto top = pan->get<tgui::Panel>("TopPanel");
-	auto bot = pan->get<tgui::Panel>("BottomPanel");
-	auto but = pan->get<tgui::Button>("JoinButton");
 	tgui::Color color = state.settings.noStartedColor;
-	auto it = state.matchesStates.find(match.getId());
+	auto &hosts = state.engine.getHosts();
+	auto it = hosts.find(match.getId());
 
-	if (it != state.matchesStates.end()) {
+	visual.id = std::to_string(match.getSuggestedPlayOrder());
+	if (it != hosts.end()) {
 		auto &host = it->second;
+		auto id = match.getId();
 
 		color = host.expired ? state.settings.wasHostingColor : (host.gameStarted ? state.settings.playingColor : state.settings.hostingColor);
-		but->disconnectAll("Clicked");
-		but->connect("Clicked", [&bracket, &match, host, &state, isGroup]{
-			Socket sock;
-			Socket::HttpRequest requ;
-			auto player1Id = match.getPlayer1Id();
-			auto player2Id = match.getPlayer2Id();
-			auto participant1 = player1Id ? state.participants[*player1Id] : std::optional<std::shared_ptr<Participant>>{};
-			auto participant2 = player2Id ? state.participants[*player2Id] : std::optional<std::shared_ptr<Participant>>{};
-			auto roundName = generatesRoundName(state, bracket, match.getRound(), isGroup);
-
-			if (!participant1 || !participant2)
-				return openMsgBox(
-					state,
-					"Connect error",
-					"Cannot connect to a match that doesn't have 2 participants.\nThis is a bug. Please report this to the tool developer.",
-					MB_ICONERROR
-				);
-
-			auto leftName  = ((*participant1)->getUsername() == host.hostChallonge ? *participant1 : *participant2)->getDisplayName();
-			auto rightName = ((*participant1)->getUsername() == host.hostChallonge ? *participant2 : *participant1)->getDisplayName();
-
-			requ.portno = state.settings.ssport;
-			requ.host = state.settings.sshost;
-			requ.httpVer = "HTTP/1.1";
-			requ.method = "POST";
-			requ.path = "/state";
-
-			requ.body.reserve(
-				strlen(R"({"left":{"name":"","score":0},{"right":{"name":"","score":0},"round":""})") +
-				leftName.size() + rightName.size() + roundName.size()
-			);
-			requ.body += R"({"left":{"score":0,"name":")";
-			requ.body += leftName;
-			requ.body += R"("},"right":{"score":0,"name":")";
-			requ.body += rightName;
-			requ.body += R"("},"round":")";
-			requ.body += roundName;
-			requ.body += R"("})";
-
-			try {
-				sock.makeHttpRequest(requ);
-			} catch (std::exception &e) {
-				openMsgBox(state, "State error", "Cannot set state: " + std::string(e.what()) + "\nThis is a bug. Please report this to the tool developer.", MB_ICONERROR);
-				std::cerr << Socket::generateHttpRequest(requ) << std::endl;
-				std::cerr << Utils::getLastExceptionName() << std::endl;
-				std::cerr << "\t" << e.what() << std::endl;
-				return;
-			}
-
-			requ.path = "/connect";
-			requ.body.reserve(strlen(R"({"ip":"","port":65535,"spec":true})") + host.ip.size());
-			requ.body = R"({"ip":")";
-			requ.body += host.ip;
-			requ.body += R"(","port":)";
-			requ.body += std::to_string(host.port);
-			requ.body += R"(,"spec":true})";
-
-			try {
-				sock.makeHttpRequest(requ);
-			} catch (HTTPErrorException &e) {
-				if (e.getResponse().returnCode == 503) {
-					openMsgBox(state, "Connect error", "Cannot connect to host: " + std::string(e.what()) + "\nPlease stop connecting/hosting before trying to connect.", MB_ICONERROR);
-					return;
-				}
-				openMsgBox(state, "Connect error", "Cannot connect to host: " + std::string(e.what()) + "\nThis is a bug. Please report this to the tool developer.", MB_ICONERROR);
-				std::cerr << Socket::generateHttpRequest(requ) << std::endl;
-				std::cerr << Utils::getLastExceptionName() << std::endl;
-				std::cerr << "\t" << e.what() << std::endl;
-			} catch (std::exception &e) {
-				openMsgBox(state, "Connect error", "Cannot connect to host: " + std::string(e.what()) + "\nThis is a bug. Please report this to the tool developer.", MB_ICONERROR);
-				std::cerr << Socket::generateHttpRequest(requ) << std::endl;
-				std::cerr << Utils::getLastExceptionName() << std::endl;
-				std::cerr << "\t" << e.what() << std::endl;
-			}
-		});
-		but->setEnabled(true);
-	} else
-		but->setEnabled(false);
-	updateMatchSidePanel(state, top, match, true);
-	updateMatchSidePanel(state, bot, match, false);
-	lockMutex(state.displayMutex);
-	pan->getRenderer()->setBackgroundColor(color);
-	state.displayMutex = false;
+		visual.joinable = true;
+		visual.onJoin = [&state, id]{
+			// SokuStreaming answers on its client's thread, the GUI only hears about it once it did
+			state.engine.joinMatchAsync(id, [&state, id](bool joined){
+				if (joined)
+					state.ui.post([&state, id]{
+						state.director.onManualJoin(id);
+					});
+			});
+		};
+	}
+	describeMatchSide(state, visual.sides[0], match, true);
+	describeMatchSide(state, visual.sides[1], match, false);
+	visual.background = color;
 }
 
-void updateBracketState(State &state, bool hasThread = true)
+// received is when the websocket frame which changed the matches arrived, to measure how long it takes to show them
+void refreshBracket(State &state, const std::optional<std::vector<size_t>> &matchIds, std::optional<std::chrono::steady_clock::time_point> received)
 {
-	lockMutex(state.updateMutex);
-	if (state.updateBracketThread.joinable() && hasThread)
-		state.updateBracketThread.join();
-
-	auto panel = state.gui.get<tgui::Panel>("Bracket");
-	auto fct = [&state, panel]{
-		for (auto &bracket : state.group)
-			for (auto &round : bracket.second.elim)
-				for (auto &match : round.second)
-					updateMatchPanel(state, bracket.second, *match, panel, true);
-		for (auto &round : state.bracket.elim)
-			for (auto &match : round.second)
-				updateMatchPanel(state, state.bracket, *match, panel, false);
-		state.updateMutex = false;
-	};
+	TRACE_SCOPE("updateBracketState");
+	std::unique_lock<std::mutex> lock{state.updateMutex};
 
-	std::cout << "Updating bracket state" << std::endl;
-	if (hasThread)
-		state.updateBracketThread = std::thread(fct);
+	if (matchIds)
+		state.bracketView->refresh(*matchIds);
 	else
-		fct();
+		state.bracketView->refresh();
+	if (received)
+		state.ui.post([&state, received]{
+			if (!state.renderPending || *received < *state.renderPending)
+				state.renderPending = received;
+		});
 }
 
-//TODO: https://hisouten.challonge.com/fr/soku2020
-tgui::Panel::Ptr addMatch(const Match &match, tgui::Layout2d pos, tgui::Panel::Ptr panel)
+// The matches are only marked, and described by applyPendingUpdate. Without matchIds, every cell is described again.
+void updateBracketState(State &state, std::optional<std::vector<size_t>> matchIds = {}, std::optional<std::chrono::steady_clock::time_point> received = {})
 {
-	static std::shared_ptr<tgui::Panel> panBase = nullptr;
-
-	if (!panBase) {
-		panBase = tgui::Panel::create({200, 41});
-		panBase->loadWidgetsFromFile("gui/match.gui");
-	}
+	static const auto requested = MetricsRegistry::counter("bracket.updates_requested");
+	std::unique_lock<std::mutex> lock{state.pendingMutex};
+	auto &pending = state.pendingUpdate;
 
-	auto pan = tgui::Panel::copy(panBase);
-	auto id = pan->get<tgui::Label>("ID");
-
-	pan->setPosition(pos);
-	id->setText(std::to_string(match.getSuggestedPlayOrder()));
-	panel->add(pan, "Match" + std::to_string(match.getId()));
-	return pan;
+	requested.add();
+	if (matchIds)
+		pending.matchIds.insert(matchIds->begin(), matchIds->end());
+	else
+		pending.all = true;
+	if (received && (!pending.received || *received < *pending.received))
+		pending.received = received;
+	if (!pending.requests++)
+		pending.firstRequest = std::chrono::steady_clock::now();
 }
 
-void buildRoundRobbinBracket(State &state, const Bracket &br, const tgui::Panel::Ptr &panel)
+// Run fct on the GUI thread once the changes marked so far are described
+void afterBracketUpdate(State &state, const std::function<void ()> &fct)
 {
-	sf::Vector2u size = {0, 0};
-	size_t lastSize = 0;
-	tgui::Vector2f pos {10, 10};
-	std::string id = "A";
-	const RobinBracket &bracket = br.robbin;
-
-	std::cout << "Building round robbin bracket" << std::endl;
-	for (size_t round = 0; round < bracket.size(); round++) {
-		auto lab = tgui::Label::create(generatesRoundName(state, br, round + 1));
-
-		pos.y = 10;
-		lab->setSize(200, 20);
-		lab->setPosition(pos);
-		lab->setVerticalAlignment(tgui::Label::VerticalAlignment::Center);
-		lab->setHorizontalAlignment(tgui::Label::HorizontalAlignment::Center);
-		lab->getRenderer()->setTextColor("white");
-		lab->getRenderer()->setBackgroundColor("black");
-		panel->add(lab);
-		pos.y += 20;
-		for (auto &match : bracket[round]) {
-			addMatch(*match, pos, panel);
-			pos.y += 60;
-		}
-		pos.x += 210;
-		size.x = std::max<unsigned>(size.x, pos.x);
-		size.y = std::max<unsigned>(size.y, pos.y - 10);
-	}
-	panel->setSize(size.x, size.y);
-	panel->setPosition(0, 0);
-	panel->getRenderer()->setBackgroundColor("#999999");
-}
+	std::unique_lock<std::mutex> lock{state.pendingMutex};
 
-void buildSimpleElimBracket(State &state, const Bracket &br, const ElimBracket &bracket, const tgui::Panel::Ptr &panel)
-{
-	sf::Vector2u size = {0, 0};
-	size_t biggest = 0;
-
-	for (auto &matches : bracket)
-		biggest = std::max(biggest, matches.second.size());
-	size.y = biggest * 60 + 20;
-	for (auto &matches : bracket) {
-		auto lab = tgui::Label::create(generatesRoundName(state, br, matches.first));
-		tgui::Vector2f pos;
-		size_t step = 60;
-
-		pos.x = (std::abs(matches.first) - 1) * 240.f + 10;
-		pos.y = 10;
-		lab->setSize(200, 20);
-		lab->setPosition(pos);
-		lab->setVerticalAlignment(tgui::Label::VerticalAlignment::Center);
-		lab->setHorizontalAlignment(tgui::Label::HorizontalAlignment::Center);
-		lab->getRenderer()->setTextColor("white");
-		lab->getRenderer()->setBackgroundColor("black");
-		panel->add(lab);
-		pos.y += 20;
-		if (std::abs(matches.first) != 1) {
-			auto inc = 30;
-			auto i = biggest, j = matches.second.size();
-
-			while (i && j) {
-				i >>= 1U;
-				j >>= 1U;
-			}
-			while (i || j) {
-				i >>= 1U;
-				j >>= 1U;
-				pos.y += inc;
-				step += inc * 2;
-				inc *= 2;
-			}
-		}
-
-		size.x = std::max<unsigned>(size.x, pos.x + 210);
-		panel->setSize(size.x, size.y);
-		for (auto &match : matches.second) {
-			addMatch(*match, pos, panel);
-			pos.y += step;
-		}
-	}
-	panel->setSize(size.x, size.y);
+	state.pendingUpdate.then.push_back(fct);
 }
 
-void buildDoubleElimBracket(State &state, const Bracket &br, const tgui::Panel::Ptr &pan)
+// Called once per frame. Only one update runs at a time: what changed meanwhile is merged and described
+// by the next one, from the engine's latest state, instead of queuing an update per push.
+void applyPendingUpdate(State &state)
 {
-	const ElimBracket &bracket = br.elim;
-	ElimBracket loser;
-	ElimBracket winner;
-	auto loserPanel = tgui::Panel::create();
-	auto winnerPanel = tgui::Panel::create();
-
-	for (auto &matches : bracket)
-		(matches.first < 0 ? loser : winner)[matches.first] = matches.second;
-
-	buildSimpleElimBracket(state, br, winner, winnerPanel);
-	buildSimpleElimBracket(state, br, loser, loserPanel);
-	loserPanel->setPosition(0, "winnerBracket.h");
-	loserPanel->getRenderer()->setBackgroundColor("#888888");
-	winnerPanel->setPosition(0, 0);
-	winnerPanel->getRenderer()->setBackgroundColor("#AAAAAA");
-	pan->add(winnerPanel, "winnerBracket");
-	pan->add(loserPanel, "loserBracket");
-	pan->setSize(
-		std::max(winnerPanel->getSize().x, loserPanel->getSize().x),
-		loserPanel->getPosition().y + loserPanel->getSize().y
-	);
-}
+	static const auto applied = MetricsRegistry::counter("bracket.updates_applied");
+	static const auto lag = MetricsRegistry::histogram("bracket.update_lag_us");
+	PendingUpdate pending;
 
-inline void buildBracket(State &state, const Bracket &bracket, const tgui::Panel::Ptr &pan)
-{
-	std::cout << "Building bracket of type " << bracket.type << std::endl;
-	if (bracket.type == "double elimination")
-		buildDoubleElimBracket(state, bracket, pan);
-	else if (bracket.type == "single elimination")
-		buildSimpleElimBracket(state, bracket, bracket.elim, pan);
-	else
-		buildRoundRobbinBracket(state, bracket, pan);
-}
+	if (state.updateRunning)
+		return;
 
-void buildGroupBrackets(State &state, const Pool &pools, const tgui::Panel::Ptr &pan)
-{
-	char labText[] = "Pool A";
-	char labName[] = "LabelPool@";
-	char finalX[] = "10 + Pool@.x + Pool@.w";
-	char finalY[] = "10 + Pool@.y + Pool@.h";
-	char pos[] = "LabelPool@.y + LabelPool@.h";
-	tgui::Vector2f size = {0, 0};
-
-	for (auto &pool : pools) {
-		auto panel = tgui::Panel::create();
-		auto label = tgui::Label::create(labText);
-
-		label->setPosition(0, finalY);
-		label->setTextSize(20);
-		label->setVerticalAlignment(tgui::Label::VerticalAlignment::Center);
-		label->setHorizontalAlignment(tgui::Label::HorizontalAlignment::Center);
-		label->getRenderer()->setTextColor("white");
-
-		labName[sizeof(labName) - 2]++;
-		labText[sizeof(labText) - 2]++;
-		pos[strlen("LabelPool")]++;
-		pos[strlen("LabelPool@.y + LabelPool")]++;
-		finalX[strlen("10 + Pool")]++;
-		finalY[strlen("10 + Pool")]++;
-		finalX[strlen("10 + Pool@.x + Pool")]++;
-		finalY[strlen("10 + Pool@.x + Pool")]++;
-
-		pan->add(label, labName);
-		pan->add(panel, labName + strlen("Label"));
-
-		buildBracket(state, pool.second, panel);
-		panel->setPosition(0, pos);
-		label->setSize(finalX + strlen("10 + Pool@.x + "), 20);
-
-		size.x = std::max(size.x, panel->getSize().x);
-		size.y = panel->getPosition().y + panel->getSize().y;
-		std::cout << pos << ":" << size.x << ":" << size.y << std::endl;
-	}
-	pan->setSize(size);
-	pan->getRenderer()->setBackgroundColor("#444444");
-}
+	std::unique_lock<std::mutex> lock{state.pendingMutex};
 
-void buildBracketTree(State &state)
-{
-	auto panel = state.gui.get<tgui::Panel>("Bracket");
-	auto groupPanel = tgui::Panel::create();
-	auto bracketPanel = tgui::Panel::create();
-
-	lockMutex(state.displayMutex);
-	panel->removeAllWidgets();
-	state.displayMutex = false;
-	buildGroupBrackets(state, state.group, groupPanel);
-	buildBracket(state, state.bracket, bracketPanel);
-	groupPanel->setPosition(0, 0);
-	bracketPanel->setPosition("groupPanel.w", 0);
-	lockMutex(state.displayMutex);
-	panel->add(groupPanel, "groupPanel");
-	panel->add(bracketPanel, "bracketPanel");
-	state.displayMutex = false;
-	updateBracketState(state, false);
+	if (!state.pendingUpdate.requests)
+		return;
+	pending = std::move(state.pendingUpdate);
+	state.pendingUpdate = {};
+	lock.unlock();
+
+	std::cout << "Updating bracket state (" << pending.requests << " changes merged)" << std::endl;
+	applied.add();
+	state.updateRunning = true;
+	state.bracketQueue.post([&state, pending]{
+		std::optional<std::vector<size_t>> matchIds;
+
+		if (!pending.all)
+			matchIds.emplace(pending.matchIds.begin(), pending.matchIds.end());
+		refreshBracket(state, matchIds, pending.received);
+		lag.recordSince(pending.firstRequest);
+		for (auto &fct : pending.then)
+			state.ui.post(fct);
+		state.updateRunning = false;
+	});
 }
 
-void connectToWebsocket(ChallongeWSock &wsock)
-{
-	std::cout << "Connecting websocket to challonge..." << std::endl;
-	SecuredSocket sock;
-	Socket::HttpRequest requ;
-
-	requ.host = "stream.challonge.com";
-	requ.portno = 8000;
-	requ.method = "GET";
-	requ.httpVer = "HTTP/1.1";
-	requ.path = "/faye?message=%5B%7B%22channel%22%3A%22%2Fmeta%2Fhandshake%22%2C%22version%22%3A%221.0%22%2C%22supportedConnectionTypes%22%3A%5B%22websocket%22%2C%22eventsource%22%2C%22long-polling%22%2C%22cross-origin-long-polling%22%2C%22callback-polling%22%5D%2C%22id%22%3A%221%22%7D%5D&jsonp=__jsonp1__";
-
-	auto result = sock.makeHttpRequest(requ);
-	auto pos = result.body.find("__jsonp1__");
-	auto data = nlohmann::json::parse(result.body.substr(pos + 11, result.body.size() - pos - 13))[0];
-
-	wsock.clientId = data["clientId"];
-	wsock.socket.setPath("/faye");
-	wsock.socket.connect("stream.challonge.com", 8000);
-	sendWebSocketMessage(wsock, "/meta/connect", {{"connectionType", "websocket"}});
-}
+//TODO: https://hisouten.challonge.com/fr/soku2020
 
-inline void addMatchToBracket(const std::shared_ptr<Match> &match, Bracket &bracket)
-{
-	bracket.roundBounds.first = std::min(match->getRound(), bracket.roundBounds.first);
-	bracket.roundBounds.second = std::max(match->getRound(), bracket.roundBounds.second);
-	bracket.elim[match->getRound()].push_back(match);
-	if (match->getRound() <= 0)
-		return;
-	while (bracket.robbin.size() < match->getRound())
-		bracket.robbin.emplace_back();
-	bracket.robbin[match->getRound() - 1].push_back(match);
-}
+// Indexed by BracketLayout::SectionKind
+static const char * const sectionColors[] = {
+	"#444444", // SECTION_GROUPS
+	"#999999", // SECTION_ROUND_ROBIN
+	"white",   // SECTION_SINGLE_ELIMINATION
+	"#AAAAAA", // SECTION_WINNERS
+	"#888888", // SECTION_LOSERS
+};
 
-inline void addMatchToPool(const std::shared_ptr<Match> &match, Pool &pool)
+// The layout is computed on the calling thread, and handed to the view from the GUI thread, which then calls then.
+// Cells of matches that were already shown keep their look, the others are blank until updateBracketState is called.
+void buildBracketTree(State &state, const std::function<void ()> &then)
 {
-	addMatchToBracket(match, pool[*match->getGroupId()]);
-}
+	static const auto layoutTime = MetricsRegistry::histogram("bracket.layout_us");
+	static const auto setLayoutTime = MetricsRegistry::histogram("bracket.set_layout_us");
+	TRACE_SCOPE("buildBracketTree");
+	auto layout = std::make_shared<BracketView::Layout>();
+	auto lock = state.engine.lock();
+	auto start = MetricsRegistry::Clock::now();
+	auto &result = state.layout.compute(state.engine.getGroup(), state.engine.getBracket());
+
+	layoutTime.recordSince(start);
+	std::cout << "Laid out " << state.layout.getRelayoutCount() << " pool(s) or bracket(s) again" << std::endl;
+	for (auto &section : result.sections)
+		layout->sections.push_back({
+			{section.rect.x, section.rect.y},
+			{section.rect.w, section.rect.h},
+			sectionColors[section.kind]
+		});
+	// Names depend on the settings so they are not part of the cached layout
+	for (auto &label : result.labels) {
+		tgui::Vector2f pos{label.rect.x, label.rect.y};
+		tgui::Vector2f size{label.rect.w, label.rect.h};
 
-std::string getGroupStageType(State &state, const Pool &pools)
-{
-	if (pools.empty())
-		return "who cares";
-
-	bool hadZero = false;
-	bool diffSize = false;
-	size_t expected = 0;
-	size_t nbMatchs = 0;
-	size_t nbRounds = 0;
-	size_t participantsPerPool = state.tournament->getParticipantsCount() / pools.size();
-
-	for (auto &bracket : pools) {
-		diffSize |= nbRounds && nbRounds != bracket.second.robbin.size();
-		nbRounds = bracket.second.robbin.size();
-		for (auto &round : bracket.second.elim) {
-			if (round.first < 0)
-				return "double elimination";
-			hadZero |= round.second.empty();
-			diffSize |= nbMatchs && nbMatchs != round.second.size();
-			nbMatchs = round.second.size();
-		}
+		if (label.kind == BracketLayout::LABEL_POOL)
+			layout->labels.push_back({"Pool " + std::string(1, 'A' + label.index), pos, size, 20, "white", "transparent"});
+		else
+			layout->labels.push_back({state.engine.getRoundName(*label.bracket, label.index), pos, size, 13, "white", "black"});
 	}
-	if (state.tournament->getParticipantsCount() % pools.size() || hadZero || diffSize || nbMatchs * nbRounds != participantsPerPool * (participantsPerPool - 1) / 2)
-		return "single elimination";
-	return "round robbin";
+	layout->cells.reserve(result.cells.size());
+	for (auto &cell : result.cells)
+		layout->cells.push_back({{cell.rect.x, cell.rect.y}, cell.match, cell.bracket, cell.isGroup});
+	layout->size = {result.width, result.height};
+	std::cout << "Bracket has " << layout->cells.size() << " matches" << std::endl;
+	lock.unlock();
+
+	state.ui.post([&state, layout, then]{
+		auto start = MetricsRegistry::Clock::now();
+
+		state.bracketView->setLayout(std::move(*layout));
+		setLayoutTime.recordSince(start);
+		then();
+	});
 }
 
-static bool disconnected = false;
-
-void webSocketLoop(State &state)
-{
-	auto score = state.gui.get<tgui::Label>("Score");
-	std::string tournamentChan = "/tournaments/" + std::to_string(state.tournament->getId());
+enum LoadStage {
+	LOAD_METADATA,
+	LOAD_SKELETON,
+	LOAD_NAMES,
+	LOAD_PORTRAITS,
+	LOAD_DONE,
+};
 
-	while (true)
-		try {
-			std::string data = state.wsock.socket.getAnswer();
-			auto parsed = nlohmann::json::parse(data);
-
-			for (auto &elem : parsed) {
-				std::cout << "Received " << elem.dump(4) << std::endl;
-				std::string channel = elem["channel"];
-
-				if (channel == "/meta/subscribe" && !elem["successful"])
-					return openMsgBox(state, "Websocket error", "Cannot subscribe to tournament events:\n\n" + elem["error"].get<std::string>(), MB_ICONERROR);
-				else if (channel == "/meta/connect")
-					sendWebSocketMessage(state.wsock, "/meta/connect",{{"connectionType", "websocket"}});
-				else if (channel == tournamentChan) {
-					updateTournamentState(state, elem["data"]["TournamentStore"]);
-					updateBracketState(state);
-				}
-			}
-		} catch (ConnectionTerminatedException &e) {
-			std::cerr << "Websocket disconnected: " << e.what() << std::endl;
-			return;
-		} catch (EOFException &e) {
-			if (state.wsock.socket.isOpen()) {
-				std::cerr << "Websocket error: " << Utils::getLastExceptionName() << ": " << e.what() << std::endl;
-				//openMsgBox(state, "Websocket error: EOFException", e.what(), MB_ICONERROR);
-			}
-			return;
-		} catch (std::exception &e) {
-			std::cerr << "Websocket error: " << Utils::getLastExceptionName() << ": " << e.what() << std::endl;//openMsgBox(state, "Websocket error: " + Utils::getLastExceptionName(), e.what(), MB_ICONERROR);
-			return;
-		}
-}
+const char * const loadStageStrings[] = {
+	"Fetching tournament",
+	"Building bracket",
+	"Filling names",
+	"Loading portraits",
+	"Done",
+};
 
-void connectWebSocket(State &state)
+void setLoadStage(State &state, LoadStage stage, size_t done = 0, size_t total = 0)
 {
-	state.wsock.socketThread = std::thread([&state]{
-		do {
-			try {
-				connectToWebsocket(state.wsock);
-				std::cout << "Subscribing to " << state.tournament->getId() << std::endl;
-				sendWebSocketMessage(
-					state.wsock,
-					"/meta/subscribe",
-					{
-						{"subscription", "/tournaments/" + std::to_string(state.tournament->getId())}
-					}
-				);
-				webSocketLoop(state);
-
-				try {
-					state.wsock.socket.disconnect();
-				} catch (...) {}
-			} catch (std::exception &e) {
-				std::cerr << "Websocket init error: " << Utils::getLastExceptionName() << ": " << e.what() << std::endl;
-				std::this_thread::sleep_for(std::chrono::milliseconds(500));
-			}
-		} while (!state.currentTournament.empty());
+	state.ui.post([&state, stage, done, total]{
+		auto bar = state.gui.get<tgui::ProgressBar>("LoadProgress");
+		std::string text = loadStageStrings[stage];
+
+		if (stage == LOAD_DONE)
+			return bar->setVisible(false);
+		if (total)
+			text += " (" + std::to_string(done) + "/" + std::to_string(total) + ")";
+		bar->setMaximum(LOAD_DONE * 100);
+		bar->setValue(stage * 100 + (total ? done * 100 / total : 0));
+		bar->setText(text);
+		bar->setVisible(true);
 	});
 }
 
-void loadChallongeTournament(State &state, std::string url, bool noObjectRefresh = false)
+void setScoreText(State &state, const std::string &text, std::optional<tgui::Color> color = {})
 {
-	state.currentTournament.clear();
-	if (state.wsock.socket.isOpen())
-		state.wsock.socket.disconnect();
-	if (state.wsock.socketThread.joinable())
-		state.wsock.socketThread.join();
-	state.wsock.id = "2";
-	auto fct = [&state, url, noObjectRefresh] {
+	state.ui.post([&state, text, color]{
 		auto score = state.gui.get<tgui::Label>("Score");
 
-		if (!noObjectRefresh) {
-			state.currentTournament.clear();
-			state.gui.get<tgui::Label>("Score")->setText("Loading tournament " + url + "...");
-			state.tournament = state.client.getTournamentByName(url);
-		}
-		std::cout << "Tournament type is " << state.tournament->getTournamentType() << std::endl;
-		if (state.tournament->getTournamentType() == "swiss")
-			throw NotImplementedException("Swiss tournaments are not yet implemented. Sorry....");
-		if (state.tournament->getGameName() != "Touhou Hisoutensoku")
-			openMsgBox(
-				state,
-				"Game not supported",
-				"Warning: This tournament's game is " + state.tournament->getGameName() + " but it is not supported.\nYou won't be able to use this program to connect to games.",
-				MB_ICONWARNING
-			);
-		connectWebSocket(state);
-		state.matchesStates.clear();
-		state.participants.clear();
-		state.matches.clear();
-		state.group.clear();
-		state.bracket.type = state.tournament->getTournamentType();
-		state.bracket.elim.clear();
-		state.bracket.robbin.clear();
-		state.bracket.roundBounds.first = INT32_MAX;
-		state.bracket.roundBounds.second = INT32_MIN;
-
-		for (auto &participant : state.tournament->getParticipants()) {
-			state.participants[participant->getId()] = participant;
-			if (participant->getChallongeUsername())
-				state.ChallongeUNameToParticipant[*participant->getChallongeUsername()] = participant;
-			for (auto &alt : participant->getGroupPlayerIds())
-				state.participants[alt] = participant;
-		}
+		score->setText(text);
+		if (color)
+			score->getRenderer()->setTextColor(*color);
+	});
+}
 
-		std::cout << "Building round tree" << std::endl;
-		for (auto &match : state.tournament->getMatches()) {
-			state.matches[match->getId()] = match;
-			std::cout << match->getId() << std::endl;
-			std::cout << (match->getGroupId() ? std::to_string(*match->getGroupId()) : "None") << std::endl;
-			std::cout << match->getState() << std::endl;
-			std::cout << match->getRound() << ":" << match->getSuggestedPlayOrder() << std::endl << std::endl;
-
-			if (match->getGroupId())
-				addMatchToPool(match, state.group);
-			else
-				addMatchToBracket(match, state.bracket);
-		}
+// Fetch every portrait in the background, describing again the cells of a participant once theirs is there.
+// Stops early if another tournament starts loading. Must be called from the GUI thread.
+void loadPortraits(State &state)
+{
+	std::map<std::string, std::vector<size_t>> matchesOfPortrait;
+	auto lock = state.engine.lock();
 
-		auto type = getGroupStageType(state, state.group);
+	for (auto &match : state.engine.getMatches())
+		for (auto &playerId : {match.second->getPlayer1Id(), match.second->getPlayer2Id()}) {
+			if (!playerId)
+				continue;
 
-		for (auto &elem : state.group)
-			elem.second.type = type;
-		std::cout << "Building bracket tree GUI" << std::endl;
-		buildBracketTree(state);
-		std::cout << "Done" << std::endl;
-		if (!noObjectRefresh) {
-			state.currentTournament = url;
-			score->setText(state.tournament->getName());
-			score->getRenderer()->setTextColor("black");
-		}
-	};
+			auto participant = state.engine.getParticipant(*playerId);
 
-	if (state.updateBracketThread.joinable())
-		state.updateBracketThread.join();
-	state.updateBracketThread = std::thread([&state, fct]{
-		try {
-			fct();
-		} catch (HTTPErrorException &e) {
-			auto res = e.getResponse();
-			std::string msg = e.what();
-
-			if (res.returnCode == 401)
-				msg += "\n\nPlease check your credentials.";
-			else if (res.returnCode == 404)
-				msg += "\n\nPlease check the URL.";
-			else if (res.returnCode / 100 == 5)
-				msg += "\n\nPlease try again later.";
-			else {
-				std::cerr << Socket::generateHttpRequest(res.request) << std::endl;
-				msg += "\n\nPlease report this to the developer.";
-			}
-			std::cerr << Socket::generateHttpResponse(res) << std::endl;
-			openMsgBox(state, Utils::getLastExceptionName(), msg, MB_ICONERROR);
-		} catch (std::exception &e) {
-			openMsgBox(state, Utils::getLastExceptionName(), e.what(), MB_ICONERROR);
+			if (!participant || !participant->getAttachedParticipatablePortraitUrl())
+				continue;
+			matchesOfPortrait[*participant->getAttachedParticipatablePortraitUrl()].push_back(match.first);
 		}
-	});
-}
-
-bool konniHostIsChallongeMatch(State &state, const Match &match, const KonniMatch &host)
-{
-	auto hostP   = state.ChallongeUNameToParticipant[host.hostChallonge]   ?: state.participants[state.discordHostToParticipant[host.hostName]];
-	auto clientP = state.ChallongeUNameToParticipant[host.clientChallonge] ?: state.participants[state.discordHostToParticipant[host.clientName]];
-	auto p1      = state.participants[*match.getPlayer1Id()];
-	auto p2      = state.participants[*match.getPlayer2Id()];
+	lock.unlock();
 
-	return (p1 == hostP || p2 == hostP) && (!host.gameStarted || p1 == clientP || p2 == clientP || host.clientChallonge.empty());
-}
+	std::set<std::string> hosts;
 
-bool matchKonniHostWithChallongeMatch(State &state, const Match &match, const KonniMatch &host, const std::map<size_t, KonniMatch> &old)
-{
-	auto it = old.find(match.getId());
+	for (auto &portrait : matchesOfPortrait)
+		if (!findTexture(state, portrait.first))
+			hosts.insert(getLinkHost(portrait.first));
+	// The handshakes of the next portraits are done while the current one downloads
+	ConnectionPool::warm({hosts.begin(), hosts.end()});
 
-	if (match.getState() != "open")
-		return false;
-	if (it != old.end() && it->second.hostChallonge == host.hostChallonge && !it->second.expired) {
-		state.matchesStates[match.getId()] = host;
-		return true;
-	}
-	if (!match.getPlayer1Id() && !match.getPlayer2Id())
-		return false;
-	if (!konniHostIsChallongeMatch(state, match, host))
-		return false;
+	// One task per portrait, so the ones left are dropped as soon as the tournament changes
+	auto token = state.tournament.getToken();
+	size_t done = 0;
 
-	state.matchesStates[match.getId()] = host;
-	return true;
+	state.portraitQueue.cancel();
+	for (auto &portrait : matchesOfPortrait)
+		state.portraitQueue.post([&state, portrait, done = done++, total = matchesOfPortrait.size()]{
+			setLoadStage(state, LOAD_PORTRAITS, done, total);
+			if (findTexture(state, portrait.first))
+				return;
+			getTexture(state, portrait.first);
+			updateBracketState(state, portrait.second);
+		}, token);
+	state.portraitQueue.post([&state]{
+		setLoadStage(state, LOAD_DONE);
+	}, token);
 }
 
-bool matchKonniHostWithChallongeMatchInBracket(State &state, const Bracket &bracket, const KonniMatch &host, const std::map<size_t, KonniMatch> &old)
+void loadChallongeTournament(State &state, const std::string &url)
 {
-	for (auto &round : bracket.elim)
-		for (auto &match : round.second)
-			if (matchKonniHostWithChallongeMatch(state, *match, host, old))
-				return true;
-	return false;
+	state.tournament.cancel();
+	state.engine.load(url);
 }
 
-void matchKonniHostsWithChallongeMatch(State &state, const std::vector<KonniMatch> &hosts)
+void setStatusText(State &state, const SyncEngine::Event &event)
 {
-	auto oldStates = state.matchesStates;
-	bool v = false;
-
-	state.matchesStates.clear();
-	for (auto &elem : oldStates)
-		elem.second.expired = true;
-	for (auto &elem : oldStates)
-		if (state.matches[elem.first]->getState() == "open")
-			state.matchesStates.emplace(elem);
-
-	if (state.bracket.elim.empty() && state.bracket.robbin.empty()) {
-		for (auto &host : hosts) {
-			v = false;
-			for (auto &bracket : state.group) {
-				v |= matchKonniHostWithChallongeMatchInBracket(state, bracket.second, host, oldStates);
-				if (v)
-					break;
-			}
-			if (!v)
-				std::cerr << "Error: Cannot find match for (group) host " << host.hostChallonge << std::endl;
-		}
-	} else
-		for (auto &host : hosts)
-			if (!matchKonniHostWithChallongeMatchInBracket(state, state.bracket, host, oldStates))
-				std::cerr << "Error: Cannot find match for host " << host.hostChallonge << std::endl;
-}
+	// Indexed by SyncEngine::Level
+	static const char * const levelColors[] = {
+		"green",
+		"#FF8800",
+		"red",
+	};
 
-void refreshView(State &state)
-{
-	auto fct = [&state]{
-		Socket sock;
-		Socket::HttpRequest requ;
-		auto score = state.gui.get<tgui::Label>("Warning");
-		auto chw = state.gui.get<tgui::Label>("ChallongeWarning");
+	state.ui.post([&state, event]{
+		if (event.channel != SyncEngine::CHANNEL_SOKUSTREAMING)
+			return state.gui.get<tgui::Label>("ChallongeWarning")->setText(event.message);
 
-		try {
-			requ.portno = state.settings.ssport;
-			requ.host = state.settings.sshost;
-			requ.httpVer = "HTTP/1.1";
-			requ.method = "GET";
-			requ.path = "/connect";
-
-			auto res = sock.makeHttpRequest(requ);
-
-			lockMutex(state.displayMutex);
-			score->getRenderer()->setTextColor("#FF8800");
-			score->setText("Warning: Invalid SokuStreaming version: GET to /connect returned " + std::to_string(res.returnCode) + " " + res.codeName);
-			state.displayMutex = false;
-		} catch (HTTPErrorException &e) {
-			lockMutex(state.displayMutex);
-			switch (e.getResponse().returnCode) {
-			case 404:
-				score->getRenderer()->setTextColor("#FF8800");
-				score->setText("Warning: Invalid SokuStreaming version: GET to /connect returned 404 " + e.getResponse().codeName);
-				break;
-			case 403:
-				score->getRenderer()->setTextColor("#FF8800");
-				score->setText("Warning: SokuStreaming refused access to /connect: " + e.getResponse().codeName);
-				break;
-			case 405:
-				score->getRenderer()->setTextColor("green");
-				score->setText("SokuStreaming works");
-				break;
-			default:
-				score->getRenderer()->setTextColor("#FF8800");
-				score->setText("Warning: Invalid SokuStreaming version: GET to /connect returned " + std::to_string(e.getResponse().returnCode) + " " + e.getResponse().codeName);
-			}
-			state.displayMutex = false;
-		} catch (std::exception &e) {
-			std::cerr << e.what() << std::endl;
-			lockMutex(state.displayMutex);
-			score->getRenderer()->setTextColor("red");
-			score->setText("Warning: Cannot connect to SokuStreaming: " + std::string(e.what()));
-			state.displayMutex = false;
-		}
+		auto label = state.gui.get<tgui::Label>("Warning");
 
-		if (state.currentTournament.empty())
-			return;
+		label->getRenderer()->setTextColor(levelColors[event.level]);
+		label->setText(event.message);
+	});
+}
 
-		auto oldState = state.tournament;
+// Called from the engine's threads, what changes the bracket is handed to the GUI thread
+void onEngineEvent(State &state, const SyncEngine::Event &event)
+{
+	auto now = std::chrono::steady_clock::now();
+	auto elapsed = [&state](std::chrono::steady_clock::time_point time){
+		return std::chrono::duration_cast<std::chrono::milliseconds>(time - state.loadStart).count();
+	};
 
-		lockMutex(state.displayMutex);
-		chw->setText("");
-		state.displayMutex = false;
-		try {
-			state.tournament = state.client.getTournamentByName(state.currentTournament);
-			if (oldState->getMatches().size() != state.tournament->getMatches().size())
-				loadChallongeTournament(state, state.currentTournament, true);
-		} catch (std::exception &e) {
-			std::cerr << e.what() << std::endl;
-			lockMutex(state.displayMutex);
-			chw->setText("Cannot refresh tournament: " + std::string(e.what()));
-			state.displayMutex = false;
-		}
+	switch (event.type) {
+	case SyncEngine::EVENT_LOADING:
+		state.ui.post([&state, now]{
+			state.loadStart = now;
+			state.timeToFirstBracket.reset();
+		});
+		setLoadStage(state, LOAD_METADATA);
+		setScoreText(state, "Loading tournament " + event.message + "...");
+		break;
+	case SyncEngine::EVENT_SNAPSHOT_LOADED:
+		buildBracketTree(state, [&state, elapsed]{
+			updateBracketState(state);
+			afterBracketUpdate(state, [&state, elapsed]{
+				state.timeToFirstBracket = elapsed(std::chrono::steady_clock::now());
+				std::cout << "Time to first bracket: " << *state.timeToFirstBracket << "ms (from snapshot)" << std::endl;
+			});
+		});
+		setScoreText(state, event.title + " (refreshing...)");
+		break;
+	case SyncEngine::EVENT_LOADED:
+		// The skeleton only needs the match list, cells stay blank until their names are filled
+		setLoadStage(state, LOAD_SKELETON);
+		std::cout << "Building bracket tree GUI" << std::endl;
+		buildBracketTree(state, [&state, elapsed, now, title = event.title]{
+			long metadataTime = elapsed(now);
+			long skeletonTime = elapsed(std::chrono::steady_clock::now());
+
+			setLoadStage(state, LOAD_NAMES);
+			updateBracketState(state);
+			afterBracketUpdate(state, [&state, elapsed, metadataTime, skeletonTime, title]{
+				long namesTime = elapsed(std::chrono::steady_clock::now());
+
+				if (!state.timeToFirstBracket) {
+					state.timeToFirstBracket = namesTime;
+					std::cout << "Time to first bracket: " << namesTime << "ms (from API)" << std::endl;
+				}
+				std::cout << "Load stages: metadata " << metadataTime << "ms, skeleton " << skeletonTime << "ms, names " << namesTime << "ms" << std::endl;
+				setScoreText(state, title, tgui::Color::Black);
 
-		try {
-			requ.portno = 14762;
-			requ.host = "delthas.fr";
-			requ.httpVer = "HTTP/1.1";
-			requ.method = "GET";
-			requ.path = "/games?tourney=" + state.currentTournament;
-
-			auto res = sock.makeHttpRequest(requ);
-			auto j = nlohmann::json::parse(res.body);
-			std::vector<KonniMatch> matches;
-
-			matches.reserve(j.size());
-			for (auto &e : j)
-				matches.emplace_back(e);
-			matchKonniHostsWithChallongeMatch(state, matches);
-			updateBracketState(state, false);
-		} catch (HTTPErrorException &e) {
-			lockMutex(state.displayMutex);
-			switch (e.getResponse().returnCode) {
-			case 404:
-				if (oldState->getMatches().empty() != state.tournament->getMatches().empty())
-					openMsgBox(state, "Discord tournament not started", "Warning: Requesting games to Konni returned 404. Are you sure you linked the tournament with your discord server using the same URL ?", MB_ICONWARNING);
-				chw->setText("Cannot refresh games: Tournament hasn't been linked with Konni.");
-				break;
-			default:
-				chw->setText("Cannot refresh games: " + std::string(e.what()));
-			}
-			state.displayMutex = false;
-		} catch (std::exception &e) {
-			std::cerr << e.what() << std::endl;
-			lockMutex(state.displayMutex);
-			chw->setText("Cannot refresh games: " + std::string(e.what()));
-			state.displayMutex = false;
-		}
-	};
+				setLoadStage(state, LOAD_PORTRAITS);
+				loadPortraits(state);
+			});
+		});
+		break;
+	case SyncEngine::EVENT_LOAD_FAILED:
+		setLoadStage(state, LOAD_DONE);
+		state.notifications.push(Notifications::LEVEL_ERROR, event.title, event.message);
+		break;
+	case SyncEngine::EVENT_STRUCTURE_CHANGED:
+		// Only the brackets that changed are laid out again
+		buildBracketTree(state, [&state, matchIds = event.matchIds]{
+			updateBracketState(state, matchIds);
+			loadPortraits(state);
+		});
+		break;
+	case SyncEngine::EVENT_MATCHES_CHANGED:
+		updateBracketState(state, event.matchIds, event.received);
+		break;
+	case SyncEngine::EVENT_HOSTS_CHANGED:
+		updateBracketState(state, event.matchIds);
+		break;
+	case SyncEngine::EVENT_STATUS:
+	case SyncEngine::EVENT_DIRECTOR:
+		setStatusText(state, event);
+		break;
+	case SyncEngine::EVENT_ERROR:
+		state.notifications.push(event.level == SyncEngine::LEVEL_WARNING ? Notifications::LEVEL_WARNING : Notifications::LEVEL_ERROR, event.title, event.message);
+		break;
+	default:
+		break;
+	}
+}
 
-	if (state.stateUpdateThread.joinable())
-		state.stateUpdateThread.join();
-	state.stateUpdateThread = std::thread([&state, fct]{
-		fct();
-		state.countdown.restart();
-	});
+// Hand what the engine needs from the settings to it
+void applySettings(State &state)
+{
+	auto config = state.engine.getConfig();
+
+	config.apikey = state.settings.apikey;
+	config.username = state.settings.username;
+	config.sshost = state.settings.sshost;
+	config.ssport = state.settings.ssport;
+	config.sokuStreamingTimeout = state.settings.sokuStreamingTimeout;
+	config.konniHost = state.settings.konniHost;
+	config.konniPort = state.settings.konniPort;
+	config.refreshRate = state.settings.refreshRate;
+	config.roundNames = state.settings.roundNames;
+	state.engine.setConfig(config);
+	state.director.setConfig(state.settings.autoDirector);
 }
 
 void openSettingsBox(State &state)
 {
 	std::shared_ptr<bool> showing = std::make_shared<bool>(false);
-	auto win = Utils::openWindowWithFocus(state.gui, 410, 220);
+	auto win = Utils::openWindowWithFocus(state.gui, 410, 250);
 	auto colorChange = [&state](tgui::Button::Ptr button, tgui::Color &col){
 		Utils::makeColorPickWindow(state.gui, [button, &col](tgui::Color color){
 			button->getRenderer()->setBackgroundColor(color);
@@ -1187,6 +723,7 @@ void openSettingsBox(State &state)
 	auto name = win->get<tgui::EditBox>("Name");
 	auto apiKey = win->get<tgui::EditBox>("APIKey");
 	auto url = win->get<tgui::EditBox>("URL");
+	auto konniUrl = win->get<tgui::EditBox>("KonniURL");
 	auto notStarted = win->get<tgui::Button>("NotStarted");
 	auto hosted = win->get<tgui::Button>("Hosted");
 	auto playing = win->get<tgui::Button>("Playing");
@@ -1201,20 +738,29 @@ void openSettingsBox(State &state)
 	});
 	refreshRate->connect("ValueChanged", [&state, label](float v){
 		state.settings.refreshRate = v;
+		applySettings(state);
 		label->setText("Refresh rate: " + std::to_string(static_cast<int>(state.settings.refreshRate)));
 	});
 	name->connect("TextChanged", [&state](std::string val){
 		state.settings.username = val;
-		state.client.setCredentials(state.settings.username, state.settings.apikey);
+		applySettings(state);
 	});
 	apiKey->connect("TextChanged", [&state](std::string val){
 		state.settings.apikey = val;
-		state.client.setCredentials(state.settings.username, state.settings.apikey);
+		applySettings(state);
 	});
 	url->connect("TextChanged", [&state](std::string val){
 		try {
 			state.settings.ssport = std::stoul(val.substr(val.find(':') + 1));
 			state.settings.sshost = val.substr(0, val.find(':'));
+			applySettings(state);
+		} catch (...) {}
+	});
+	konniUrl->connect("TextChanged", [&state](std::string val){
+		try {
+			state.settings.konniPort = std::stoul(val.substr(val.find(':') + 1));
+			state.settings.konniHost = val.substr(0, val.find(':'));
+			applySettings(state);
 		} catch (...) {}
 	});
 	notStarted->connect("Clicked", colorChange, notStarted, std::ref(state.settings.noStartedColor));
@@ -1228,6 +774,7 @@ void openSettingsBox(State &state)
 	name->setText(state.settings.username);
 	apiKey->setText(state.settings.apikey);
 	url->setText(state.settings.sshost + ":" + std::to_string(state.settings.ssport));
+	konniUrl->setText(state.settings.konniHost + ":" + std::to_string(state.settings.konniPort));
 	wasHosted->getRenderer()->setBackgroundColor(state.settings.wasHostingColor);
 	notStarted->getRenderer()->setBackgroundColor(state.settings.noStartedColor);
 	hosted->getRenderer()->setBackgroundColor(state.settings.hostingColor);
@@ -1238,6 +785,15 @@ void openSettingsBox(State &state)
 	show->setImage("icons/unvisible.png");
 }
 
+void saveMetrics(const std::string &path)
+{
+	try {
+		MetricsRegistry::save(path);
+	} catch (std::exception &e) {
+		std::cerr << "Cannot save metrics: " << e.what() << std::endl;
+	}
+}
+
 void hookGuiHandlers(State &state)
 {
 	auto menu = state.gui.get<tgui::MenuBar>("MenuBar");
@@ -1246,6 +802,17 @@ void hookGuiHandlers(State &state)
 		menu.lock()->moveToFront();
 	}, std::weak_ptr<tgui::MenuBar>(menu));
 	menu->connectMenuItem({"Edit", "Settings"}, openSettingsBox, std::ref(state));
+	menu->connectMenuItem({"Director", "Enable auto director"}, [&state]{
+		state.settings.autoDirector.enabled = true;
+		applySettings(state);
+	});
+	menu->connectMenuItem({"Director", "Disable auto director"}, [&state]{
+		state.settings.autoDirector.enabled = false;
+		applySettings(state);
+	});
+	menu->connectMenuItem({"Notifications", "Show log"}, [&state]{
+		state.notifications.openLog();
+	});
 	menu->connectMenuItem({"Tournament", "Open Challonge tournament"}, [&state]{
 		auto win = Utils::openWindowWithFocus(state.gui, 300, 40);
 		auto open = tgui::Button::create("Open");
@@ -1267,27 +834,55 @@ void hookGuiHandlers(State &state)
 	});
 }
 
-int main()
+int main(int argc, char **argv)
 {
+	std::string recordPath;
+	std::string replayPath;
+	std::string metricsPath;
+	std::string tracePath;
+	float replaySpeed = 1;
+
+	for (int i = 1; i < argc; i++)
+		if (std::string(argv[i]) == "--headless")
+			return runHeadless({argv + 1, argv + argc});
+#ifdef SIGPIPE
+	// Same as runHeadless: TLS writes to a closed connection must fail rather than kill us
+	std::signal(SIGPIPE, SIG_IGN);
+#endif
+	for (int i = 1; i + 1 < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "--record")
+			recordPath = argv[++i];
+		else if (arg == "--replay")
+			replayPath = argv[++i];
+		else if (arg == "--replay-speed")
+			replaySpeed = std::stof(argv[++i]);
+		else if (arg == "--metrics")
+			metricsPath = argv[++i];
+		else if (arg == "--trace")
+			tracePath = argv[++i];
+	}
+	if (!tracePath.empty())
+		Tracer::enable();
+
 	State state{
 		.win                   = {
 			{640, 480},
 			"Challonge Soku"
 		},
 		.gui                           = {state.win},
-		.countdown                     = {},
-		.wsock                         = {
-			.socket                = {},
-			.clientId              = {},
-			.id                    = "2",
-			.socketThread          = {},
-		},
+		.notifications                 = {state.gui},
 		.settings                      = {
 			.apikey                = APIKEY,
 			.username              = USERNAME,
 			.sshost                = "localhost",
 			.ssport                = 80,
+			.sokuStreamingTimeout  = SokuStreamingClient::defaultTimeout,
+			.konniHost             = "delthas.fr",
+			.konniPort             = 14762,
 			.refreshRate           = 10,
+			.statusPort            = 14763,
 			.useChallongeUsernames = true,
 			.noStartedColor        = "white",
 			.hostingColor          = "blue",
@@ -1305,26 +900,20 @@ int main()
 				{"pool", "Pool"},
 			}
 		},
-		.currentTournament             = {},
-		.stateUpdateThread             = {},
-		.tournament                    = {},
-		.matches                       = {},
-		.participants                  = {},
-		.group                         = {},
-		.bracket                       = {
-			.type                  = "",
-			.elim                  = {},
-			.robbin                = {},
-			.roundBounds           = {INT32_MAX, INT32_MIN}
-		},
-		.displayMutex                  = false,
-		.updateMutex                   = false,
-		.client                        = {USERNAME, APIKEY},
+		.director                      = {state.engine},
 		.defaultTexture                = {},
 		.images                        = {}
 	};
 
 	state.gui.loadWidgetsFromFile("gui/main_screen.gui");
+	state.bracketView = std::make_unique<BracketView>(
+		state.gui.get<tgui::ScrollablePanel>("Bracket"),
+		[&state](const BracketView::Cell &cell, CellVisual &visual){
+			auto lock = state.engine.lock();
+
+			describeMatch(state, visual, *cell.match);
+		}
+	);
 
 	auto refresh = state.gui.get<tgui::Label>("Refresh");
 
@@ -1334,41 +923,118 @@ int main()
 		MessageBox(nullptr, (std::string("Error: Cannot load settings: ") + e.what() + "\n\nClick OK to close the application").c_str(), "Load settings failed", MB_ICONERROR);
 		return EXIT_FAILURE;
 	}
-	state.client.setCredentials(state.settings.username, state.settings.apikey);
+	applySettings(state);
+	try {
+		if (!recordPath.empty())
+			state.engine.getTrafficLog().startRecording(recordPath);
+		else if (!replayPath.empty())
+			state.engine.getTrafficLog().startReplay(replayPath, replaySpeed);
+	} catch (std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	state.engine.addListener([&state](const SyncEngine::Event &event){
+		onEngineEvent(state, event);
+	});
+	// A port of 0 disables the status API
+	if (state.settings.statusPort) {
+		state.status = std::make_unique<StatusServer>(state.engine);
+		state.engine.addListener([&state](const SyncEngine::Event &event){
+			state.status->onEvent(event);
+		});
+		try {
+			state.status->start(state.settings.statusPort);
+		} catch (std::exception &e) {
+			std::cerr << "Cannot start status API: " << e.what() << std::endl;
+		}
+	}
+	state.engine.addListener([&state](const SyncEngine::Event &event){
+		state.director.onEvent(event);
+	});
 	hookGuiHandlers(state);
-	refreshView(state);
+	state.engine.start();
+	state.director.start();
+	if (auto url = state.engine.getTrafficLog().getRecordedTournament())
+		loadChallongeTournament(state, *url);
+
+	auto frameTime = MetricsRegistry::histogram("gui.frame_us");
+	auto receiveToRender = MetricsRegistry::histogram("websocket.receive_to_render_us");
+	auto widgets = MetricsRegistry::gauge("gui.widgets");
+	auto cells = MetricsRegistry::gauge("bracket.cells");
+	auto buttons = MetricsRegistry::gauge("bracket.buttons");
+	auto drawCalls = MetricsRegistry::gauge("bracket.draw_calls");
+	auto lastGauges = std::chrono::steady_clock::now();
+	auto lastSave = std::chrono::steady_clock::now();
+
+	Tracer::setThreadName("Main");
 	while (state.win.isOpen()) {
-		auto t = state.countdown.getElapsedTime().asSeconds();
-		int remain = state.settings.refreshRate - t + 1;
+		TRACE_SCOPE("frame");
+		auto frameStart = std::chrono::steady_clock::now();
+		int remain = state.engine.getTimeUntilRefresh() + 1;
 
 		handleEvents(state);
+		{
+			TRACE_SCOPE("ui.process");
 
-		if (remain <= 0) {
-			if (refresh->getText() != "Refreshing...")
-				refreshView(state);
+			state.ui.process();
+		}
+		applyPendingUpdate(state);
+		state.notifications.update();
+		state.bracketView->update();
+
+		if (state.engine.isRefreshing())
 			refresh->setText("Refreshing...");
-		} else
+		else
 			refresh->setText("Refreshing in " + std::to_string(remain) + " second" + (remain >= 2 ? "s" : ""));
 
-		if (!state.displayMutex) {
-			state.displayMutex = true;
+		{
+			TRACE_SCOPE("draw");
+
 			state.win.clear(sf::Color::White);
 			state.gui.draw();
-			state.displayMutex = false;
+			state.overlay.draw(state.win);
+		}
+		{
+			TRACE_SCOPE("display");
+
+			state.win.display();
+		}
+		frameTime.recordSince(frameStart);
+		if (state.renderPending) {
+			receiveToRender.recordSince(*state.renderPending);
+			state.renderPending.reset();
+		}
+		// Walking the widget tree every frame would show up in the frame time
+		if (frameStart - lastGauges >= std::chrono::seconds(1)) {
+			widgets.set(Utils::countWidgets(state.gui.getWidgets()));
+			cells.set(state.bracketView->getCellCount());
+			buttons.set(state.bracketView->getMaterializedCount());
+			drawCalls.set(state.bracketView->getDrawCallCount());
+			lastGauges = frameStart;
+		}
+		if (!metricsPath.empty() && frameStart - lastSave >= std::chrono::duration<float>(MetricsRegistry::saveInterval)) {
+			saveMetrics(metricsPath);
+			lastSave = frameStart;
 		}
-		state.win.display();
 	}
-	if (state.stateUpdateThread.joinable())
-		state.stateUpdateThread.join();
-	if (state.updateBracketThread.joinable())
-		state.updateBracketThread.join();
-	state.currentTournament.clear();
-	if (state.wsock.socket.isOpen())
-		state.wsock.socket.disconnect();
-	if (state.wsock.socketThread.joinable())
-		state.wsock.socketThread.join();
-	for (auto &thread : state.messages)
-		if (thread.joinable())
-			thread.join();
+	state.director.stop();
+	state.engine.stop();
+	if (state.status)
+		state.status->stop();
+	state.tournament.cancel();
+	state.portraitQueue.cancel();
+	state.bracketQueue.wait();
+	state.portraitQueue.wait();
+	Resolver::stop();
+	TaskPool::stop();
+	ConnectionPool::stop();
+	if (!metricsPath.empty())
+		saveMetrics(metricsPath);
+	if (!tracePath.empty())
+		try {
+			Tracer::save(tracePath);
+		} catch (std::exception &e) {
+			std::cerr << "Cannot save trace: " << e.what() << std::endl;
+		}
 	return EXIT_SUCCESS;
 }
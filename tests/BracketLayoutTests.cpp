@@ -0,0 +1,219 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <json.hpp>
+#include <BracketLayout.hpp>
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+using namespace ChallongeAPI;
+
+static std::shared_ptr<Match> makeMatch(size_t id)
+{
+	return std::make_shared<Match>(nlohmann::json{
+		{"id",                            id},
+		{"state",                         "pending"},
+		{"round",                         1},
+		{"suggested_play_order",          id},
+		{"group_id",                      nullptr},
+		{"player1_id",                    nullptr},
+		{"player2_id",                    nullptr},
+		{"winner_id",                     nullptr},
+		{"loser_id",                      nullptr},
+		{"player1_prereq_match_id",       nullptr},
+		{"player2_prereq_match_id",       nullptr},
+		{"prerequisite_match_ids_csv",    ""},
+		{"player1_is_prereq_match_loser", false},
+		{"player2_is_prereq_match_loser", false},
+		{"scores_csv",                    ""},
+	});
+}
+
+// An elimination bracket with the given number of matches in each round
+static Bracket makeElimination(const std::string &type, const std::map<int, size_t> &rounds, size_t firstId = 1)
+{
+	Bracket bracket;
+
+	bracket.type = type;
+	for (auto &round : rounds)
+		for (size_t i = 0; i < round.second; i++)
+			bracket.elim[round.first].push_back(makeMatch(firstId++));
+	return bracket;
+}
+
+static Bracket makeRoundRobin(size_t rounds, size_t matchesPerRound, size_t firstId = 1)
+{
+	Bracket bracket;
+
+	bracket.type = "round robin";
+	bracket.robbin.resize(rounds);
+	for (auto &round : bracket.robbin)
+		for (size_t i = 0; i < matchesPerRound; i++)
+			round.push_back(makeMatch(firstId++));
+	return bracket;
+}
+
+static const BracketLayout::Cell &cellOf(const BracketLayout::Result &result, const std::shared_ptr<Match> &match)
+{
+	for (auto &cell : result.cells)
+		if (cell.match == match)
+			return cell;
+	throw Test::Failure("Match " + std::to_string(match->getId()) + " has no cell");
+}
+
+static Test::Register singleElimination{"BracketLayout: elimination rounds are columns with each match between the two it comes from", []{
+	BracketLayout layout;
+	auto bracket = makeElimination("single elimination", {{1, 4}, {2, 2}, {3, 1}});
+	auto &result = layout.compute({}, bracket);
+
+	TEST_EQUAL(result.cells.size(), 7U);
+	TEST_EQUAL(result.labels.size(), 3U);
+	TEST_EQUAL(result.sections.size(), 1U);
+	TEST_EQUAL(result.sections[0].kind, BracketLayout::SECTION_SINGLE_ELIMINATION);
+	for (size_t i = 0; i < 4; i++) {
+		auto &cell = cellOf(result, bracket.elim[1][i]);
+
+		TEST_EQUAL(cell.rect.x, BracketLayout::margin);
+		TEST_EQUAL(cell.rect.y, BracketLayout::margin + BracketLayout::labelHeight + i * BracketLayout::rowHeight);
+		TEST_EQUAL(cell.rect.w, BracketLayout::cellWidth);
+		TEST_EQUAL(cell.rect.h, BracketLayout::cellHeight);
+		TEST_CHECK(!cell.isGroup);
+	}
+	for (int round = 2; round <= 3; round++)
+		for (size_t i = 0; i < bracket.elim[round].size(); i++) {
+			auto &cell = cellOf(result, bracket.elim[round][i]);
+			auto &top = cellOf(result, bracket.elim[round - 1][i * 2]);
+			auto &bottom = cellOf(result, bracket.elim[round - 1][i * 2 + 1]);
+
+			TEST_EQUAL(cell.rect.x, BracketLayout::margin + (round - 1) * BracketLayout::elimColumnSpacing);
+			TEST_EQUAL(cell.rect.y, (top.rect.y + bottom.rect.y) / 2);
+		}
+	TEST_EQUAL(result.width, BracketLayout::margin + 2 * BracketLayout::elimColumnSpacing + BracketLayout::columnWidth);
+	TEST_EQUAL(result.height, 4 * BracketLayout::rowHeight + BracketLayout::labelHeight);
+}};
+
+static Test::Register doubleElimination{"BracketLayout: the losers bracket is under the winners bracket", []{
+	BracketLayout layout;
+	auto bracket = makeElimination("double elimination", {{1, 4}, {2, 2}, {3, 1}, {4, 1}, {-1, 2}, {-2, 2}, {-3, 1}, {-4, 1}});
+	auto &result = layout.compute({}, bracket);
+	float winnersHeight = 4 * BracketLayout::rowHeight + BracketLayout::labelHeight;
+
+	TEST_EQUAL(result.cells.size(), 14U);
+	TEST_EQUAL(result.sections.size(), 2U);
+	TEST_EQUAL(result.sections[0].kind, BracketLayout::SECTION_WINNERS);
+	TEST_EQUAL(result.sections[1].kind, BracketLayout::SECTION_LOSERS);
+	TEST_EQUAL(result.sections[0].rect.y, 0);
+	TEST_EQUAL(result.sections[0].rect.h, winnersHeight);
+	TEST_EQUAL(result.sections[1].rect.y, winnersHeight);
+	TEST_EQUAL(result.height, winnersHeight + 2 * BracketLayout::rowHeight + BracketLayout::labelHeight);
+	for (auto &round : bracket.elim)
+		for (auto &match : round.second) {
+			auto &cell = cellOf(result, match);
+
+			// Losers rounds are laid out from the left like the winners ones
+			TEST_EQUAL(cell.rect.x, BracketLayout::margin + (std::abs(round.first) - 1) * BracketLayout::elimColumnSpacing);
+			if (round.first < 0)
+				TEST_CHECK(cell.rect.y >= winnersHeight);
+			else
+				TEST_CHECK(cell.rect.y + cell.rect.h <= winnersHeight);
+		}
+	// The finals are in the middle of the first round
+	TEST_EQUAL(cellOf(result, bracket.elim[4][0]).rect.y, (cellOf(result, bracket.elim[1][0]).rect.y + cellOf(result, bracket.elim[1][3]).rect.y) / 2);
+}};
+
+static Test::Register roundRobin{"BracketLayout: round robin rounds are columns of matches", []{
+	BracketLayout layout;
+	auto bracket = makeRoundRobin(3, 2);
+	auto &result = layout.compute({}, bracket);
+
+	TEST_EQUAL(result.sections.size(), 1U);
+	TEST_EQUAL(result.sections[0].kind, BracketLayout::SECTION_ROUND_ROBIN);
+	TEST_EQUAL(result.labels.size(), 3U);
+	for (size_t round = 0; round < 3; round++) {
+		TEST_EQUAL(result.labels[round].kind, BracketLayout::LABEL_ROUND);
+		TEST_EQUAL(result.labels[round].index, static_cast<int>(round + 1));
+		for (size_t i = 0; i < 2; i++) {
+			auto &cell = cellOf(result, bracket.robbin[round][i]);
+
+			TEST_EQUAL(cell.rect.x, BracketLayout::margin + round * BracketLayout::columnWidth);
+			TEST_EQUAL(cell.rect.y, BracketLayout::margin + BracketLayout::labelHeight + i * BracketLayout::rowHeight);
+		}
+	}
+	TEST_EQUAL(result.width, BracketLayout::margin + 3 * BracketLayout::columnWidth);
+	TEST_EQUAL(result.height, BracketLayout::labelHeight + 2 * BracketLayout::rowHeight);
+}};
+
+static Test::Register pools{"BracketLayout: pools are stacked on the left of the final stage", []{
+	BracketLayout layout;
+	Pool group{
+		{10, makeRoundRobin(2, 2, 1)},
+		{20, makeRoundRobin(3, 2, 5)},
+	};
+	auto bracket = makeElimination("single elimination", {{1, 2}, {2, 1}}, 100);
+	auto &result = layout.compute(group, bracket);
+	auto &groups = result.sections[0];
+
+	TEST_EQUAL(result.cells.size(), 13U);
+	TEST_EQUAL(groups.kind, BracketLayout::SECTION_GROUPS);
+	TEST_EQUAL(groups.rect.x, 0);
+	TEST_EQUAL(groups.rect.w, BracketLayout::margin + 3 * BracketLayout::columnWidth);
+
+	std::vector<const BracketLayout::Label *> poolLabels;
+
+	for (auto &label : result.labels)
+		if (label.kind == BracketLayout::LABEL_POOL)
+			poolLabels.push_back(&label);
+	TEST_EQUAL(poolLabels.size(), 2U);
+	TEST_EQUAL(poolLabels[0]->index, 0);
+	TEST_EQUAL(poolLabels[1]->index, 1);
+	TEST_CHECK(poolLabels[0]->bracket == &group[10]);
+	// The second pool starts under the first one
+	for (auto &round : group[10].robbin)
+		for (auto &match : round) {
+			TEST_CHECK(cellOf(result, match).isGroup);
+			TEST_CHECK(cellOf(result, match).rect.y + BracketLayout::cellHeight < poolLabels[1]->rect.y);
+		}
+	TEST_CHECK(cellOf(result, group[20].robbin[0][0]).rect.y > poolLabels[1]->rect.y);
+	TEST_EQUAL(cellOf(result, bracket.elim[1][0]).rect.x, groups.rect.w + BracketLayout::margin);
+	TEST_CHECK(!cellOf(result, bracket.elim[1][0]).isGroup);
+	TEST_EQUAL(result.width, groups.rect.w + BracketLayout::margin + BracketLayout::elimColumnSpacing + BracketLayout::columnWidth);
+}};
+
+static Test::Register cache{"BracketLayout: only the pools or brackets that changed are laid out again", []{
+	BracketLayout layout;
+	Pool group{
+		{10, makeRoundRobin(2, 2, 1)},
+		{20, makeRoundRobin(2, 2, 5)},
+	};
+	auto bracket = makeElimination("single elimination", {{1, 2}, {2, 1}}, 100);
+	auto first = &layout.compute(group, bracket);
+	auto firstPoolCell = cellOf(*first, group[10].robbin[0][0]).rect;
+
+	TEST_EQUAL(layout.getRelayoutCount(), 3U);
+	TEST_CHECK(&layout.compute(group, bracket) == first);
+	TEST_EQUAL(layout.getRelayoutCount(), 0U);
+
+	// A match replaced by another object is a new structure, but only for its own pool
+	group[20].robbin[1][0] = makeMatch(50);
+
+	auto &changed = layout.compute(group, bracket);
+
+	TEST_EQUAL(layout.getRelayoutCount(), 1U);
+	TEST_EQUAL(cellOf(changed, group[20].robbin[1][0]).match->getId(), 50U);
+	TEST_EQUAL(cellOf(changed, group[10].robbin[0][0]).rect.x, firstPoolCell.x);
+	TEST_EQUAL(cellOf(changed, group[10].robbin[0][0]).rect.y, firstPoolCell.y);
+
+	// A bigger pool moves the final stage to the right without laying it out again
+	group[10].robbin.push_back({makeMatch(60)});
+
+	auto oldX = cellOf(changed, bracket.elim[1][0]).rect.x;
+	auto &moved = layout.compute(group, bracket);
+
+	TEST_EQUAL(layout.getRelayoutCount(), 1U);
+	TEST_EQUAL(cellOf(moved, bracket.elim[1][0]).rect.x, oldX + BracketLayout::columnWidth);
+
+	layout.invalidate();
+	layout.compute(group, bracket);
+	TEST_EQUAL(layout.getRelayoutCount(), 3U);
+}};
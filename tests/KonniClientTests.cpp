@@ -0,0 +1,210 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <map>
+#include <mutex>
+#include <json.hpp>
+#include <KonniClient.hpp>
+#include <TrafficLog.hpp>
+#include "StandInServer.hpp"
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+using Test::StandInServer;
+
+// Keeps a game list and its history, and answers like Konni: conditional requests get a 304 when
+// nothing changed, and if deltas are enabled, requests with a since token only get what changed.
+class StandInKonni {
+public:
+	StandInServer server;
+
+	StandInKonni(bool deltas, const std::string &etagHeader = "ETag") :
+		server([this](const StandInServer::Request &request){ return this->_answer(request); }),
+		_deltas(deltas),
+		_etagHeader(etagHeader)
+	{
+	}
+
+	void setGame(const std::string &ip, const std::string &hostName, unsigned spectators)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_games[ip] = {
+			{"ip",          ip},
+			{"host_name",   hostName},
+			{"client_name", "Client of " + hostName},
+			{"spectators",  spectators},
+			{"started",     false},
+			{"start",       0},
+		};
+		this->_changed[ip] = ++this->_version;
+	}
+
+	void removeGame(const std::string &ip)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		this->_games.erase(ip);
+		this->_changed[ip] = ++this->_version;
+	}
+
+private:
+	std::mutex _mutex;
+	bool _deltas;
+	std::string _etagHeader;
+	unsigned _version = 0;
+	std::map<std::string, nlohmann::json> _games;
+	// Version at which each game last changed, removed ones included
+	std::map<std::string, unsigned> _changed;
+
+	std::string _answer(const StandInServer::Request &request)
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+		auto etag = "\"" + std::to_string(this->_version) + "\"";
+		auto it = request.header.find("If-None-Match");
+		auto sincePos = request.path.find("&since=");
+		nlohmann::json body = nlohmann::json::array();
+
+		if (request.path.find("/games?tourney=") != 0)
+			return StandInServer::response(404, "Not Found", "");
+		if (it != request.header.end() && it->second == etag)
+			return StandInServer::response(304, "Not Modified", "", {{this->_etagHeader, etag}});
+		if (!this->_deltas) {
+			for (auto &game : this->_games)
+				body.push_back(game.second);
+			return StandInServer::response(200, "OK", body.dump(), {{this->_etagHeader, etag}});
+		}
+		if (sincePos == std::string::npos) {
+			for (auto &game : this->_games)
+				body.push_back(game.second);
+			body = {{"full", true}, {"games", body}};
+		} else {
+			auto since = std::stoul(request.path.substr(sincePos + 7));
+			auto removed = nlohmann::json::array();
+
+			for (auto &change : this->_changed) {
+				if (change.second <= since)
+					continue;
+				if (this->_games.count(change.first))
+					body.push_back(this->_games[change.first]);
+				else
+					removed.push_back(change.first);
+			}
+			body = {{"games", body}, {"removed", removed}};
+		}
+		body["since"] = std::to_string(this->_version);
+		return StandInServer::response(200, "OK", body.dump(), {{this->_etagHeader, etag}});
+	}
+};
+
+static Test::Register unchangedList{"KonniClient: an unchanged game list is not transferred again", []{
+	StandInKonni konni{false};
+	KonniClient client{"127.0.0.1", konni.server.getPort()};
+	TrafficLog traffic;
+
+	konni.setGame("1.2.3.4:10800", "Alice", 0);
+	konni.setGame("5.6.7.8:10800", "Bob", 2);
+
+	auto first = client.poll("tourney", traffic);
+
+	TEST_CHECK(first.changed);
+	TEST_EQUAL(first.added, 2U);
+	TEST_EQUAL(client.getGames().size(), 2U);
+
+	auto second = client.poll("tourney", traffic);
+	auto requests = konni.server.getRequests();
+
+	TEST_CHECK(!second.changed);
+	TEST_EQUAL(requests.size(), 2U);
+	TEST_CHECK(!requests[0].header.count("If-None-Match"));
+	TEST_EQUAL(requests[1].header["If-None-Match"], "\"2\"");
+	TEST_EQUAL(client.getGames().size(), 2U);
+	TEST_EQUAL(client.getGames()[0].port, 10800);
+}};
+
+static Test::Register etagCase{"KonniClient: the ETag header is found whatever its case", []{
+	StandInKonni konni{false, "etag"};
+	KonniClient client{"127.0.0.1", konni.server.getPort()};
+	TrafficLog traffic;
+
+	konni.setGame("1.2.3.4:10800", "Alice", 0);
+	client.poll("tourney", traffic);
+	TEST_CHECK(!client.poll("tourney", traffic).changed);
+
+	auto requests = konni.server.getRequests();
+
+	TEST_EQUAL(requests.size(), 2U);
+	TEST_EQUAL(requests[1].header["If-None-Match"], "\"1\"");
+}};
+
+static Test::Register fullListChanges{"KonniClient: a full list only converts the games which changed", []{
+	StandInKonni konni{false};
+	KonniClient client{"127.0.0.1", konni.server.getPort()};
+	TrafficLog traffic;
+
+	konni.setGame("1.2.3.4:10800", "Alice", 0);
+	konni.setGame("5.6.7.8:10800", "Bob", 0);
+	konni.setGame("9.9.9.9:10800", "Carol", 0);
+	client.poll("tourney", traffic);
+	konni.setGame("1.2.3.4:10800", "Alice", 3);
+	konni.removeGame("5.6.7.8:10800");
+	konni.setGame("4.4.4.4:10800", "Dave", 0);
+
+	auto result = client.poll("tourney", traffic);
+
+	TEST_CHECK(result.changed);
+	TEST_EQUAL(result.added, 1U);
+	TEST_EQUAL(result.updated, 1U);
+	TEST_EQUAL(result.removed, 1U);
+	TEST_EQUAL(client.getGames().size(), 3U);
+	for (auto &game : client.getGames())
+		if (game.hostName == "Alice")
+			TEST_EQUAL(game.spectators, 3U);
+}};
+
+static Test::Register deltaPolls{"KonniClient: polls after a since token only get the changes", []{
+	StandInKonni konni{true};
+	KonniClient client{"127.0.0.1", konni.server.getPort()};
+	TrafficLog traffic;
+
+	konni.setGame("1.2.3.4:10800", "Alice", 0);
+	konni.setGame("5.6.7.8:10800", "Bob", 0);
+
+	auto first = client.poll("tourney", traffic);
+
+	TEST_EQUAL(first.added, 2U);
+	konni.setGame("1.2.3.4:10800", "Alice", 1);
+	konni.removeGame("5.6.7.8:10800");
+
+	auto second = client.poll("tourney", traffic);
+	auto third = client.poll("tourney", traffic);
+	auto requests = konni.server.getRequests();
+
+	TEST_EQUAL(requests.size(), 3U);
+	TEST_EQUAL(requests[0].path, "/games?tourney=tourney");
+	TEST_EQUAL(requests[1].path, "/games?tourney=tourney&since=2");
+	TEST_EQUAL(requests[2].path, "/games?tourney=tourney&since=4");
+	TEST_EQUAL(second.added, 0U);
+	TEST_EQUAL(second.updated, 1U);
+	TEST_EQUAL(second.removed, 1U);
+	TEST_CHECK(!third.changed);
+	TEST_EQUAL(client.getGames().size(), 1U);
+	TEST_EQUAL(client.getGames()[0].spectators, 1U);
+}};
+
+static Test::Register tournamentChange{"KonniClient: another tournament starts over without the since token", []{
+	StandInKonni konni{true};
+	KonniClient client{"127.0.0.1", konni.server.getPort()};
+	TrafficLog traffic;
+
+	konni.setGame("1.2.3.4:10800", "Alice", 0);
+	client.poll("tourney", traffic);
+	client.poll("other", traffic);
+
+	auto requests = konni.server.getRequests();
+
+	TEST_EQUAL(requests.size(), 2U);
+	TEST_EQUAL(requests[1].path, "/games?tourney=other");
+	TEST_CHECK(!requests[1].header.count("If-None-Match"));
+}};
@@ -0,0 +1,207 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closeSocket closesocket
+#else
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#define closeSocket close
+#endif
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <cstring>
+#include <Resolver.hpp>
+#include <TaskPool.hpp>
+#include "StandInServer.hpp"
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+using Test::StandInServer;
+
+// Answers lookups instead of getaddrinfo while it exists, and counts them
+class StubResolver {
+public:
+	std::atomic<unsigned> lookups{0};
+
+	StubResolver(const std::function<Resolver::Lookup (unsigned index)> &answer)
+	{
+		Resolver::setLookupFunction([this, answer](const std::string &, unsigned short){
+			return answer(this->lookups++);
+		});
+	}
+
+	~StubResolver()
+	{
+		Resolver::setLookupFunction(nullptr);
+	}
+
+	bool waitForLookups(unsigned count)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+		while (this->lookups < count) {
+			if (std::chrono::steady_clock::now() > deadline)
+				return false;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return true;
+	}
+};
+
+static Resolver::Address makeAddress(const char *ip, unsigned short port)
+{
+	sockaddr_in address{};
+	auto data = reinterpret_cast<const unsigned char *>(&address);
+
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, ip, &address.sin_addr);
+	return {AF_INET, SOCK_STREAM, 0, {data, data + sizeof(address)}};
+}
+
+static Resolver::Lookup makeLookup(std::vector<Resolver::Address> addresses, std::chrono::duration<float> age = {})
+{
+	Resolver::Lookup result;
+
+	result.addresses = std::move(addresses);
+	result.resolved = Resolver::Clock::now() - std::chrono::duration_cast<Resolver::Clock::duration>(age);
+	return result;
+}
+
+static Resolver::Clock::time_point inSeconds(int seconds)
+{
+	return Resolver::Clock::now() + std::chrono::seconds(seconds);
+}
+
+static Test::Register cached{"Resolver: a host is looked up once while its answer is fresh", []{
+	StubResolver stub{[](unsigned){
+		return makeLookup({makeAddress("10.0.0.1", 80)});
+	}};
+
+	for (int i = 0; i < 3; i++)
+		TEST_EQUAL(Resolver::resolve("cached.test", 80, inSeconds(5)).size(), 1U);
+	TEST_EQUAL(stub.lookups, 1U);
+
+	// Another port is another entry
+	Resolver::resolve("cached.test", 81, inSeconds(5));
+	TEST_EQUAL(stub.lookups, 2U);
+}};
+
+static Test::Register shared{"Resolver: concurrent lookups of a host share the same one", []{
+	StubResolver stub{[](unsigned){
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		return makeLookup({makeAddress("10.0.0.1", 80)});
+	}};
+	auto first = Resolver::resolveAsync("shared.test", 80);
+	auto second = Resolver::resolveAsync("shared.test", 80);
+
+	TEST_EQUAL(first.get().addresses.size(), 1U);
+	TEST_EQUAL(second.get().addresses.size(), 1U);
+	TEST_EQUAL(stub.lookups, 1U);
+}};
+
+static Test::Register expired{"Resolver: an expired answer is used while it is refreshed", []{
+	StubResolver stub{[](unsigned index){
+		if (index == 0)
+			return makeLookup({makeAddress("10.0.0.1", 80)}, std::chrono::duration<float>(Resolver::ttl + 1));
+		return makeLookup({makeAddress("10.0.0.2", 80), makeAddress("10.0.0.3", 80)});
+	}};
+
+	TEST_EQUAL(Resolver::resolve("expired.test", 80, inSeconds(5)).size(), 1U);
+	// The expired answer is given right away, and the refresh starts
+	TEST_EQUAL(Resolver::resolve("expired.test", 80, inSeconds(5)).size(), 1U);
+	TEST_CHECK(stub.waitForLookups(2));
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+	while (Resolver::resolve("expired.test", 80, inSeconds(5)).size() != 2) {
+		TEST_CHECK(std::chrono::steady_clock::now() < deadline);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	TEST_EQUAL(stub.lookups, 2U);
+}};
+
+static Test::Register negative{"Resolver: failures are kept for a while", []{
+	StubResolver stub{[](unsigned index){
+		auto result = makeLookup({});
+
+		// The second host's failure is already too old to be kept
+		if (index != 0)
+			result = makeLookup({}, std::chrono::duration<float>(Resolver::negativeTtl + 1));
+		result.error = "Cannot resolve";
+		return result;
+	}};
+
+	for (int i = 0; i < 2; i++) {
+		try {
+			Resolver::resolve("negative.test", 80, inSeconds(5));
+			TEST_CHECK(!"resolved");
+		} catch (Test::Failure &) {
+			throw;
+		} catch (std::runtime_error &e) {
+			TEST_EQUAL(std::string(e.what()), "Cannot resolve");
+		}
+	}
+	TEST_EQUAL(stub.lookups, 1U);
+	for (int i = 0; i < 2; i++)
+		Resolver::resolveAsync("expiredNegative.test", 80).wait();
+	TEST_EQUAL(stub.lookups, 3U);
+}};
+
+static Test::Register fallback{"Resolver: connect moves on to the next address when one is refused", []{
+	StandInServer server{[](const StandInServer::Request &){
+		return StandInServer::response(200, "OK", "");
+	}};
+	// Bound but not listening, so connecting to it is refused
+	intptr_t closed = ::socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address{};
+	socklen_t size = sizeof(address);
+
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	bind(closed, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+	getsockname(closed, reinterpret_cast<sockaddr *>(&address), &size);
+
+	StubResolver stub{[&address, &server](unsigned){
+		return makeLookup({makeAddress("127.0.0.1", ntohs(address.sin_port)), makeAddress("127.0.0.1", server.getPort())});
+	}};
+	auto sock = Resolver::connect("fallback.test", 80, inSeconds(5));
+	sockaddr_in peer{};
+
+	size = sizeof(peer);
+	getpeername(sock, reinterpret_cast<sockaddr *>(&peer), &size);
+	closeSocket(sock);
+	closeSocket(closed);
+	TEST_EQUAL(ntohs(peer.sin_port), server.getPort());
+}};
+
+static Test::Register busyPool{"Resolver: lookups are made while every TaskPool worker waits for one", []{
+	StubResolver stub{[](unsigned){
+		return makeLookup({makeAddress("10.0.0.1", 80)});
+	}};
+	std::vector<std::future<bool>> results;
+
+	// Like ConnectionPool's tasks connecting to as many hosts
+	for (size_t i = 0; i < TaskPool::getWorkerCount(); i++) {
+		auto promise = std::make_shared<std::promise<bool>>();
+
+		results.push_back(promise->get_future());
+		TaskPool::post("ResolverTests::resolve", [promise, i]{
+			try {
+				promise->set_value(!Resolver::resolve("busy" + std::to_string(i) + ".test", 80, inSeconds(2)).empty());
+			} catch (std::exception &) {
+				promise->set_value(false);
+			}
+		});
+	}
+	for (auto &result : results)
+		TEST_CHECK(result.get());
+}};
@@ -0,0 +1,89 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <string>
+#include <Exceptions.hpp>
+#include <SecuredWebSocket.hpp>
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+
+// Reads a stream that was written beforehand, like the socket would
+class StreamReader {
+public:
+	StreamReader(const std::string &data) :
+		_data(data)
+	{
+	}
+
+	std::string operator()(size_t size)
+	{
+		if (this->_pos + size > this->_data.size())
+			throw ChallongeAPI::EOFException("End of stream");
+
+		auto result = this->_data.substr(this->_pos, size);
+
+		this->_pos += size;
+		return result;
+	}
+
+	bool isOver() const
+	{
+		return this->_pos == this->_data.size();
+	}
+
+private:
+	std::string _data;
+	size_t _pos = 0;
+};
+
+static Test::Register roundTrip{"SecuredWebSocket: frames are decoded as they were encoded", []{
+	for (size_t size : {0, 5, 125, 126, 300, 70000}) {
+		std::string payload(size, 'a');
+
+		for (size_t i = 0; i < size; i++)
+			payload[i] = static_cast<char>(i * 7);
+
+		StreamReader reader{SecuredWebSocket::encodeFrame(0x1, payload, 0xDEADBEEF)};
+		auto frame = SecuredWebSocket::decodeFrame(std::ref(reader));
+
+		TEST_EQUAL(frame.opcode, 0x1);
+		TEST_CHECK(frame.isEnd);
+		TEST_CHECK(frame.payload == payload);
+		TEST_CHECK(reader.isOver());
+	}
+}};
+
+static Test::Register pingPayload{"SecuredWebSocket: a ping's payload is read and echoed by the pong", []{
+	StreamReader reader{
+		SecuredWebSocket::encodeFrame(0x9, "heartbeat", 0x01020304) +
+		SecuredWebSocket::encodeFrame(0x1, "{\"channel\":\"/meta/connect\"}", 0x05060708)
+	};
+	auto ping = SecuredWebSocket::decodeFrame(std::ref(reader));
+
+	TEST_EQUAL(ping.opcode, 0x9);
+	TEST_EQUAL(ping.payload, "heartbeat");
+
+	// What getAnswer sends back
+	StreamReader pongReader{SecuredWebSocket::encodeFrame(0xA, ping.payload, 0x11223344)};
+	auto pong = SecuredWebSocket::decodeFrame(std::ref(pongReader));
+
+	TEST_EQUAL(pong.opcode, 0xA);
+	TEST_EQUAL(pong.payload, "heartbeat");
+
+	// The ping's payload isn't taken for the next frame's header
+	auto message = SecuredWebSocket::decodeFrame(std::ref(reader));
+
+	TEST_EQUAL(message.opcode, 0x1);
+	TEST_EQUAL(message.payload, "{\"channel\":\"/meta/connect\"}");
+	TEST_CHECK(reader.isOver());
+}};
+
+static Test::Register unmaskedFrames{"SecuredWebSocket: frames from the server are not masked", []{
+	StreamReader reader{std::string("\x81\x05hello", 7)};
+	auto frame = SecuredWebSocket::decodeFrame(std::ref(reader));
+
+	TEST_EQUAL(frame.opcode, 0x1);
+	TEST_EQUAL(frame.payload, "hello");
+}};
@@ -0,0 +1,180 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <json.hpp>
+#include <SokuStreamingClient.hpp>
+#include "StandInServer.hpp"
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+using Test::StandInServer;
+
+static const SokuStreamingClient::Request request{"Alice \"the\" \\ best", "Bob\n", "Grand final", "1.2.3.4", 10800};
+
+static Test::Register keepAlive{"SokuStreamingClient: joins are pipelined on a kept alive connection", []{
+	StandInServer server{[](const StandInServer::Request &){
+		return StandInServer::response(200, "OK", "{}");
+	}};
+	SokuStreamingClient client;
+
+	client.setEndpoint("127.0.0.1", server.getPort());
+	for (int i = 0; i < 2; i++) {
+		auto result = client.joinSync(request);
+
+		TEST_CHECK(result.success);
+		TEST_EQUAL(result.error, "");
+	}
+
+	auto requests = server.getRequests();
+
+	TEST_EQUAL(server.getConnectionCount(), 1U);
+	TEST_EQUAL(requests.size(), 4U);
+	TEST_EQUAL(requests[0].path, "/state");
+	TEST_EQUAL(requests[1].path, "/connect");
+	TEST_EQUAL(nlohmann::json::parse(requests[0].body)["left"]["name"], request.leftName);
+	TEST_EQUAL(nlohmann::json::parse(requests[0].body)["right"]["name"], request.rightName);
+	TEST_EQUAL(nlohmann::json::parse(requests[1].body)["port"], 10800);
+}};
+
+static Test::Register closedConnection{"SokuStreamingClient: a connection closed by SokuStreaming is opened again", []{
+	StandInServer server{[](const StandInServer::Request &){
+		return StandInServer::response(200, "OK", "{}", {{"Connection", "close"}});
+	}};
+	SokuStreamingClient client;
+
+	client.setEndpoint("127.0.0.1", server.getPort());
+	for (int i = 0; i < 2; i++) {
+		auto result = client.joinSync(request);
+
+		TEST_CHECK(result.success);
+		TEST_EQUAL(result.error, "");
+		TEST_EQUAL(result.stateCode, 200);
+		TEST_EQUAL(result.connectCode, 200);
+	}
+
+	auto requests = server.getRequests();
+
+	// The pipelined /connect isn't answered on a closed connection, it is sent again on another one
+	TEST_EQUAL(server.getConnectionCount(), 4U);
+	TEST_EQUAL(requests.size(), 4U);
+	for (size_t i = 0; i < requests.size(); i++)
+		TEST_EQUAL(requests[i].path, i % 2 ? "/connect" : "/state");
+	TEST_EQUAL(nlohmann::json::parse(requests[1].body)["port"], 10800);
+}};
+
+static Test::Register chunked{"SokuStreamingClient: chunked answers are read up to their end", []{
+	StandInServer server{[](const StandInServer::Request &request){
+		if (request.path == "/state")
+			return StandInServer::response(200, "OK", "4\r\n{\"a\"\r\n3;ext=1\r\n:1}\r\n0\r\nX-Trailer: 1\r\n\r\n", {{"Transfer-Encoding", "chunked"}});
+		return StandInServer::response(202, "Accepted", "{}");
+	}};
+	SokuStreamingClient client;
+
+	client.setEndpoint("127.0.0.1", server.getPort());
+	for (int i = 0; i < 2; i++) {
+		auto result = client.joinSync(request);
+
+		TEST_EQUAL(result.error, "");
+		TEST_EQUAL(result.stateCode, 200);
+		TEST_EQUAL(result.connectCode, 202);
+	}
+	TEST_EQUAL(server.getConnectionCount(), 1U);
+}};
+
+static Test::Register noLength{"SokuStreamingClient: an answer without a length fails without waiting for the timeout", []{
+	StandInServer server{[](const StandInServer::Request &){
+		return std::string("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{}");
+	}};
+	SokuStreamingClient client;
+	auto start = std::chrono::steady_clock::now();
+
+	client.setEndpoint("127.0.0.1", server.getPort());
+	client.setTimeout(5);
+
+	auto result = client.joinSync(request);
+
+	TEST_CHECK(!result.success);
+	TEST_CHECK(!result.error.empty());
+	TEST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+}};
+
+static Test::Register timeout{"SokuStreamingClient: a join is over once the timeout is reached", []{
+	StandInServer server{[](const StandInServer::Request &){
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		return StandInServer::response(200, "OK", "{}");
+	}};
+	SokuStreamingClient client;
+	auto start = std::chrono::steady_clock::now();
+
+	client.setEndpoint("127.0.0.1", server.getPort());
+	client.setTimeout(0.2);
+
+	auto result = client.joinSync(request);
+
+	TEST_CHECK(!result.success);
+	TEST_EQUAL(result.error, "SokuStreaming timed out");
+	TEST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(450));
+}};
+
+static Test::Register reopenedTimeout{"SokuStreamingClient: opening the connection again doesn't give the join more time", []{
+	std::atomic<unsigned> count{0};
+	StandInServer server{[&count](const StandInServer::Request &){
+		auto index = count++;
+
+		// The first join keeps the connection alive
+		if (index < 2)
+			return StandInServer::response(200, "OK", "{}");
+		// Then SokuStreaming closes it, but only once the second join waited for a while
+		if (index == 2) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			return std::string();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(120));
+		return StandInServer::response(200, "OK", "{}");
+	}};
+	SokuStreamingClient client;
+
+	client.setEndpoint("127.0.0.1", server.getPort());
+	client.setTimeout(0.3);
+	TEST_CHECK(client.joinSync(request).success);
+
+	auto start = std::chrono::steady_clock::now();
+	auto result = client.joinSync(request);
+
+	TEST_CHECK(!result.success);
+	TEST_EQUAL(result.error, "SokuStreaming timed out");
+	TEST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(450));
+}};
+
+static Test::Register dropped{"SokuStreamingClient: joins still queued are answered when the client is destroyed", []{
+	StandInServer server{[](const StandInServer::Request &){
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		return StandInServer::response(200, "OK", "{}");
+	}};
+	std::mutex mutex;
+	std::vector<std::string> errors;
+
+	{
+		SokuStreamingClient client;
+
+		client.setEndpoint("127.0.0.1", server.getPort());
+		for (int i = 0; i < 3; i++)
+			client.join(request, [&mutex, &errors](const SokuStreamingClient::Result &result){
+				std::unique_lock<std::mutex> lock{mutex};
+
+				errors.push_back(result.error);
+			});
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	// The first join was running, so it was waited for
+	TEST_EQUAL(errors.size(), 3U);
+	TEST_EQUAL(errors[0], "SokuStreaming client stopped");
+	TEST_EQUAL(errors[1], "SokuStreaming client stopped");
+	TEST_EQUAL(errors[2], "");
+}};
@@ -0,0 +1,196 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closeSocket closesocket
+#else
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#define closeSocket close
+#endif
+#include <stdexcept>
+#include "StandInServer.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace ChallongeSoku::Test
+{
+	StandInServer::StandInServer(const Handler &handler) :
+		_handler(handler)
+	{
+		sockaddr_in addr{};
+		socklen_t size = sizeof(addr);
+
+#ifdef _WIN32
+		WSADATA data;
+
+		WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+		this->_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		if (
+			this->_socket < 0 ||
+			::bind(this->_socket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+			::listen(this->_socket, 16) != 0 ||
+			::getsockname(this->_socket, reinterpret_cast<sockaddr *>(&addr), &size) != 0
+		) {
+			if (this->_socket >= 0)
+				closeSocket(this->_socket);
+			throw std::runtime_error("Cannot open the stand-in server");
+		}
+		this->_port = ntohs(addr.sin_port);
+		this->_thread = std::thread(&StandInServer::_loop, this);
+	}
+
+	StandInServer::~StandInServer()
+	{
+		this->_running = false;
+		this->_thread.join();
+		closeSocket(this->_socket);
+	}
+
+	unsigned short StandInServer::getPort() const
+	{
+		return this->_port;
+	}
+
+	std::vector<StandInServer::Request> StandInServer::getRequests() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_requests;
+	}
+
+	size_t StandInServer::getConnectionCount() const
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_connections;
+	}
+
+	std::string StandInServer::response(int code, const std::string &codeName, const std::string &body, const std::map<std::string, std::string> &header)
+	{
+		std::string result = "HTTP/1.1 " + std::to_string(code) + " " + codeName + "\r\n";
+
+		for (auto &field : header)
+			result += field.first + ": " + field.second + "\r\n";
+		if (!header.count("Content-Length") && !header.count("Transfer-Encoding"))
+			result += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+		return result + "\r\n" + body;
+	}
+
+	// Wait for something to read, checking every now and then if the server is stopping
+	bool StandInServer::_wait(intptr_t sock)
+	{
+		while (this->_running) {
+			fd_set set;
+			timeval timeout{0, 50000};
+
+			FD_ZERO(&set);
+			FD_SET(sock, &set);
+			if (::select(sock + 1, &set, nullptr, nullptr, &timeout) > 0)
+				return true;
+		}
+		return false;
+	}
+
+	void StandInServer::_loop()
+	{
+		while (this->_wait(this->_socket)) {
+			auto client = ::accept(this->_socket, nullptr, nullptr);
+
+			if (client < 0)
+				continue;
+			{
+				std::unique_lock<std::mutex> lock{this->_mutex};
+
+				this->_connections++;
+			}
+			this->_serve(client);
+			closeSocket(client);
+		}
+	}
+
+	void StandInServer::_serve(intptr_t client)
+	{
+		std::string buffer;
+		char data[4096];
+
+		while (true) {
+			auto end = buffer.find("\r\n\r\n");
+
+			if (end == std::string::npos) {
+				if (!this->_wait(client))
+					return;
+
+				auto received = ::recv(client, data, sizeof(data), 0);
+
+				if (received <= 0)
+					return;
+				buffer.append(data, received);
+				continue;
+			}
+
+			Request request;
+			size_t pos = buffer.find("\r\n");
+			auto line = buffer.substr(0, pos);
+			auto space = line.find(' ');
+
+			request.method = line.substr(0, space);
+			request.path = line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+			while (pos < end) {
+				auto next = buffer.find("\r\n", pos + 2);
+				auto field = buffer.substr(pos + 2, next - pos - 2);
+				auto colon = field.find(':');
+
+				if (colon != std::string::npos)
+					request.header[field.substr(0, colon)] = field.substr(field.find_first_not_of(' ', colon + 1));
+				pos = next;
+			}
+
+			auto length = request.header.count("Content-Length") ? std::stoul(request.header["Content-Length"]) : 0;
+
+			while (buffer.size() < end + 4 + length) {
+				if (!this->_wait(client))
+					return;
+
+				auto received = ::recv(client, data, sizeof(data), 0);
+
+				if (received <= 0)
+					return;
+				buffer.append(data, received);
+			}
+			request.body = buffer.substr(end + 4, length);
+			buffer.erase(0, end + 4 + length);
+			{
+				std::unique_lock<std::mutex> lock{this->_mutex};
+
+				this->_requests.push_back(request);
+			}
+
+			auto answer = this->_handler(request);
+
+			if (answer.empty())
+				return;
+			for (size_t sent = 0; sent < answer.size(); ) {
+				auto count = ::send(client, answer.data() + sent, answer.size() - sent, MSG_NOSIGNAL);
+
+				if (count <= 0)
+					return;
+				sent += count;
+			}
+			if (request.header["Connection"] != "keep-alive" || answer.find("\r\nConnection: close\r\n") < answer.find("\r\n\r\n"))
+				return;
+		}
+	}
+}
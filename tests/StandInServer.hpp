@@ -0,0 +1,63 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_STANDINSERVER_HPP
+#define CHALLONGESOKU_STANDINSERVER_HPP
+
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+
+namespace ChallongeSoku::Test
+{
+	//! @brief HTTP server on the loopback, standing in for Konni or SokuStreaming.
+	//! @details Connections are served one after the other on a background thread. A connection is kept
+	//! open after a response only if the request asked for it with "Connection: keep-alive", and the response
+	//! doesn't say "Connection: close".
+	class StandInServer {
+	public:
+		struct Request {
+			std::string method;
+			std::string path;
+			std::map<std::string, std::string> header;
+			std::string body;
+		};
+
+		//! @return The whole response, or an empty string to close the connection without answering.
+		typedef std::function<std::string (const Request &request)> Handler;
+
+		//! @throw std::runtime_error No port could be opened.
+		StandInServer(const Handler &handler);
+		~StandInServer();
+
+		unsigned short getPort() const;
+		//! @brief Every request received so far.
+		std::vector<Request> getRequests() const;
+		size_t	getConnectionCount() const;
+
+		static std::string response(int code, const std::string &codeName, const std::string &body, const std::map<std::string, std::string> &header = {});
+
+	private:
+		Handler _handler;
+		intptr_t _socket;
+		unsigned short _port;
+		std::atomic<bool> _running{true};
+		mutable std::mutex _mutex;
+		std::vector<Request> _requests;
+		size_t _connections = 0;
+		std::thread _thread;
+
+		void	_loop();
+		void	_serve(intptr_t client);
+		bool	_wait(intptr_t sock);
+	};
+}
+
+
+#endif //CHALLONGESOKU_STANDINSERVER_HPP
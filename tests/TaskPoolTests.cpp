@@ -0,0 +1,216 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <TaskPool.hpp>
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+
+// Tells when the task holding it is destroyed, whether it ran or was dropped
+class Released {
+private:
+	std::promise<void> _promise;
+
+public:
+	std::future<void> future = this->_promise.get_future();
+
+	~Released()
+	{
+		this->_promise.set_value();
+	}
+};
+
+// Keeps tasks running until opened, so the ones posted after them have to wait
+class Gate {
+public:
+	void wait()
+	{
+		this->_opened.wait();
+	}
+
+	void open()
+	{
+		this->_promise.set_value();
+	}
+
+private:
+	std::promise<void> _promise;
+	std::shared_future<void> _opened = this->_promise.get_future().share();
+};
+
+static bool isReady(std::future<void> &future)
+{
+	return future.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+}
+
+static bool waitFor(const std::atomic<size_t> &value, size_t expected)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+	while (value < expected) {
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return true;
+}
+
+static Test::Register posts{"TaskPool: posted tasks run on the workers", []{
+	std::atomic<size_t> ran{0};
+	std::atomic<bool> onMainThread{false};
+	auto mainThread = std::this_thread::get_id();
+
+	for (size_t i = 0; i < 100; i++)
+		TEST_CHECK(TaskPool::post("TaskPoolTests::post", [&ran, &onMainThread, mainThread]{
+			onMainThread = onMainThread || std::this_thread::get_id() == mainThread;
+			ran++;
+		}));
+	TEST_CHECK(waitFor(ran, 100));
+	TEST_CHECK(!onMainThread);
+}};
+
+static Test::Register nested{"TaskPool: tasks posted from a task run as well", []{
+	// The last level may still be in set_value once the test is over
+	auto done = std::make_shared<std::promise<void>>();
+	auto future = done->get_future();
+	std::atomic<size_t> depth{0};
+
+	// Each level posts the next one from its worker
+	std::function<void ()> level = [&level, &depth, done]{
+		if (++depth == 10)
+			return done->set_value();
+		TaskPool::post("TaskPoolTests::nested", level);
+	};
+
+	TaskPool::post("TaskPoolTests::nested", level);
+	TEST_CHECK(isReady(future));
+	TEST_EQUAL(depth, 10U);
+}};
+
+static Test::Register cancelledPost{"TaskPool: tasks whose token is cancelled are dropped", []{
+	CancellationSource source;
+	auto token = source.getToken();
+	auto guard = std::make_shared<Released>();
+	auto future = std::move(guard->future);
+	std::atomic<bool> ran{false};
+
+	source.cancel();
+	TEST_CHECK(!source.getToken().isCancelled());
+	TaskPool::post("TaskPoolTests::cancelled", [guard, &ran]{
+		ran = true;
+	}, token);
+	guard.reset();
+	TEST_CHECK(isReady(future));
+	TEST_CHECK(!ran);
+}};
+
+static Test::Register queueOrder{"TaskQueue: tasks run one after the other, in the order they were posted", []{
+	TaskQueue queue{"TaskPoolTests::order"};
+	std::vector<size_t> order;
+	std::atomic<size_t> running{0};
+	std::atomic<bool> overlapped{false};
+
+	for (size_t i = 0; i < 100; i++)
+		queue.post([i, &order, &running, &overlapped]{
+			overlapped = overlapped || running++ != 0;
+			order.push_back(i);
+			std::this_thread::yield();
+			running--;
+		});
+	queue.wait();
+	TEST_CHECK(!overlapped);
+	TEST_EQUAL(order.size(), 100U);
+	for (size_t i = 0; i < order.size(); i++)
+		TEST_EQUAL(order[i], i);
+}};
+
+static Test::Register queueCancel{"TaskQueue: cancelling drops the tasks which didn't start", []{
+	TaskQueue queue{"TaskPoolTests::cancel"};
+	CancellationSource source;
+	Gate gate;
+	std::atomic<size_t> started{0};
+	std::atomic<size_t> ran{0};
+	auto guard = std::make_shared<Released>();
+	auto future = std::move(guard->future);
+
+	queue.post([&gate, &started]{
+		started++;
+		gate.wait();
+	});
+
+	auto firstStarted = waitFor(started, 1);
+
+	queue.post([guard, &ran]{ ran++; });
+	guard.reset();
+	queue.cancel();
+
+	// Dropped right away, not once the queue gets to it
+	auto droppedRightAway = isReady(future);
+
+	queue.post([&ran]{ ran++; }, source.getToken());
+	source.cancel();
+	queue.post([&ran]{ ran += 10; });
+	// Opened before checking anything, or the queue would wait for the first task forever
+	gate.open();
+	queue.wait();
+	TEST_CHECK(firstStarted);
+	TEST_CHECK(droppedRightAway);
+	TEST_EQUAL(ran, 10U);
+}};
+
+static Test::Register stop{"TaskPool: stopping waits for the running tasks and drops the queued ones", []{
+	auto workers = TaskPool::getWorkerCount();
+	TaskQueue queue{"TaskPoolTests::stop"};
+	Gate gate;
+	std::atomic<size_t> started{0};
+	std::atomic<size_t> finished{0};
+	std::atomic<size_t> ran{0};
+	std::atomic<bool> stopped{false};
+	auto guard = std::make_shared<Released>();
+	auto future = std::move(guard->future);
+
+	for (size_t i = 0; i < workers; i++)
+		TaskPool::post("TaskPoolTests::blocking", [&gate, &started, &finished]{
+			started++;
+			gate.wait();
+			finished++;
+		});
+
+	auto allStarted = waitFor(started, workers);
+
+	// Every worker is busy, so these wait
+	TaskPool::post("TaskPoolTests::queued", [guard, &ran]{ ran++; });
+	guard.reset();
+	queue.post([&ran]{ ran++; });
+
+	std::thread stopper{[&stopped]{
+		TaskPool::stop();
+		stopped = true;
+	}};
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	bool stoppedEarly = stopped;
+
+	// Opened before checking anything, or stop would wait for the running tasks forever
+	gate.open();
+	stopper.join();
+	TEST_CHECK(allStarted);
+	TEST_CHECK(!stoppedEarly);
+	TEST_EQUAL(finished, workers);
+	TEST_EQUAL(ran, 0U);
+	TEST_CHECK(isReady(future));
+	// The queue's job was dropped, so it has nothing left to wait for
+	queue.wait();
+	TEST_CHECK(!TaskPool::post("TaskPoolTests::late", [&ran]{ ran++; }));
+	queue.post([&ran]{ ran++; });
+	queue.wait();
+	TEST_EQUAL(ran, 0U);
+}, true};
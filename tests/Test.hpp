@@ -0,0 +1,67 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifndef CHALLONGESOKU_TEST_HPP
+#define CHALLONGESOKU_TEST_HPP
+
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <functional>
+
+#define TEST_CHECK(cond) ChallongeSoku::Test::check(cond, #cond, __FILE__, __LINE__)
+#define TEST_EQUAL(a, b) ChallongeSoku::Test::checkEqual(a, b, #a " == " #b, __FILE__, __LINE__)
+
+namespace ChallongeSoku::Test
+{
+	class Failure : public std::runtime_error {
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	struct Case {
+		std::string name;
+		std::function<void ()> fct;
+		bool last;
+	};
+
+	//! @brief Every test case, in the order they were registered.
+	inline std::vector<Case> &cases()
+	{
+		static std::vector<Case> list;
+
+		return list;
+	}
+
+	//! @brief Register a test case, from a static variable of the file defining it.
+	struct Register {
+		//! @param last Run after the other cases, for the ones stopping something they all use, like the TaskPool.
+		Register(const std::string &name, const std::function<void ()> &fct, bool last = false)
+		{
+			cases().push_back({name, fct, last});
+		}
+	};
+
+	inline void check(bool value, const char *expr, const char *file, int line)
+	{
+		if (!value)
+			throw Failure(std::string(file) + ":" + std::to_string(line) + ": " + expr);
+	}
+
+	template<typename T, typename U>
+	void checkEqual(const T &a, const U &b, const char *expr, const char *file, int line)
+	{
+		std::stringstream stream;
+
+		if (a == b)
+			return;
+		stream << file << ":" << line << ": " << expr << " (" << a << " != " << b << ")";
+		throw Failure(stream.str());
+	}
+}
+
+
+#endif //CHALLONGESOKU_TEST_HPP
@@ -0,0 +1,337 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closeSocket closesocket
+#else
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#define closeSocket close
+#endif
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include <Exceptions.hpp>
+#include <ConnectionPool.hpp>
+#include <TlsConnection.hpp>
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+
+// Loopback HTTPS server with a self-signed certificate for name, answering every request and closing the connection.
+// Its certificate is trusted by TlsConnection unless told otherwise. It records whether each handshake resumed a session.
+class StandInTlsServer {
+public:
+	StandInTlsServer(int maxVersion = 0, const std::string &name = "127.0.0.1", bool trusted = true)
+	{
+		sockaddr_in address{};
+		socklen_t size = sizeof(address);
+
+#ifdef _WIN32
+		WSADATA data;
+
+		WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+		this->_context = SSL_CTX_new(TLS_server_method());
+		if (maxVersion)
+			SSL_CTX_set_max_proto_version(this->_context, maxVersion);
+		this->_makeCertificate(name, trusted);
+
+		this->_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		bind(this->_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+		listen(this->_socket, 16);
+		getsockname(this->_socket, reinterpret_cast<sockaddr *>(&address), &size);
+		this->_port = ntohs(address.sin_port);
+		this->_thread = std::thread(&StandInTlsServer::_accept, this);
+	}
+
+	~StandInTlsServer()
+	{
+		this->_stopping = true;
+		this->_thread.join();
+		for (auto &thread : this->_connections)
+			thread.join();
+		closeSocket(this->_socket);
+		SSL_CTX_free(this->_context);
+	}
+
+	unsigned short getPort() const
+	{
+		return this->_port;
+	}
+
+	// Whether each handshake was resumed, in the order they completed
+	std::vector<bool> getHandshakes()
+	{
+		std::unique_lock<std::mutex> lock{this->_mutex};
+
+		return this->_handshakes;
+	}
+
+	bool waitForHandshakes(size_t count)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+		while (this->getHandshakes().size() < count) {
+			if (std::chrono::steady_clock::now() > deadline)
+				return false;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return true;
+	}
+
+private:
+	SSL_CTX *_context;
+	intptr_t _socket;
+	unsigned short _port;
+	std::atomic_bool _stopping{false};
+	std::thread _thread;
+	std::vector<std::thread> _connections;
+	std::mutex _mutex;
+	std::vector<bool> _handshakes;
+
+	void _makeCertificate(const std::string &name, bool trusted)
+	{
+		auto keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+		EVP_PKEY *key = nullptr;
+		auto certificate = X509_new();
+		// Trusted certificates are found by subject, so each server needs its own
+		static std::atomic_int serial{0};
+		auto organization = "StandInTlsServer " + std::to_string(++serial);
+
+		EVP_PKEY_keygen_init(keyContext);
+		EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1);
+		EVP_PKEY_keygen(keyContext, &key);
+		EVP_PKEY_CTX_free(keyContext);
+
+		X509_set_version(certificate, 2);
+		ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+		X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+		X509_gmtime_adj(X509_getm_notAfter(certificate), 3600);
+		X509_NAME_add_entry_by_txt(X509_get_subject_name(certificate), "O", MBSTRING_ASC, reinterpret_cast<const unsigned char *>(organization.c_str()), -1, -1, 0);
+		X509_NAME_add_entry_by_txt(X509_get_subject_name(certificate), "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>(name.c_str()), -1, -1, 0);
+		X509_set_issuer_name(certificate, X509_get_subject_name(certificate));
+
+		auto altName = (name.find_first_not_of("0123456789.") == std::string::npos ? "IP:" : "DNS:") + name;
+		auto extension = X509V3_EXT_conf_nid(nullptr, nullptr, NID_subject_alt_name, altName.c_str());
+
+		X509_add_ext(certificate, extension, -1);
+		X509_EXTENSION_free(extension);
+		X509_set_pubkey(certificate, key);
+		X509_sign(certificate, key, EVP_sha256());
+
+		if (trusted)
+			TlsConnection::trustCertificate(certificate);
+		SSL_CTX_use_certificate(this->_context, certificate);
+		SSL_CTX_use_PrivateKey(this->_context, key);
+		X509_free(certificate);
+		EVP_PKEY_free(key);
+	}
+
+	void _accept()
+	{
+		while (!this->_stopping) {
+			fd_set set;
+			timeval timeout{0, 50000};
+
+			FD_ZERO(&set);
+			FD_SET(this->_socket, &set);
+			if (select(static_cast<int>(this->_socket + 1), &set, nullptr, nullptr, &timeout) <= 0)
+				continue;
+
+			intptr_t client = accept(this->_socket, nullptr, nullptr);
+
+			if (client >= 0)
+				this->_connections.emplace_back(&StandInTlsServer::_serve, this, client);
+		}
+	}
+
+	void _serve(intptr_t client)
+	{
+		auto ssl = SSL_new(this->_context);
+		std::string request;
+		char buffer[4096];
+
+		SSL_set_fd(ssl, static_cast<int>(client));
+		if (SSL_accept(ssl) == 1) {
+			{
+				std::unique_lock<std::mutex> lock{this->_mutex};
+
+				this->_handshakes.push_back(SSL_session_reused(ssl));
+			}
+			while (request.find("\r\n\r\n") == std::string::npos) {
+				int size = SSL_read(ssl, buffer, sizeof(buffer));
+
+				if (size <= 0)
+					break;
+				request.append(buffer, size);
+			}
+			if (request.find("\r\n\r\n") != std::string::npos) {
+				std::string answer = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nOK";
+
+				SSL_write(ssl, answer.c_str(), answer.size());
+				SSL_shutdown(ssl);
+			}
+		}
+		SSL_free(ssl);
+		closeSocket(client);
+	}
+};
+
+static void checkResumption(int maxVersion)
+{
+	StandInTlsServer server{maxVersion};
+
+	TlsConnection::clearSessions();
+	for (int i = 0; i < 3; i++) {
+		TlsConnection connection;
+
+		connection.connect("127.0.0.1", server.getPort());
+		TEST_EQUAL(connection.isResumed(), i != 0);
+		connection.send("GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+		TEST_CHECK(connection.readUntilEOF().find("\r\n\r\nOK") != std::string::npos);
+	}
+	TEST_CHECK(server.waitForHandshakes(3));
+	TEST_CHECK(server.getHandshakes() == std::vector<bool>({false, true, true}));
+
+	TlsConnection::clearSessions();
+
+	TlsConnection connection;
+
+	connection.connect("127.0.0.1", server.getPort());
+	TEST_CHECK(!connection.isResumed());
+}
+
+static Test::Register tls13{"TlsConnection: TLS 1.3 sessions are resumed", []{
+	checkResumption(0);
+}};
+
+static Test::Register tls12{"TlsConnection: TLS 1.2 sessions are resumed", []{
+	checkResumption(TLS1_2_VERSION);
+}};
+
+static Test::Register otherHost{"TlsConnection: sessions are only offered to the host which gave them", []{
+	StandInTlsServer first;
+	StandInTlsServer second;
+
+	TlsConnection::clearSessions();
+	for (auto port : {first.getPort(), second.getPort()}) {
+		TlsConnection connection;
+
+		connection.connect("127.0.0.1", port);
+		connection.send("GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+		connection.readUntilEOF();
+		TEST_CHECK(!connection.isResumed());
+	}
+}};
+
+static Test::Register exactReads{"TlsConnection: reads give exactly the bytes asked for, until the server closes", []{
+	StandInTlsServer server;
+	TlsConnection connection;
+
+	connection.connect("127.0.0.1", server.getPort());
+	connection.send("GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	TEST_EQUAL(connection.read(15), "HTTP/1.1 200 OK");
+	TEST_EQUAL(connection.read(2), "\r\n");
+	connection.readUntilEOF();
+	try {
+		connection.read(1);
+		TEST_CHECK(!"read");
+	} catch (ChallongeAPI::EOFException &) {
+	}
+}};
+
+static Test::Register interrupted{"TlsConnection: interrupting a connection wakes the thread reading it", []{
+	StandInTlsServer server;
+	TlsConnection connection;
+	std::atomic_bool failed{false};
+
+	connection.connect("127.0.0.1", server.getPort());
+
+	// The server waits for a request, so nothing comes
+	std::thread reader{[&connection, &failed]{
+		try {
+			connection.read(1);
+		} catch (ChallongeAPI::NetworkException &) {
+			failed = true;
+		}
+	}};
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	connection.interrupt();
+	reader.join();
+	TEST_CHECK(failed);
+	connection.disconnect();
+}};
+
+static void checkRefused(StandInTlsServer &server, const std::string &host)
+{
+	TlsConnection connection;
+
+	try {
+		connection.connect(host, server.getPort());
+		TEST_CHECK(!"connected");
+	} catch (ChallongeAPI::NetworkException &e) {
+		TEST_CHECK(!connection.isOpen());
+	}
+}
+
+static Test::Register untrusted{"TlsConnection: certificates not signed by a trusted authority are refused", []{
+	StandInTlsServer server{0, "127.0.0.1", false};
+
+	checkRefused(server, "127.0.0.1");
+}};
+
+static Test::Register otherName{"TlsConnection: certificates for another host are refused", []{
+	StandInTlsServer server{0, "other.test"};
+
+	checkRefused(server, "127.0.0.1");
+}};
+
+static Test::Register pooled{"ConnectionPool: pooled connections resume the host's session", []{
+	StandInTlsServer server;
+	ChallongeAPI::Socket::HttpRequest request;
+
+	TlsConnection::clearSessions();
+	request.host = "127.0.0.1";
+	request.portno = server.getPort();
+	request.path = "/";
+	auto waitForPooled = [&server](size_t count){
+		TEST_CHECK(server.waitForHandshakes(count));
+		// The server is done with the handshake slightly before the pool has the connection
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	};
+
+	ConnectionPool::warm({"127.0.0.1"}, server.getPort());
+	waitForPooled(1);
+	for (size_t i = 0; i < 2; i++) {
+		auto response = ConnectionPool::makeHttpRequest(request);
+
+		TEST_EQUAL(response.returnCode, 200);
+		TEST_EQUAL(response.body, "OK");
+		// The connection replacing the one taken
+		waitForPooled(i + 2);
+	}
+
+	auto handshakes = server.getHandshakes();
+
+	ConnectionPool::warm({});
+	// Requests only went over warm connections, and once the first one was read, its session was resumed
+	TEST_EQUAL(handshakes.size(), 3U);
+	TEST_CHECK(!handshakes[0]);
+	TEST_CHECK(handshakes[2]);
+}};
@@ -0,0 +1,151 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <cstdio>
+#include <json.hpp>
+#include <TournamentSnapshot.hpp>
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+using namespace ChallongeAPI;
+
+static TournamentSnapshot makeSnapshot()
+{
+	TournamentSnapshot snapshot;
+
+	snapshot.id = 1234;
+	snapshot.url = "hisoutensoku-cup";
+	snapshot.name = "Hisoutensoku Cup";
+	snapshot.type = "double elimination";
+	snapshot.gameName = "Touhou Hisoutensoku";
+	snapshot.participantsCount = 2;
+	snapshot.participants.push_back(std::make_shared<Participant>(nlohmann::json{
+		{"id",                                   10},
+		{"display_name",                         "Alice"},
+		{"username",                             "alice"},
+		{"challonge_username",                   "alice_c"},
+		{"attached_participatable_portrait_url", "https://example.com/alice.png"},
+		{"group_player_ids",                     {100, 101}},
+	}));
+	snapshot.participants.push_back(std::make_shared<Participant>(nlohmann::json{
+		{"id",                                   11},
+		{"display_name",                         "Bob"},
+		{"username",                             "bob"},
+		{"challonge_username",                   nullptr},
+		{"attached_participatable_portrait_url", nullptr},
+		{"group_player_ids",                     nlohmann::json::array()},
+	}));
+	snapshot.matches.push_back(std::make_shared<Match>(nlohmann::json{
+		{"id",                            1},
+		{"state",                         "complete"},
+		{"round",                         1},
+		{"suggested_play_order",          1},
+		{"group_id",                      nullptr},
+		{"player1_id",                    10},
+		{"player2_id",                    11},
+		{"winner_id",                     10},
+		{"loser_id",                      11},
+		{"player1_prereq_match_id",       nullptr},
+		{"player2_prereq_match_id",       nullptr},
+		{"prerequisite_match_ids_csv",    ""},
+		{"player1_is_prereq_match_loser", false},
+		{"player2_is_prereq_match_loser", false},
+		{"scores_csv",                    "2-1"},
+	}));
+	snapshot.matches.push_back(std::make_shared<Match>(nlohmann::json{
+		{"id",                            2},
+		{"state",                         "pending"},
+		{"round",                         -1},
+		{"suggested_play_order",          2},
+		{"group_id",                      77},
+		{"player1_id",                    11},
+		{"player2_id",                    nullptr},
+		{"winner_id",                     nullptr},
+		{"loser_id",                      nullptr},
+		{"player1_prereq_match_id",       1},
+		{"player2_prereq_match_id",       nullptr},
+		{"prerequisite_match_ids_csv",    "1"},
+		{"player1_is_prereq_match_loser", true},
+		{"player2_is_prereq_match_loser", false},
+		{"scores_csv",                    ""},
+	}));
+	return snapshot;
+}
+
+static void checkSame(const TournamentSnapshot &a, const TournamentSnapshot &b)
+{
+	TEST_EQUAL(a.id, b.id);
+	TEST_EQUAL(a.url, b.url);
+	TEST_EQUAL(a.name, b.name);
+	TEST_EQUAL(a.type, b.type);
+	TEST_EQUAL(a.gameName, b.gameName);
+	TEST_EQUAL(a.participantsCount, b.participantsCount);
+	TEST_EQUAL(a.matches.size(), b.matches.size());
+	for (size_t i = 0; i < a.matches.size(); i++) {
+		auto &m1 = *a.matches[i];
+		auto &m2 = *b.matches[i];
+
+		TEST_EQUAL(m1.getId(), m2.getId());
+		TEST_EQUAL(m1.getState(), m2.getState());
+		TEST_EQUAL(m1.getRound(), m2.getRound());
+		TEST_EQUAL(m1.getSuggestedPlayOrder(), m2.getSuggestedPlayOrder());
+		TEST_CHECK(m1.getGroupId() == m2.getGroupId());
+		TEST_CHECK(m1.getPlayer1Id() == m2.getPlayer1Id());
+		TEST_CHECK(m1.getPlayer2Id() == m2.getPlayer2Id());
+		TEST_CHECK(m1.getWinnerId() == m2.getWinnerId());
+		TEST_CHECK(m1.getLoserId() == m2.getLoserId());
+		TEST_CHECK(m1.getScores() == m2.getScores());
+		TEST_CHECK(m1.getPrerequisiteMatchIds() == m2.getPrerequisiteMatchIds());
+		TEST_EQUAL(m1.isPlayer1IsPrereqMatchLoser(), m2.isPlayer1IsPrereqMatchLoser());
+		TEST_EQUAL(m1.isPlayer2IsPrereqMatchLoser(), m2.isPlayer2IsPrereqMatchLoser());
+	}
+	TEST_EQUAL(a.participants.size(), b.participants.size());
+	for (size_t i = 0; i < a.participants.size(); i++) {
+		auto &p1 = *a.participants[i];
+		auto &p2 = *b.participants[i];
+
+		TEST_EQUAL(p1.getId(), p2.getId());
+		TEST_EQUAL(p1.getDisplayName(), p2.getDisplayName());
+		TEST_EQUAL(p1.getUsername(), p2.getUsername());
+		TEST_CHECK(p1.getChallongeUsername() == p2.getChallongeUsername());
+		TEST_CHECK(p1.getAttachedParticipatablePortraitUrl() == p2.getAttachedParticipatablePortraitUrl());
+		TEST_CHECK(p1.getGroupPlayerIds() == p2.getGroupPlayerIds());
+	}
+}
+
+static Test::Register roundTrip{"TournamentSnapshot: a serialized tournament is deserialized the same", []{
+	auto snapshot = makeSnapshot();
+	TournamentSnapshot loaded;
+
+	TEST_CHECK(loaded.deserialize(snapshot.serialize()));
+	checkSame(snapshot, loaded);
+}};
+
+static Test::Register fileRoundTrip{"TournamentSnapshot: a saved snapshot is loaded the same", []{
+	auto snapshot = makeSnapshot();
+	auto path = "snapshot_test.snap";
+	TournamentSnapshot loaded;
+
+	snapshot.save(path);
+	TEST_CHECK(loaded.load(path));
+	std::remove(path);
+	checkSame(snapshot, loaded);
+	TEST_CHECK(!loaded.load(path));
+}};
+
+static Test::Register invalid{"TournamentSnapshot: truncated or foreign data is refused", []{
+	auto data = makeSnapshot().serialize();
+	auto otherVersion = data;
+	auto badString = data;
+	TournamentSnapshot loaded;
+
+	TEST_CHECK(!loaded.deserialize(""));
+	TEST_CHECK(!loaded.deserialize(data.substr(0, data.size() - 1)));
+	TEST_CHECK(!loaded.deserialize(data + "x"));
+	otherVersion[4]++;
+	TEST_CHECK(!loaded.deserialize(otherVersion));
+	// The header ends with the game name's size, which now goes past the string table
+	badString[71] = '\x7F';
+	TEST_CHECK(!loaded.deserialize(badString));
+}};
@@ -0,0 +1,45 @@
+//
+// Created by Gegel85 on 19/10/2026.
+//
+
+#include <csignal>
+#include <iostream>
+#include <algorithm>
+#include <TaskPool.hpp>
+#include <ConnectionPool.hpp>
+#include <Resolver.hpp>
+#include "Test.hpp"
+
+using namespace ChallongeSoku;
+
+int main(int argc, char **argv)
+{
+	std::string filter = argc > 1 ? argv[1] : "";
+	size_t failed = 0;
+	size_t ran = 0;
+
+#ifdef SIGPIPE
+	// Like the program, so a TLS stand-in closing early fails the test instead of killing the process
+	std::signal(SIGPIPE, SIG_IGN);
+#endif
+	std::stable_partition(Test::cases().begin(), Test::cases().end(), [](const Test::Case &test){
+		return !test.last;
+	});
+	for (auto &test : Test::cases()) {
+		if (test.name.find(filter) == std::string::npos)
+			continue;
+		ran++;
+		try {
+			test.fct();
+			std::cout << "[  OK  ] " << test.name << std::endl;
+		} catch (std::exception &e) {
+			std::cout << "[ FAIL ] " << test.name << ": " << e.what() << std::endl;
+			failed++;
+		}
+	}
+	Resolver::stop();
+	TaskPool::stop();
+	ConnectionPool::stop();
+	std::cout << ran - failed << "/" << ran << " tests passed" << std::endl;
+	return failed != 0;
+}